@@ -1,6 +1,8 @@
 #ifndef INTNN_ACTV_H
 #define INTNN_ACTV_H
 
+#include <stdbool.h>
+#include <stdint.h>
 #include "intnn_mat.h"
 #include "intnn_mat3d.h"
 #include "intnn_consts.h"
@@ -25,10 +27,37 @@ typedef enum {
 void intnn_activate(intnn_mat* matOut, intnn_mat* matIn, intnn_mat* matActvGradInv,
                     intnn_actv_type actv, int k, int numItems);
 
-// 主激活函数（3D）
+// 主激活函数（3D）：支持所有激活类型，在连续存储上一次处理所有层，形状一致时不重新分配
 void intnn_activate3d(intnn_mat3d* mat3dOut, intnn_mat3d* mat3dIn, intnn_mat3d* matActvGradInv,
                       intnn_actv_type actv, int k, int numItems);
 
+// 逐元素激活（除 softmax 外）可按行计算，用于 GEMM 写回时的融合激活
+bool intnn_actv_is_elementwise(intnn_actv_type actv);
+void intnn_activate_row(int* out, int* gradInv, const int* in, int n,
+                        intnn_actv_type actv, int k, int numItems);
+void intnn_activate_row_nograd(int* out, const int* in, int n,  // 推理用：只写输出，out 可与 in 相同
+                               intnn_actv_type actv, int k, int numItems);
+
+// 激活梯度移位编码（每元素 1 字节）：编码 s（0..30）表示梯度倒数为 2^s，反向时向零取整右移 s 位，
+// 与整数除法逐位相同；饱和区（倒数 INTNN_MAX）与 leaky relu 负半轴（倒数 5）用专用编码，按常数除法处理
+#define INTNN_GRAD_CODE_SAT   0xFE
+#define INTNN_GRAD_CODE_DIV5  0xFD
+
+// 该激活的梯度倒数能否用移位编码表示（plu 的倒数任意、softmax 需整行，均不能）
+bool intnn_actv_has_grad_code(intnn_actv_type actv);
+// 与 intnn_activate_row 相同，但梯度写成移位编码
+void intnn_activate_row_code(int* out, uint8_t* code, const int* in, int n,
+                             intnn_actv_type actv, int k, int numItems);
+// 编码对应的梯度倒数
+int intnn_grad_code_inv(uint8_t code);
+// out[c] = in[c] / intnn_grad_code_inv(code[c])，out 可与 in 相同
+void intnn_apply_grad_code_row(int* out, const int* in, const uint8_t* code, int n);
+
+// 逐元素激活与 softmax 的实现："scalar" 或 "avx2"。首次使用时按 CPUID 选择，环境变量 INTNN_ACTV_KERNEL 可强制指定；
+// 各实现结果逐位一致。名称未知或 CPU 不支持时 intnn_actv_set_kernel 返回 false 且不改变当前选择
+const char* intnn_actv_kernel_name(void);
+bool intnn_actv_set_kernel(const char* name);
+
 // 单个激活函数实现（2D）
 void intnn_sigmoid(intnn_mat* matOut, intnn_mat* matIn, intnn_mat* matActvGradInv, int k);
 void intnn_tanh(intnn_mat* matOut, intnn_mat* matIn, intnn_mat* matActvGradInv, int k, int numItems);
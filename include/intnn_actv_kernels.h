@@ -0,0 +1,45 @@
+#ifndef INTNN_ACTV_KERNELS_H
+#define INTNN_ACTV_KERNELS_H
+
+// 激活 SIMD 实现的内部接口，仅供 intnn_actv.c 与各指令集实现文件使用
+
+#include <stdint.h>
+#include "intnn_actv.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// GCC/Clang 的 x86 目标才编译 SIMD 激活（按函数 target 属性生成，运行时按 CPUID 选择）
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define INTNN_ACTV_X86 1
+#endif
+
+// sigmoid / tanh 查找表：下标为缩放后输入限制到 [INTNN_PWL_LUT_MIN, INTNN_PWL_LUT_MIN + 256] 后减去 INTNN_PWL_LUT_MIN，
+// 元素为 int32 以便 SIMD 按 32 位 gather
+#define INTNN_PWL_LUT_MIN (-128)
+#define INTNN_PWL_LUT_SIZE 257
+extern const int32_t intnn_pwl_sigmoid_lut[INTNN_PWL_LUT_SIZE];
+extern const int32_t intnn_pwl_tanh_lut[INTNN_PWL_LUT_SIZE];
+extern const int32_t intnn_pwl_grad_inv_lut[INTNN_PWL_LUT_SIZE];
+extern const int32_t intnn_pwl_grad_code_lut[INTNN_PWL_LUT_SIZE];
+
+// 逐元素激活的向量部分：处理前 n 个元素中向量宽度整数倍的部分，返回已处理个数，余下由标量实现完成。
+// gradInv / code 为 NULL 时不写；out 可与 in 相同。不支持的激活返回 0
+typedef int (*intnn_actv_row_kernel)(int* out, int* gradInv, uint8_t* code, const int* in, int n,
+                                     intnn_actv_type actv, int k, int numItems);
+
+// softmax 一整行（含尾部），out 可与 in 相同
+typedef void (*intnn_actv_softmax_kernel)(int* out, int* gradInv, const int* in, int n);
+
+#ifdef INTNN_ACTV_X86
+int intnn_actv_row_avx2(int* out, int* gradInv, uint8_t* code, const int* in, int n,
+                        intnn_actv_type actv, int k, int numItems);
+void intnn_actv_softmax_row_avx2(int* out, int* gradInv, const int* in, int n);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INTNN_ACTV_KERNELS_H
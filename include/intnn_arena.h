@@ -0,0 +1,77 @@
+#ifndef INTNN_ARENA_H
+#define INTNN_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 步内临时内存池（线性分配）：分配只移动偏移，整体 O(1) 重置，容量即每步堆用量上限
+typedef struct {
+    char* mBase;            // 起始地址，按 INTNN_MAT_ALIGN 字节对齐
+    size_t mCapacity;       // 可用字节数
+    size_t mUsed;           // 当前已用字节数
+    size_t mHighWater;      // 自创建（或 clear_high_water）以来的最大已用字节数
+    bool mOwnsBase;         // mBase 是否由本池分配
+} intnn_arena;
+
+/**
+ * @brief 在堆上创建容量为 capacity 字节的内存池（只分配这一次）
+ *
+ * @param capacity  容量（字节）
+ * @return intnn_arena* 内存池，失败返回 NULL
+ */
+intnn_arena* intnn_create_arena(size_t capacity);
+
+/**
+ * @brief 用调用方提供的缓冲区初始化内存池（嵌入式场景可传静态数组，不使用堆）
+ *
+ * @param arena     待初始化的内存池结构体
+ * @param buffer    缓冲区，首地址不对齐时会向后调整，可用容量相应减少
+ * @param bytes     缓冲区字节数
+ */
+void intnn_arena_init(intnn_arena* arena, void* buffer, size_t bytes);
+
+/**
+ * @brief 释放内存池（连同结构体；由 intnn_arena_init 初始化的池只需丢弃，不要调用本函数）
+ *
+ * @param arena  内存池，若在当前线程处于激活状态会先解除绑定
+ */
+void intnn_free_arena(intnn_arena* arena);
+
+/**
+ * @brief 分配 bytes 字节，起始地址按 INTNN_MAT_ALIGN 字节对齐，内容未初始化
+ *
+ * 容量不足属于硬错误：打印所需与剩余字节数后断言失败，不会回退到堆分配。
+ */
+void* intnn_arena_alloc(intnn_arena* arena, size_t bytes);
+
+// O(1) 重置：之前分配的内存全部失效，高水位保留
+void intnn_arena_reset(intnn_arena* arena);
+
+// 栈式回退：记录当前位置，之后 rewind 释放该位置以后的所有分配
+size_t intnn_arena_mark(const intnn_arena* arena);
+void intnn_arena_rewind(intnn_arena* arena, size_t mark);
+
+// 用量统计
+size_t intnn_arena_used(const intnn_arena* arena);
+size_t intnn_arena_high_water(const intnn_arena* arena);
+void intnn_arena_clear_high_water(intnn_arena* arena);
+
+/**
+ * @brief 绑定当前激活的内存池，返回之前绑定的池（传 NULL 解除绑定）
+ *
+ * 绑定期间 intnn_create_mat / intnn_resize 等新分配的矩阵存储以及 GEMM 打包缓冲都从该池取得，
+ * 这些矩阵在池重置后失效。层的权重和工作矩阵始终在堆上分配，不受绑定影响。
+ * 绑定按线程区分（内存池本身不是线程安全的）：只影响调用线程，线程池的工作线程不受影响。
+ */
+intnn_arena* intnn_arena_bind(intnn_arena* arena);
+intnn_arena* intnn_arena_active(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INTNN_ARENA_H
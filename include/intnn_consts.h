@@ -11,6 +11,7 @@ extern "C" {
 #define INTNN_MIN (SCHAR_MIN + 1) // -127
 #define INTNN_MAX (SCHAR_MAX)     // 127
 #define INTNN_UNSIGNED_4BIT_MAX 15
+#define INTNN_MAT_ALIGN 64          // 矩阵存储对齐字节数（一条缓存行）
 
 extern const char* INTNN_TYPE_FC;
 extern const char* INTNN_TYPE_CONV;
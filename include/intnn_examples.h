@@ -15,6 +15,7 @@ extern "C" {
 #endif
 
 int example_intnn_fc_dfa_mnist();
+int example_intnn_bench_actv();  // 激活各模式的标量 / SIMD 吞吐（元素每纳秒）
 
 #ifdef __cplusplus
 }
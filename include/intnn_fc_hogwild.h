@@ -0,0 +1,64 @@
+#ifndef INTNN_FC_HOGWILD_H
+#define INTNN_FC_HOGWILD_H
+
+#include <stdbool.h>
+#include "intnn_fc_layer.h"
+#include "intnn_mat.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Hogwild 式数据并行 DFA 训练：多个工作线程各自取小批，前向/反向都使用同一份共享权重，
+ * 不加锁；权重与偏置更新按元素用 CAS 原子累加并限幅，单次更新不会丢失，但读取的权重可能混有
+ * 其他线程的部分更新（结果与线程调度有关，不保证可复现）。
+ *
+ * 每个工作线程拥有一条层链副本（输出、误差、更新等工作矩阵独立），只共享 mWeight / mBias / mDfaWeight。
+ * 单个工作线程时与逐批串行训练（intnn_fc_forward + intnn_fc_backward）逐位相同。
+ */
+typedef struct intnn_fc_hogwild intnn_fc_hogwild;
+
+// 工作线程 worker 取第 batch 批输入写入 x（调用方自行 resize）；不同工作线程并发调用
+typedef void (*intnn_hogwild_input_fn)(void* ctx, int worker, int batch, intnn_mat* x);
+
+// 工作线程 worker 由最后一层输出 output 计算第 batch 批误差写入 delta；不同工作线程并发调用，统计量请按 worker 分开累计
+typedef void (*intnn_hogwild_loss_fn)(void* ctx, int worker, int batch, const intnn_mat* output, intnn_mat* delta);
+
+/**
+ * @brief 为从 first 开始的层链创建 Hogwild 训练器
+ *
+ * 除最后一层外各层须启用 DFA（且未启用批归一化）；尚未初始化的 DFA 反馈矩阵在此按从后往前的顺序初始化。
+ * 不支持线程的平台上固定为 1 个工作线程。
+ *
+ * @param first       第一层（其权重被所有工作线程共享）
+ * @param numWorkers  工作线程数，<= 0 时取线程池大小
+ * @param maxBatch    最大批大小
+ * @return intnn_fc_hogwild* 训练器，层链不满足条件时返回 NULL
+ */
+intnn_fc_hogwild* intnn_fc_hogwild_create(intnn_fc_layer* first, int numWorkers, int maxBatch);
+
+// 释放训练器及各工作线程的层链副本（共享的权重仍属于原层链）
+void intnn_fc_hogwild_free(intnn_fc_hogwild* hogwild);
+
+// 实际使用的工作线程数
+int intnn_fc_hogwild_num_workers(const intnn_fc_hogwild* hogwild);
+
+/**
+ * @brief 训练 numBatches 批，每批恰好由一个工作线程处理一次，返回时所有更新都已应用
+ *
+ * @param hogwild     训练器
+ * @param numBatches  批数
+ * @param lrInv       学习率的倒数
+ * @param input       取批输入的回调
+ * @param loss        计算误差的回调
+ * @param ctx         回调上下文
+ */
+void intnn_fc_hogwild_run(intnn_fc_hogwild* hogwild, int numBatches, int lrInv,
+                          intnn_hogwild_input_fn input, intnn_hogwild_loss_fn loss, void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INTNN_FC_HOGWILD_H
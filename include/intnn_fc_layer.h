@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include "intnn_mat.h"
+#include "intnn_tmat.h"
 #include "intnn_actv.h"
 #include "intnn_tools.h"
 #include "intnn_consts.h"
@@ -20,11 +21,14 @@ struct intnn_fc_layer{
     int mInDim;
     int mOutDim;
 
-    // Input pointer (not owned)
+    // Input pointer (not owned unless mCopyInput)
     intnn_mat* mInput;
+    bool mCopyInput;               // true: forward copies x into mInputCopy and mInput points at the copy
+    intnn_mat* mInputCopy;         // shape: (batchSize, mInDim), owned, only used when mCopyInput
+    bool mAtomicUpdate;            // true: mWeight/mBias are shared across threads (Hogwild), updates use per-element CAS
 
     // Weights and bias
-    intnn_mat* mWeight;       // shape: (mInDim, mOutDim)
+    intnn_tmat* mWeight;      // shape: (mInDim, mOutDim), INT16 (updates clamp to [-32767, 32767])
     intnn_mat* mBias;         // shape: (1, mOutDim)
 
     // Intermediate (pre-activation) and output
@@ -33,9 +37,10 @@ struct intnn_fc_layer{
 
     // Deltas and gradients for backward
     intnn_mat* mDeltas;            // shape: (batchSize, mOutDim)
-    intnn_mat* mDeltasTranspose;   // shape: (mOutDim, batchSize)
+    intnn_mat* mDeltasTranspose;   // shape: (mOutDim, batchSize), built on demand by intnn_fc_get_deltas_transpose
     intnn_mat* mDActvTranspose;    // shape: (mOutDim, batchSize)
-    intnn_mat* mActvGradInv;       // shape: (batchSize, mOutDim)
+    intnn_mat* mActvGradInv;       // shape: (batchSize, mOutDim), only for activations without a shift code (plu, softmax)
+    intnn_tmat* mActvGradCode;     // shape: (batchSize, mOutDim), UINT8 shift codes (intnn_actv_has_grad_code)
     intnn_mat* mWeightUpdate;      // shape: (mInDim, mOutDim)
     intnn_mat* mBiasUpdate;        // shape: (1, mOutDim)
 
@@ -85,16 +90,74 @@ intnn_fc_layer* intnn_fc_create(int inDim, int outDim);
  */
 void intnn_fc_free(intnn_fc_layer* layer);
 
+/**
+ * @brief 按最大批大小预留前向/反向工作矩阵（mInter、mOutput、mActvGradCode 或 mActvGradInv、mDeltas 等）
+ *
+ * 之后批大小不超过 maxBatch 时只调整逻辑行数，不再分配内存；超过时按需扩容。
+ * 不调用本函数也可以正常训练，工作矩阵会在首次使用时分配并保留。
+ *
+ * @param layer     全连接层
+ * @param maxBatch  最大批大小
+ */
+void intnn_fc_reserve(intnn_fc_layer* layer, int maxBatch);
+
 /**
  * @brief 前向传播：给定输入 X，计算输出 Y = activation(X·W + B)
  * 
  * @param layer    全连接层
  * @param x        输入矩阵，形状为 (batchSize, inDim)
- *                 注意：此函数不会修改 x，本层持有指针 mInput
+ *                 注意：此函数不会修改 x。默认 mInput 直接指向 x（不复制），
+ *                 因此在 intnn_fc_backward 完成前调用方不得修改或释放 x；
+ *                 若需要复用 x 的存储，请先调用 intnn_fc_set_copy_input(layer, true)
  *                 计算结果存放在 layer->mOutput
  */
 void intnn_fc_forward(intnn_fc_layer* layer, intnn_mat* x);
 
+/**
+ * @brief 单层前向传播：与 intnn_fc_forward 相同，但不递归调用下一层
+ *
+ * @param layer  全连接层
+ * @param x      输入矩阵，形状为 (batchSize, inDim)
+ */
+void intnn_fc_forward_layer(intnn_fc_layer* layer, intnn_mat* x);
+
+/**
+ * @brief 推理前向：只计算 mOutput，结果与 intnn_fc_forward 的输出相同
+ *
+ * 逐元素激活时一次 GEMM 直接写入 mOutput 并在写回时加偏置、激活；
+ * 不生成激活梯度、不使用 mInter、不记录或复制输入，之后不能据此做反向传播。
+ * 沿 mNext 迭代处理之后的各层。
+ *
+ * @param layer  第一层
+ * @param x      输入矩阵，形状为 (batchSize, inDim)
+ */
+void intnn_fc_infer(intnn_fc_layer* layer, const intnn_mat* x);
+
+// 单层推理前向，不处理下一层
+void intnn_fc_infer_layer(intnn_fc_layer* layer, const intnn_mat* x);
+
+/**
+ * @brief 单层推理前向，结果写入调用方提供的 out，不修改层的任何状态
+ *
+ * 只读取权重、偏置与激活类型，多个线程可以同时对同一层调用（各自使用不同的 out）。
+ *
+ * @param layer  全连接层
+ * @param x      输入矩阵，形状 (batchSize, inDim)
+ * @param out    输出矩阵，按需调整为 (batchSize, outDim)，不得与 x 相同
+ */
+void intnn_fc_infer_to(const intnn_fc_layer* layer, const intnn_mat* x, intnn_mat* out);
+
+/**
+ * @brief 设置前向传播是否复制输入
+ *
+ * 默认不复制，mInput 只是对调用方矩阵的引用；开启后每次前向把 x 复制到层内
+ * 复用的缓冲区，适用于调用方在反向传播前会改写输入的场景。
+ *
+ * @param layer      全连接层
+ * @param copyInput  true 复制输入，false 仅引用
+ */
+void intnn_fc_set_copy_input(intnn_fc_layer* layer, bool copyInput);
+
 /**
  * @brief 反向传播：给定上一层的误差 lastDeltas，计算本层权重和偏置更新／下游误差
  * 
@@ -105,6 +168,28 @@ void intnn_fc_forward(intnn_fc_layer* layer, intnn_mat* x);
  */
 void intnn_fc_backward(intnn_fc_layer* layer, intnn_mat* lastDeltas, int lrInv);
 
+/**
+ * @brief 单层反向传播：计算本层误差并更新本层权重和偏置，不递归调用上一层
+ *
+ * 使用 layer->mActvGradCode（无移位编码的激活为 mActvGradInv）作为本层激活梯度，需与 input 属于同一次前向。
+ *
+ * @param layer       全连接层
+ * @param input       本层那一次前向的输入，形状 (batchSize, inDim)
+ * @param lastDeltas  最后一层的误差，形状 (batchSize, 最后一层 outDim)
+ * @param lrInv       学习率的倒数
+ */
+void intnn_fc_backward_layer(intnn_fc_layer* layer, const intnn_mat* input, intnn_mat* lastDeltas, int lrInv);
+
+/**
+ * @brief 若尚未设置 DFA 反馈矩阵，按层宽随机初始化为 (lastDim, outDim)
+ *
+ * 使用 rand()，多层初始化的先后顺序会影响结果；intnn_fc_backward 按从后往前的顺序初始化。
+ *
+ * @param layer    全连接层
+ * @param lastDim  最后一层输出维度
+ */
+void intnn_fc_ensure_dfa_weight(intnn_fc_layer* layer, int lastDim);
+
 /**
  * @brief 获取本层输出的指针（用于 FC 后续层直接使用）
  * 
@@ -117,12 +202,14 @@ intnn_mat* intnn_fc_get_output(intnn_fc_layer* layer);
  * @brief 获取本层权重矩阵指针
  * 
  * @param layer  全连接层
- * @return intnn_mat* 权重矩阵，形状 (inDim, outDim)
+ * @return intnn_tmat* 权重矩阵，INT16，形状 (inDim, outDim)
  */
-intnn_mat* intnn_fc_get_weight(intnn_fc_layer* layer);
+intnn_tmat* intnn_fc_get_weight(intnn_fc_layer* layer);
 
 /**
  * @brief 获取本层误差转置矩阵（误差维度为 (batchSize, outDim)，转置为 (outDim, batchSize)）
+ *
+ * 反向传播不再生成转置副本，本函数按当前误差即时生成；尚未反向传播时返回 NULL
  * 
  * @param layer  全连接层
  * @return intnn_mat* 误差转置矩阵
@@ -0,0 +1,65 @@
+#ifndef INTNN_FC_PIPELINE_H
+#define INTNN_FC_PIPELINE_H
+
+#include <stdbool.h>
+#include "intnn_fc_layer.h"
+#include "intnn_mat.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * DFA 流水线训练：每层一个线程（流水级），层 k 对第 i 批的更新可与前面各层对第 i+1 批的前向重叠。
+ *
+ * 陈旧度 S：第 j 批在任一层做前向时，该层恰好已应用第 0..j-1-S 批的更新（与线程调度无关，结果确定）。
+ * S = 0 时与逐批串行训练（intnn_fc_forward + intnn_fc_backward）逐位相同。
+ * 每层为 S+1 批保留输出与激活梯度（环形缓冲），内存随 S 线性增长；中间结果、误差与更新量每层另有一份。
+ * 这些工作矩阵都由训练器自己分配，运行期间不读写层原有的工作矩阵，因此层链可以已经由
+ * intnn_net_plan_memory 绑定到 slab（规划按逐层串行的时序复用内存，不能被并发的流水级共用）。
+ */
+typedef struct intnn_fc_pipeline intnn_fc_pipeline;
+
+// 取第 batch 批输入写入 x（调用方自行 resize），在第一级线程上按批次顺序调用
+typedef void (*intnn_pipeline_input_fn)(void* ctx, int batch, intnn_mat* x);
+
+// 由最后一层输出 output 计算误差写入 delta（形状同 output），可顺便统计损失与准确率；在最后一级线程上按批次顺序调用
+typedef void (*intnn_pipeline_loss_fn)(void* ctx, int batch, const intnn_mat* output, intnn_mat* delta);
+
+/**
+ * @brief 为从 first 开始的层链创建流水线训练器
+ *
+ * 除最后一层外各层须启用 DFA（且未启用批归一化）；尚未初始化的 DFA 反馈矩阵在此按从后往前的顺序初始化，
+ * 与 intnn_fc_backward 的随机数消耗顺序一致。不支持线程的平台上陈旧度固定为 0 并在调用线程串行执行。
+ *
+ * @param first      第一层
+ * @param maxBatch   最大批大小
+ * @param staleness  期望陈旧度（< 0 按 0 处理）
+ * @return intnn_fc_pipeline* 训练器，层链不满足条件时返回 NULL
+ */
+intnn_fc_pipeline* intnn_fc_pipeline_create(intnn_fc_layer* first, int maxBatch, int staleness);
+
+// 释放训练器（各层恢复使用自己的输出与激活梯度矩阵）
+void intnn_fc_pipeline_free(intnn_fc_pipeline* pipeline);
+
+// 实际使用的陈旧度
+int intnn_fc_pipeline_staleness(const intnn_fc_pipeline* pipeline);
+
+/**
+ * @brief 训练 numBatches 批，返回时所有更新都已应用
+ *
+ * @param pipeline    训练器
+ * @param numBatches  批数
+ * @param lrInv       学习率的倒数
+ * @param input       取批输入的回调
+ * @param loss        计算误差的回调
+ * @param ctx         回调上下文
+ */
+void intnn_fc_pipeline_run(intnn_fc_pipeline* pipeline, int numBatches, int lrInv,
+                           intnn_pipeline_input_fn input, intnn_pipeline_loss_fn loss, void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INTNN_FC_PIPELINE_H
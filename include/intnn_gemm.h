@@ -0,0 +1,97 @@
+#ifndef INTNN_GEMM_H
+#define INTNN_GEMM_H
+
+#include <stdbool.h>
+#include "intnn_mat.h"
+#include "intnn_tmat.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 分块参数：寄存器微块 MR x NR，缓存块 MC x KC（A 面板）与 KC x NC（B 面板）
+#define INTNN_GEMM_MR 4
+#define INTNN_GEMM_NR 16
+#define INTNN_GEMM_MC 64
+#define INTNN_GEMM_KC 256
+#define INTNN_GEMM_NC 1024
+// 多线程时每个线程至少分到的乘加次数，低于此规模的 GEMM 在调用线程上完成
+#define INTNN_GEMM_PARALLEL_MIN_MACS (1 << 19)
+
+// GEMM 操作数：任意元素类型的行优先矩阵（不拥有存储）
+typedef struct {
+    const void* mData;
+    int mStride;        // 存储的行跨度（元素个数）
+    intnn_dtype mType;
+    bool mTrans;        // true 表示存储的是操作数的转置：逻辑元素 (r, c) 位于存储的 (c, r)
+} intnn_gemm_operand;
+
+/**
+ * GEMM 写回回调：每个输出微块在最后一个 K 块累加完毕、写回 out 后立即调用，
+ * vals 指向 out 第 r 行 [c0, c0 + n) 的最终结果（仍在 L1 中），回调可就地修改。
+ * 用于把偏置、激活等逐元素运算融合进 GEMM，省去对输出矩阵的额外遍历。
+ * 多线程时不同输出行的回调可能在不同线程上同时执行，回调只应写第 r 行相关的数据。
+ */
+typedef void (*intnn_gemm_epilogue_fn)(void* ctx, int r, int c0, int* vals, int n);
+
+typedef struct {
+    intnn_gemm_epilogue_fn mFn;
+    void* mCtx;
+} intnn_gemm_epilogue;
+
+/**
+ * @brief 分块整数矩阵乘法 out = a × b
+ *
+ * 打包 A/B 面板后按寄存器微块累加。累加在 32 位无符号整数上回绕，
+ * 结果与逐元素 long long 求和再截断为 int 完全一致。
+ * 规模足够大时按输出行切分到线程池（见 intnn_thread_pool.h），结果与单线程逐位相同。
+ *
+ * @param out  输出矩阵，形状 (a.rows, b.cols)，不得与 a、b 共享存储
+ * @param a    左矩阵
+ * @param b    右矩阵
+ */
+void intnn_gemm(intnn_mat* out, const intnn_mat* a, const intnn_mat* b);
+
+/**
+ * @brief 带转置标志的矩阵乘法 out = op(a) × op(b)，op(x) 为 x 或 xᵀ（不生成转置副本）
+ *
+ * @param out     输出矩阵，形状 (op(a).rows, op(b).cols)，不得与 a、b 共享存储
+ * @param a       左矩阵
+ * @param transA  是否使用 aᵀ
+ * @param b       右矩阵
+ * @param transB  是否使用 bᵀ
+ */
+void intnn_gemm_trans(intnn_mat* out, const intnn_mat* a, bool transA, const intnn_mat* b, bool transB);
+
+/**
+ * @brief 混合位宽矩阵乘法 out = a × b，操作数在打包时拓宽，统一用 int32 累加
+ *
+ * @param out  输出矩阵，形状 (m, n)，m、n 取自 out
+ * @param a    左操作数，逻辑形状 (m, k)
+ * @param b    右操作数，逻辑形状 (k, n)
+ * @param k    公共维度
+ * @param epilogue  写回回调，可为 NULL
+ */
+void intnn_gemm_ex(intnn_mat* out, const intnn_gemm_operand* a, const intnn_gemm_operand* b, int k,
+                   const intnn_gemm_epilogue* epilogue);
+
+/**
+ * @brief 当前使用的微块实现名称："scalar"、"avx2" 或 "avx512vnni"
+ *
+ * 首次调用 GEMM 时按 CPUID 选择 CPU 支持的最快实现；设置环境变量
+ * INTNN_GEMM_KERNEL 可强制指定（不支持时打印警告并回退到自动选择）。
+ * 各实现结果逐位一致：操作数落在 int16（或 uint8 x int8）范围内时
+ * 走 vpmaddwd / vpdpwssd（vpdpbusd）窄面板，否则走 int32 面板。
+ */
+const char* intnn_gemm_kernel_name(void);
+
+/**
+ * @brief 指定微块实现，名称未知或 CPU 不支持时返回 false 且不改变当前选择
+ */
+bool intnn_gemm_set_kernel(const char* name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INTNN_GEMM_H
@@ -0,0 +1,47 @@
+#ifndef INTNN_GEMM_KERNELS_H
+#define INTNN_GEMM_KERNELS_H
+
+// GEMM 寄存器微块的内部接口，仅供 intnn_gemm.c 与各指令集实现文件使用
+
+#include <stdint.h>
+#include "intnn_gemm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// GCC/Clang 的 x86 目标才编译 SIMD 微块（按函数 target 属性生成，运行时按 CPUID 选择）
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define INTNN_GEMM_X86 1
+#endif
+
+// 面板格式：每个 k 步在 A 面板中占 MR 个 32 位单元，在 B 面板中占 NR 个 32 位单元
+typedef enum {
+    INTNN_GEMM_PANEL_I32,       // 每单元 1 个 int32，k 步 = 1
+    INTNN_GEMM_PANEL_I16X2,     // 每单元 2 个 int16（相邻 k 成对），k 步 = 2，供 vpmaddwd / vpdpwssd
+    INTNN_GEMM_PANEL_U8S8X4,    // A 为 4 个 uint8，B 为 4 个 int8（相邻 k 成组），k 步 = 4，供 vpdpbusd
+    INTNN_GEMM_PANEL_COUNT
+} intnn_gemm_panel;
+
+// 微块：tile(MR x NR) = Σ pa ⊗ pb，steps 为打包后的 k 步数，结果按 uint32 回绕
+typedef void (*intnn_gemm_ukernel)(int steps, const uint32_t* pa, const uint32_t* pb,
+                                   uint32_t tile[INTNN_GEMM_MR][INTNN_GEMM_NR]);
+
+#ifdef INTNN_GEMM_X86
+void intnn_gemm_ukernel_avx2_i32(int steps, const uint32_t* pa, const uint32_t* pb,
+                                 uint32_t tile[INTNN_GEMM_MR][INTNN_GEMM_NR]);
+void intnn_gemm_ukernel_avx2_i16x2(int steps, const uint32_t* pa, const uint32_t* pb,
+                                   uint32_t tile[INTNN_GEMM_MR][INTNN_GEMM_NR]);
+void intnn_gemm_ukernel_avx512_i32(int steps, const uint32_t* pa, const uint32_t* pb,
+                                   uint32_t tile[INTNN_GEMM_MR][INTNN_GEMM_NR]);
+void intnn_gemm_ukernel_avx512vnni_i16x2(int steps, const uint32_t* pa, const uint32_t* pb,
+                                         uint32_t tile[INTNN_GEMM_MR][INTNN_GEMM_NR]);
+void intnn_gemm_ukernel_avx512vnni_u8s8x4(int steps, const uint32_t* pa, const uint32_t* pb,
+                                          uint32_t tile[INTNN_GEMM_MR][INTNN_GEMM_NR]);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INTNN_GEMM_KERNELS_H
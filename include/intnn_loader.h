@@ -5,6 +5,7 @@
 
 #include "intnn_mat.h"
 #include "intnn_mat3d.h"
+#include "intnn_tmat.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -32,6 +33,10 @@ void intnn_load_mnist_labels(intnn_mat* outMat, int numLabelsToLoad, bool isTrai
 void intnn_load_fashion_mnist_images(intnn_mat* outMat, int numImagesToLoad, bool isTrain);
 void intnn_load_fashion_mnist_labels(intnn_mat* outMat, int numLabelsToLoad, bool isTrain);
 
+// 图像按 UINT8 存储（像素 0~255），内存占用为 int 版本的 1/4
+void intnn_load_mnist_images_tmat(intnn_tmat* outMat, int numImagesToLoad, bool isTrain);
+void intnn_load_fashion_mnist_images_tmat(intnn_tmat* outMat, int numImagesToLoad, bool isTrain);
+
 // 工具函数
 int intnn_reverse_int(int i);
 
@@ -18,4 +18,47 @@ int intnn_batch_pocket_cross_loss_delta(intnn_mat* delta_mat, const intnn_mat* y
 int intnn_batch_cross_entropy_loss(intnn_mat* loss_mat, const intnn_mat* y_mat, const intnn_mat* y_hat_mat);       // 真实交叉熵损失
 int intnn_batch_cross_entropy_loss_delta(intnn_mat* delta_mat, const intnn_mat* y_mat, const intnn_mat* y_hat_mat); // 真实交叉熵导数
 
+// 融合损失：一次遍历输出，同时写误差、累计损失并统计正确数
+typedef enum {
+    INTNN_LOSS_L2,              // 同 intnn_batch_l2_loss / intnn_batch_l2_loss_delta
+    INTNN_LOSS_POCKET_CROSS,    // 同 intnn_batch_pocket_cross_loss / intnn_batch_pocket_cross_loss_delta
+    INTNN_LOSS_CROSS_ENTROPY    // 同 intnn_batch_cross_entropy_loss / intnn_batch_cross_entropy_loss_delta
+} intnn_loss_type;
+
+typedef struct {
+    int mLoss;      // 损失之和，与对应的 intnn_batch_*_loss 返回值相同
+    int mCorrect;   // 每行最大值位置与目标一致的行数，与 intnn_count_max_match 相同
+} intnn_loss_result;
+
+/**
+ * @brief 融合的损失、误差与正确数计算：逐行读一遍 y / yHat，结果与分别调用损失、误差函数和
+ *        intnn_count_max_match 逐位相同
+ *
+ * @param delta_mat  误差输出，调整为 yHat 的形状（容量足够时不重新分配）；为 NULL 时只计算损失与正确数
+ * @param y_mat      目标
+ * @param y_hat_mat  网络输出，形状同 y_mat
+ * @param type       损失类型
+ * @return intnn_loss_result 损失之和与正确数
+ */
+intnn_loss_result intnn_batch_loss_fused(intnn_mat* delta_mat, const intnn_mat* y_mat, const intnn_mat* y_hat_mat,
+                                         intnn_loss_type type);
+
+/**
+ * @brief 稀疏目标的融合损失：目标以类别下标给出，等价于目标类为 target、其余为 0 的 one-hot 矩阵
+ *        调用 intnn_batch_loss_fused，不需要构造或按批收集 one-hot 目标
+ *
+ * 第 r 行的类别为 labels[indices[r]]（indices 为 NULL 时为 labels[r]），可直接传入打乱后的下标。
+ * 口袋交叉熵与交叉熵的目标值固定（INT_MAX / 1），忽略 target。
+ *
+ * @param delta_mat  误差输出，调整为 yHat 的形状（容量足够时不重新分配）；为 NULL 时只计算损失与正确数
+ * @param y_hat_mat  网络输出，形状 (batchSize, numClasses)
+ * @param labels     类别下标，取值 [0, numClasses)
+ * @param indices    行到 labels 的下标映射，可为 NULL
+ * @param target     L2 损失中目标类的取值，须为正数
+ * @param type       损失类型
+ * @return intnn_loss_result 损失之和与正确数
+ */
+intnn_loss_result intnn_batch_loss_fused_labels(intnn_mat* delta_mat, const intnn_mat* y_hat_mat, const int* labels,
+                                                const int* indices, int target, intnn_loss_type type);
+
 #endif // INTNN_LOSS_H
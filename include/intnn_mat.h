@@ -15,11 +15,17 @@ extern "C" {
 typedef struct {
     int mRows;
     int mCols;
-    int** mMat;
+    int mStride;        // 行跨度（元素个数），元素 (r, c) 位于 mData[r * mStride + c]
+    int mCapRows;       // 已分配的行数；行数不超过 mCapRows、列数不超过 mStride 时调整尺寸不重新分配
+    int* mData;         // 连续行优先存储，首地址及每行起始按 INTNN_MAT_ALIGN 字节对齐（列偏移视图除外）
+    int** mMat;         // 兼容层：mMat[r] == mData + r * mStride，新代码请直接使用 mData；列偏移视图为 NULL
     bool mDeleteOnDestruct;
     const char* mName;
 } intnn_mat;
 
+// 第 r 行首元素指针
+#define INTNN_MAT_ROW(mat, r) ((mat)->mData + (size_t)(r) * (mat)->mStride)
+
 // 构造与释放
 intnn_mat* intnn_create_mat(int rows, int cols);
 void intnn_free_mat(intnn_mat* mat);
@@ -31,7 +37,10 @@ void intnn_set_all_constant(intnn_mat* mat, int value);
 void intnn_set_random(intnn_mat* mat, bool allowZero, int minVal, int maxVal);
 void intnn_set_elem(intnn_mat* mat, int r, int c, int val);
 intnn_mat* intnn_set_mat_from_array(int rows, int cols, int* data);
-void intnn_reset_zero(intnn_mat* mat, int rows, int cols);
+void intnn_reset_zero(intnn_mat* mat, int rows, int cols);   // 调整尺寸并清零，容量足够时复用原存储
+void intnn_resize(intnn_mat* mat, int rows, int cols);       // 调整尺寸，不清零（内容未定义），容量足够时复用原存储
+size_t intnn_storage_bytes(int rows, int cols);               // rows x cols 矩阵数据区字节数（含行对齐填充）
+void intnn_bind_storage(intnn_mat* mat, int* data, int capRows, int cols);  // 使用外部对齐存储（不拥有，不清零，mMat 为 NULL），容量内调整尺寸不重新分配
 void intnn_reset_all_ones(intnn_mat* mat, int rows, int cols);
 
 // 获取信息
@@ -58,6 +67,7 @@ int intnn_stdev_with_avg(const intnn_mat* mat, int avg);
 
 // 标准化/归一化
 void intnn_average_colwise(intnn_mat* mat);
+void intnn_sum_colwise_of(intnn_mat* out, const intnn_mat* in);  // out(1, cols) = 各列之和（int32 回绕，与全 1 行向量乘 in 一致）
 void intnn_standardize(intnn_mat* mat, int numSigma, int low, int high);
 void intnn_normalize_rowwise(intnn_mat* mat, int newMin, int newMax);
 void intnn_normalize_colwise(intnn_mat* mat, int newMin, int newMax);
@@ -66,6 +76,7 @@ void intnn_clamp_mat(intnn_mat* mat, int low, int high);
 
 // 运算接口（in-place 和生成）
 void intnn_mat_mul_mat(intnn_mat* out, const intnn_mat* a, const intnn_mat* b);
+void intnn_mat_mul_mat_trans(intnn_mat* out, const intnn_mat* a, bool transA, const intnn_mat* b, bool transB);  // out = op(a) × op(b)，不生成转置副本
 void intnn_mat_add_mat(intnn_mat* out, const intnn_mat* a, const intnn_mat* b);
 void intnn_mat_elem_mul_mat(intnn_mat* out, const intnn_mat* a, const intnn_mat* b);
 void intnn_mat_elem_div_mat(intnn_mat* out, const intnn_mat* a, const intnn_mat* b);
@@ -89,7 +100,8 @@ void intnn_transpose_of(intnn_mat* out, const intnn_mat* in);
 void intnn_rotate180_of(intnn_mat* out, const intnn_mat* in);
 void intnn_square_root_of(intnn_mat* out, const intnn_mat* in);
 void intnn_slice_of(intnn_mat* out, const intnn_mat* in, int rowStart, int rowEnd, int colStart, int colEnd);
-void intnn_indexed_slice_of(intnn_mat* out, const intnn_mat* in, int* indices, int start, int end);
+void intnn_indexed_slice_of(intnn_mat* out, const intnn_mat* in, int* indices, int start, int end);  // 按行号收集，out 容量足够时直接写入不分配
+void intnn_view_of(intnn_mat* view, const intnn_mat* in, int rowStart, int rowEnd, int colStart, int colEnd);  // 零拷贝视图，范围同 slice_of（闭区间），共享 in 的存储与行跨度
 void intnn_random_k_samples_of(intnn_mat* out, const intnn_mat* in, int k);
 
 // 其他
@@ -8,14 +8,18 @@ typedef struct {
     int mDepth;
     int mRows;
     int mCols;
-    intnn_mat** mMat3d; // 长度为 mDepth 的指针数组，指向每层矩阵
+    intnn_mat** mMat3d; // 长度为 mDepth 的指针数组，指向每层矩阵（mFlat 的行视图，不拥有存储）
     bool mDeleteOnDestruct;
+    intnn_mat* mFlat;   // 连续存储：(mDepth * mRows) x mCols，第 d 层为第 [d * mRows, (d + 1) * mRows) 行
+    intnn_mat* mSlices; // 各层视图结构体，mMat3d[d] == &mSlices[d]
+    int mCapDepth;      // mMat3d / mSlices 已分配的层数，层数不超过它时不重新分配
 } intnn_mat3d;
 
 // 构造与析构
 intnn_mat3d* intnn_create_mat3d(int depth, int rows, int cols);
 void intnn_free_mat3d(intnn_mat3d* mat3d);
-void intnn_reset_zero3d(intnn_mat3d* mat3d, int depth, int rows, int cols);
+void intnn_reset_zero3d(intnn_mat3d* mat3d, int depth, int rows, int cols);  // 调整尺寸并清零，容量足够时复用原存储
+void intnn_resize3d(intnn_mat3d* mat3d, int depth, int rows, int cols);      // 调整尺寸，不清零（内容未定义），容量足够时复用原存储
 
 // 访问维度
 int intnn_mat3d_rows(const intnn_mat3d* mat3d);
@@ -26,9 +30,12 @@ int intnn_mat3d_depth(const intnn_mat3d* mat3d);
 int intnn_mat3d_get_elem(const intnn_mat3d* mat3d, int d, int r, int c);
 void intnn_mat3d_set_elem(intnn_mat3d* mat3d, int d, int r, int c, int val);
 
-// 访问某层矩阵指针
+// 访问某层矩阵指针（mFlat 的视图，可读写元素，不可调整尺寸）
 intnn_mat* intnn_mat3d_get_mat_at_depth(intnn_mat3d* mat3d, int d);
 
+// 整块连续存储，形状 (depth * rows, cols)；逐元素运算可一次处理所有层。空张量返回 NULL
+intnn_mat* intnn_mat3d_flat(const intnn_mat3d* mat3d);
+
 // 比较维度
 bool intnn_mat3d_dims_equal(const intnn_mat3d* m1, const intnn_mat3d* m2);
 bool intnn_mat3d_dims_equal_size(const intnn_mat3d* mat3d, int depth, int rows, int cols);
@@ -0,0 +1,183 @@
+#ifndef INTNN_NET_H
+#define INTNN_NET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "intnn_fc_layer.h"
+#include "intnn_mat.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 静态内存规划模式：决定各中间矩阵的存活区间
+typedef enum {
+    INTNN_NET_MEM_NONE,         // 未规划，各层在堆上各自持有工作矩阵
+    INTNN_NET_MEM_INFERENCE,    // 仅推理前向：只为 mOutput 规划（乒乓复用，softmax 层另需本层临时的 mInter / mActvGradInv），不能反向
+    INTNN_NET_MEM_TRAINING      // 训练：mOutput / 激活梯度（mActvGradCode 或 mActvGradInv）保留到反向结束，mInter 与反向用的误差/更新矩阵错开复用
+} intnn_net_mem_mode;
+
+// 执行计划：由 intnn_net_plan 一次生成，之后每次前向/反向直接按计划执行，不再逐层判断
+typedef struct {
+    bool mReady;            // 计划是否有效（增删层后失效，下次前向时按输入批大小重建）
+    int mMaxBatch;          // 已为之预留工作矩阵的最大批大小
+    int mInDim;             // 网络输入维度
+    int mOutDim;            // 网络输出维度
+    bool mDfaParallel;      // 除最后一层外全是 DFA：各层反向互不依赖，可并行执行
+    bool mDfaReady;         // DFA 反馈矩阵已全部初始化
+    intnn_net_mem_mode mMemMode;    // 静态内存规划模式
+    char* mSlab;                    // 所有中间矩阵所在的大块内存
+    bool mOwnsSlab;                 // mSlab 是否由网络分配
+    size_t mPeakBytes;              // 规划后的峰值字节数（= 实际使用的 slab 大小）
+    size_t mUnaliasedBytes;         // 不复用时各中间矩阵字节数之和，用于对比
+} intnn_net_plan_info;
+
+// 评估结果
+typedef struct {
+    int mNumSamples;        // 样本数
+    int mCorrect;           // 每行最大值位置与目标一致的样本数（intnn_count_max_match）
+    long long mLoss;        // L2 损失之和（intnn_batch_l2_loss；稀疏目标时等价于对应的 one-hot 目标）
+} intnn_eval_result;
+
+// 评估的取数回调：把样本 [start, end) 的输入写入 x、目标写入 y（可 resize，也可用 intnn_view_of 直接引用）；
+// 目标以类别下标给出（intnn_net_evaluate_labels）时 y 为 NULL。不同工作线程会并发调用，回调只应读取共享数据
+typedef void (*intnn_eval_fill_fn)(void* ctx, int start, int end, intnn_mat* x, intnn_mat* y);
+
+// 全连接网络：按顺序持有各层（负责释放），前向/反向迭代执行
+typedef struct {
+    intnn_fc_layer** mLayers;   // 第一层到最后一层
+    int mNumLayers;
+    int mCapacity;
+    intnn_net_plan_info mPlan;
+} intnn_net;
+
+/**
+ * @brief 创建空网络
+ *
+ * @return intnn_net* 网络，失败返回 NULL
+ */
+intnn_net* intnn_net_create(void);
+
+// 释放网络及其持有的所有层（连同结构体）
+void intnn_net_free(intnn_net* net);
+
+/**
+ * @brief 在末尾追加一层，网络取得该层的所有权并维护 mPrev / mNext 链接
+ *
+ * 须在 intnn_net_plan_memory 之前调用，已做静态内存规划后追加会断言失败。
+ *
+ * @param net    网络
+ * @param layer  全连接层，输入维度须等于当前最后一层的输出维度
+ */
+void intnn_net_add(intnn_net* net, intnn_fc_layer* layer);
+
+// 层数与按下标取层（0 为第一层，-1 为最后一层）
+int intnn_net_num_layers(const intnn_net* net);
+intnn_fc_layer* intnn_net_layer(const intnn_net* net, int index);
+
+/**
+ * @brief 生成执行计划：检查相邻层形状，按 maxBatch 预留各层工作矩阵，确定反向调度方式
+ *
+ * 不调用本函数时，首次 intnn_net_forward 按输入批大小自动生成。
+ *
+ * @param net       网络
+ * @param maxBatch  最大批大小
+ */
+void intnn_net_plan(intnn_net* net, int maxBatch);
+
+/**
+ * @brief 逐层前向（迭代，不递归）
+ *
+ * @param net  网络
+ * @param x    输入，形状 (batchSize, 第一层 inDim)；与 intnn_fc_forward 相同，反向完成前不得修改
+ * @return intnn_mat* 最后一层输出，形状 (batchSize, 最后一层 outDim)
+ */
+intnn_mat* intnn_net_forward(intnn_net* net, intnn_mat* x);
+
+/**
+ * @brief 推理前向：逐层调用 intnn_fc_infer_layer，只计算输出，输出与 intnn_net_forward 相同
+ *
+ * 不生成激活梯度、不记录输入，之后不能反向；已按推理做内存规划时 intnn_net_forward 也走这条路径。
+ *
+ * @param net  网络
+ * @param x    输入，形状 (batchSize, 第一层 inDim)
+ * @return intnn_mat* 最后一层输出
+ */
+intnn_mat* intnn_net_infer(intnn_net* net, const intnn_mat* x);
+
+/**
+ * @brief 反向并更新所有层（迭代，不递归），结果与对最后一层调用 intnn_fc_backward 逐位相同
+ *
+ * @param net         网络
+ * @param lastDeltas  最后一层的误差，形状 (batchSize, 最后一层 outDim)
+ * @param lrInv       学习率的倒数
+ */
+void intnn_net_backward(intnn_net* net, intnn_mat* lastDeltas, int lrInv);
+
+/**
+ * @brief 计算静态内存规划所需的字节数（峰值），不修改网络
+ *
+ * @param net       网络
+ * @param maxBatch  最大批大小
+ * @param mode      INTNN_NET_MEM_INFERENCE 或 INTNN_NET_MEM_TRAINING
+ * @return size_t   slab 至少需要的字节数（不含首地址对齐所需的余量）
+ */
+size_t intnn_net_memory_required(const intnn_net* net, int maxBatch, intnn_net_mem_mode mode);
+
+/**
+ * @brief 生成执行计划并做静态内存规划：按层顺序分析各中间矩阵的存活区间，
+ *        把它们分配到同一块 slab 的不同偏移，存活区间不重叠的矩阵共享内存
+ *
+ * 存活区间按 intnn_net_forward / intnn_net_backward 的逐层时序计算，不同层的矩阵可能共用同一段内存，
+ * 各层不能再被并发地单独前向或反向（流水线训练器使用自己的工作矩阵，不受影响）。
+ * 推理模式下反向所需的更新矩阵也会释放，之后不能调用 intnn_net_backward；
+ * 规划后批大小不得超过 maxBatch。
+ *
+ * @param net        网络
+ * @param maxBatch   最大批大小
+ * @param mode       INTNN_NET_MEM_INFERENCE 或 INTNN_NET_MEM_TRAINING
+ * @param slab       调用方提供的内存（如静态数组），为 NULL 时在堆上分配
+ * @param slabBytes  slab 字节数，首地址不对齐时可用部分相应减少；不足时断言失败
+ * @return size_t    峰值字节数
+ */
+size_t intnn_net_plan_memory(intnn_net* net, int maxBatch, intnn_net_mem_mode mode, void* slab, size_t slabBytes);
+
+/**
+ * @brief 分块流式评估：把 numSamples 个样本按 chunk 行一块分给线程池中的各线程推理，累计正确数与损失
+ *
+ * 每个线程只保留一块的输入、目标和两份交替使用的层输出，峰值内存与数据集大小无关；
+ * 只读取各层权重，不修改网络状态。结果与线程数无关。
+ *
+ * @param net         网络
+ * @param numSamples  样本总数
+ * @param chunk       每块行数
+ * @param fill        取数回调
+ * @param ctx         回调上下文
+ * @return intnn_eval_result 评估结果
+ */
+intnn_eval_result intnn_net_evaluate(intnn_net* net, int numSamples, int chunk, intnn_eval_fill_fn fill, void* ctx);
+
+/**
+ * @brief 稀疏目标的分块流式评估：与 intnn_net_evaluate 相同，但目标取自类别下标，
+ *        等价于目标类为 target、其余为 0 的 one-hot 目标，回调只需写入输入
+ *
+ * @param net         网络
+ * @param numSamples  样本总数
+ * @param chunk       每块行数
+ * @param fill        取数回调（y 为 NULL）
+ * @param ctx         回调上下文
+ * @param labels      各样本的类别下标，长度 numSamples
+ * @param target      目标类的取值，须为正数
+ * @return intnn_eval_result 评估结果
+ */
+intnn_eval_result intnn_net_evaluate_labels(intnn_net* net, int numSamples, int chunk, intnn_eval_fill_fn fill, void* ctx,
+                                            const int* labels, int target);
+
+// 最后一次前向的输出
+intnn_mat* intnn_net_output(const intnn_net* net);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INTNN_NET_H
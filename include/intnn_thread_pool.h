@@ -0,0 +1,56 @@
+#ifndef INTNN_THREAD_POOL_H
+#define INTNN_THREAD_POOL_H
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 并行任务：处理区间 [begin, end)，tid 为参与线程编号（0 为调用线程），
+ * 同一次 intnn_parallel_for 中各 tid 互不相同且小于线程总数；按线程分配缓冲时用 intnn_parallel_for_max 限定份数。
+ */
+typedef void (*intnn_parallel_fn)(void* ctx, int begin, int end, int tid);
+
+/**
+ * @brief 初始化（或按新参数重建）常驻线程池
+ *
+ * 不调用时首次并行会自动初始化：线程数取环境变量 INTNN_NUM_THREADS，未设置时取在线 CPU 数；
+ * 环境变量 INTNN_PIN_THREADS=1 时绑定核心。
+ *
+ * @param numThreads  线程总数（含调用线程），<= 0 表示按上述规则自动选择
+ * @param pinCores    是否把第 i 个线程绑定到第 i 个 CPU（仅 Linux 生效）
+ */
+void intnn_thread_pool_init(int numThreads, bool pinCores);
+
+// 停止并回收全部工作线程，之后的并行调用会重新初始化
+void intnn_thread_pool_shutdown(void);
+
+// 线程总数（含调用线程）；不支持线程的平台恒为 1
+int intnn_thread_pool_size(void);
+
+// [0, n) 按 grain 的整数倍切分时实际使用的份数（1 到线程总数之间）
+int intnn_parallel_parts(int n, int grain);
+
+/**
+ * @brief 把 [0, n) 切成连续区间并在线程池上并行执行，返回时全部完成
+ *
+ * 每个区间的起点都是 grain 的整数倍。调用线程也参与计算。
+ * 线程池正忙（在并行任务内部嵌套调用，或其他线程正在并行）时退化为在当前线程串行执行，tid 为 0。
+ */
+void intnn_parallel_for(int n, int grain, intnn_parallel_fn fn, void* ctx);
+
+/**
+ * @brief 同 intnn_parallel_for，但最多切成 maxParts 份，各 tid 都小于 maxParts
+ *
+ * 线程池可能在 intnn_parallel_parts 与派发之间被其他线程重建，
+ * 按 intnn_parallel_parts 的返回值分配了每线程缓冲时，把该值作为 maxParts 传入。
+ */
+void intnn_parallel_for_max(int n, int grain, int maxParts, intnn_parallel_fn fn, void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INTNN_THREAD_POOL_H
@@ -0,0 +1,67 @@
+#ifndef INTNN_TMAT_H
+#define INTNN_TMAT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "intnn_mat.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 元素类型：激活/输入用 8 位，权重用 16 位，累加结果用 32 位
+typedef enum {
+    INTNN_DTYPE_INT8,
+    INTNN_DTYPE_UINT8,
+    INTNN_DTYPE_INT16,
+    INTNN_DTYPE_INT32
+} intnn_dtype;
+
+// 带元素类型的矩阵，存储布局与 intnn_mat 相同（连续、对齐、显式行跨度）
+typedef struct {
+    int mRows;
+    int mCols;
+    int mStride;        // 行跨度（元素个数）
+    int mCapRows;       // 已分配的行数（借用的存储为 0）；类型不变、尺寸不超过容量时 intnn_tmat_resize 不重新分配
+    intnn_dtype mType;
+    void* mData;        // 连续行优先存储，首地址及每行起始按 INTNN_MAT_ALIGN 字节对齐
+    bool mDeleteOnDestruct;
+} intnn_tmat;
+
+// 类型信息
+int intnn_dtype_size(intnn_dtype type);
+int intnn_dtype_min(intnn_dtype type);
+int intnn_dtype_max(intnn_dtype type);
+
+// 构造与释放（释放时连同结构体一起释放）
+intnn_tmat* intnn_create_tmat(int rows, int cols, intnn_dtype type);
+void intnn_free_tmat(intnn_tmat* tmat);
+void intnn_tmat_reset_zero(intnn_tmat* tmat, int rows, int cols, intnn_dtype type);  // 重新设置尺寸与类型并清零
+void intnn_tmat_view_of_mat(intnn_tmat* view, const intnn_mat* mat);  // 以 INT32 类型借用 intnn_mat 的存储
+void intnn_tmat_resize(intnn_tmat* tmat, int rows, int cols, intnn_dtype type);      // 调整尺寸与类型，不清零，容量足够时复用原存储
+size_t intnn_tmat_storage_bytes(int rows, int cols, intnn_dtype type);               // 数据区字节数（含行对齐填充）
+void intnn_tmat_bind_storage(intnn_tmat* tmat, void* data, int capRows, int cols, intnn_dtype type);  // 使用外部对齐存储（不拥有）
+
+// 元素访问（写入时饱和到类型范围）
+int intnn_tmat_get_elem(const intnn_tmat* tmat, int r, int c);
+void intnn_tmat_set_elem(intnn_tmat* tmat, int r, int c, int val);
+size_t intnn_tmat_num_bytes(const intnn_tmat* tmat);
+void intnn_tmat_set_all_constant(intnn_tmat* tmat, int val);
+void intnn_tmat_set_random(intnn_tmat* tmat, bool allowZero, int minVal, int maxVal);  // 随机数序列与 intnn_set_random 相同
+intnn_tmat* intnn_copy_tmat(const intnn_tmat* tmat);
+void intnn_print_tmat(const intnn_tmat* tmat);
+
+// 类型转换
+void intnn_tmat_from_mat(intnn_tmat* out, const intnn_mat* in);   // 收窄（饱和），out 尺寸不符时重新分配
+void intnn_tmat_to_mat(intnn_mat* out, const intnn_tmat* in);     // 拓宽到 int
+void intnn_tmat_indexed_slice_to_mat(intnn_mat* out, const intnn_tmat* in, int* indices, int start, int end);
+void intnn_tmat_rows_to_mat(intnn_mat* out, const intnn_tmat* in, int start, int end);  // 连续行 [start, end)
+
+// 混合位宽矩阵乘法：out(int32) = a × b，a、b 可为任意元素类型
+void intnn_tmat_mul_tmat(intnn_mat* out, const intnn_tmat* a, const intnn_tmat* b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INTNN_TMAT_H
@@ -17,8 +17,16 @@ int intnn_floor_sqrt(int x);
 int intnn_int_round_log(int base, int x, int x_shift, int y_shift, int get_closest);
 int intnn_approx_log(int base, int x, int get_closest);
 int intnn_round_to_unit(int n, int unit);
+int intnn_exact_log2(int x);  // x 为 2 的非负整数次幂时返回指数，否则返回 -1
 void intnn_tools_shuffle_indices(int* indices, int size);
 
+// 按 INTNN_MAT_ALIGN 字节对齐的内存分配与释放
+void* intnn_aligned_alloc(size_t bytes);
+void intnn_aligned_free(void* ptr);
+
+// 单调墙钟时间（秒），用于统计多线程训练耗时
+double intnn_wall_seconds(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,8 +1,11 @@
+#include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 #include <assert.h>
 #include <limits.h>
+#include <string.h>
 #include "intnn_actv.h"
+#include "intnn_actv_kernels.h"
 #include "intnn_mat.h"
 #include "intnn_mat3d.h"
 #include "intnn_consts.h"
@@ -71,235 +74,514 @@ void intnn_activate(intnn_mat* matOut, intnn_mat* matIn, intnn_mat* matActvGradI
     }
 }
 
-void intnn_sigmoid(intnn_mat* matOut, intnn_mat* matIn, intnn_mat* matActvGradInv, int k) {
-    const int yMin = 1;
-    const int yMax = INTNN_MAX;
-    const int joints[] = {-127, -74, -31, 32, 75, 128};
-    const int slopesInv[] = {INTNN_MAX, 8, 2, 1, 2, 8, INTNN_MAX};
-    const int divisor = 1 << k;
-
-    for (int r = 0; r < intnn_rows(matOut); r++) {
-        for (int c = 0; c < intnn_cols(matOut); c++) {
-            int x = intnn_get_elem(matIn, r, c) / divisor;
-            int y, grad;
-            
-            if (x < joints[0])       { y = yMin; grad = slopesInv[0]; }
-            else if (x < joints[1])  { y = x/8 + 20; grad = slopesInv[1]; }
-            else if (x < joints[2])  { y = x/2 + 48; grad = slopesInv[2]; }
-            else if (x < joints[3])  { y = x + 64; grad = slopesInv[3]; }
-            else if (x < joints[4])  { y = x/2 + 80; grad = slopesInv[4]; }
-            else if (x < joints[5])  { y = x/8 + 108; grad = slopesInv[5]; }
-            else                     { y = yMax; grad = slopesInv[6]; }
-            
-            intnn_set_elem(matOut, r, c, clamp(y, yMin, yMax));
-            intnn_set_elem(matActvGradInv, r, c, grad);
-        }
-    }
+// Per-element kernels -------------------------------------------------------
+// Shared by the matrix routines below and by intnn_activate_row (the fused GEMM
+// epilogue), so both paths produce identical outputs and gradient inverses.
+
+// Piecewise-linear sigmoid/tanh. Joints at x = -127, -74, -31, 32, 75, 128 with
+// slope inverses {INTNN_MAX, 8, 2, 1, 2, 8, INTNN_MAX}. Every scaled input below
+// the first joint or at/above the last one saturates, so the branches are only
+// evaluated on x in [-128, 128]: the compiler folds them into 257-entry lookup
+// tables at build time and the element kernels become a clamp plus a load.
+#define PWL_CLAMP(y, lo, hi) ((y) < (lo) ? (lo) : ((y) > (hi) ? (hi) : (y)))
+#define PWL_SEGMENT(x) ((x) < -127 ? 0 : (x) < -74 ? 1 : (x) < -31 ? 2 : (x) < 32 ? 3 : (x) < 75 ? 4 : (x) < 128 ? 5 : 6)
+#define SIGMOID_Y(x) PWL_CLAMP((x) < -127 ? 1 : (x) < -74 ? (x)/8 + 20 : (x) < -31 ? (x)/2 + 48 : \
+                               (x) < 32 ? (x) + 64 : (x) < 75 ? (x)/2 + 80 : (x) < 128 ? (x)/8 + 108 : INTNN_MAX, \
+                               1, INTNN_MAX)
+#define TANH_Y(x) PWL_CLAMP((x) < -127 ? INTNN_MIN : (x) < -74 ? (x)/4 - 88 : (x) < -31 ? (x) - 32 : \
+                            (x) < 32 ? 2*(x) : (x) < 75 ? (x) + 32 : (x) < 128 ? (x)/4 + 88 : INTNN_MAX, \
+                            INTNN_MIN, INTNN_MAX)
+#define PWL_GRAD_INV(x) (PWL_SEGMENT(x) == 0 || PWL_SEGMENT(x) == 6 ? INTNN_MAX : \
+                         PWL_SEGMENT(x) == 1 || PWL_SEGMENT(x) == 5 ? 8 : PWL_SEGMENT(x) == 3 ? 1 : 2)
+#define PWL_GRAD_CODE(x) (PWL_SEGMENT(x) == 0 || PWL_SEGMENT(x) == 6 ? INTNN_GRAD_CODE_SAT : \
+                          PWL_SEGMENT(x) == 1 || PWL_SEGMENT(x) == 5 ? 3 : PWL_SEGMENT(x) == 3 ? 0 : 1)
+
+#define PWL_LUT4(F, b)   F(b), F((b) + 1), F((b) + 2), F((b) + 3)
+#define PWL_LUT16(F, b)  PWL_LUT4(F, b), PWL_LUT4(F, (b) + 4), PWL_LUT4(F, (b) + 8), PWL_LUT4(F, (b) + 12)
+#define PWL_LUT64(F, b)  PWL_LUT16(F, b), PWL_LUT16(F, (b) + 16), PWL_LUT16(F, (b) + 32), PWL_LUT16(F, (b) + 48)
+#define PWL_LUT257(F)    PWL_LUT64(F, -128), PWL_LUT64(F, -64), PWL_LUT64(F, 0), PWL_LUT64(F, 64), F(128)
+
+// int32 entries so the SIMD kernels can gather them (intnn_actv_kernels.h)
+const int32_t intnn_pwl_sigmoid_lut[INTNN_PWL_LUT_SIZE] = { PWL_LUT257(SIGMOID_Y) };
+const int32_t intnn_pwl_tanh_lut[INTNN_PWL_LUT_SIZE] = { PWL_LUT257(TANH_Y) };
+const int32_t intnn_pwl_grad_inv_lut[INTNN_PWL_LUT_SIZE] = { PWL_LUT257(PWL_GRAD_INV) };
+const int32_t intnn_pwl_grad_code_lut[INTNN_PWL_LUT_SIZE] = { PWL_LUT257(PWL_GRAD_CODE) };
+
+// Table index of the scaled input in / divisor
+static inline int pwl_index(int in, int divisor) {
+    const int lo = INTNN_PWL_LUT_MIN;
+    const int hi = INTNN_PWL_LUT_MIN + INTNN_PWL_LUT_SIZE - 1;
+    const int x = in / divisor;
+    return (x < lo ? lo : (x > hi ? hi : x)) - lo;
 }
 
-void intnn_tanh(intnn_mat* matOut, intnn_mat* matIn, intnn_mat* matActvGradInv, int k, int numItems) {
-    const int joints[] = {-127, -74, -31, 32, 75, 128};
-    const int slopesInv[] = {INTNN_MAX, 8, 2, 1, 2, 8, INTNN_MAX};  // Fixed slope inverses
-    const int divisor = (1 << k) * numItems;
+static inline int sigmoid_elem(int in, int divisor, int* grad) {
+    const int i = pwl_index(in, divisor);
+    *grad = intnn_pwl_grad_inv_lut[i];
+    return intnn_pwl_sigmoid_lut[i];
+}
 
-    /*printf("matIn in tahn:\n");
-    intnn_print_mat(matIn);*/
+static inline int tanh_elem(int in, int divisor, int* grad) {
+    const int i = pwl_index(in, divisor);
+    *grad = intnn_pwl_grad_inv_lut[i];
+    return intnn_pwl_tanh_lut[i];
+}
 
-    for (int r = 0; r < matOut->mRows; r++) {
-        for (int c = 0; c < matOut->mCols; c++) {
-            int x = intnn_get_elem(matIn, r, c) / divisor;
-            int y, grad;
-            
-            if (x < joints[0])       { y = INTNN_MIN; grad = slopesInv[0]; }
-            else if (x < joints[1])  { y = x/4 - 88; grad = slopesInv[1]; }
-            else if (x < joints[2])  { y = x - 32; grad = slopesInv[2]; }
-            else if (x < joints[3])  { y = 2*x; grad = slopesInv[3]; }
-            else if (x < joints[4])  { y = x + 32; grad = slopesInv[4]; }
-            else if (x < joints[5])  { y = x/4 + 88; grad = slopesInv[5]; }
-            else                     { y = INTNN_MAX; grad = slopesInv[6]; }
-
-            //printf("@%d, %d\n", x, y);
-            
-            intnn_set_elem(matOut, r, c, clamp(y, INTNN_MIN, INTNN_MAX));
-            intnn_set_elem(matActvGradInv, r, c, grad);
-        }
-    }
+static inline int relu8bit_elem(int val, int* grad) {
+    *grad = (val < 0 || val > INTNN_MAX) ? INTNN_MAX : 1;
+    return clamp(val, 0, INTNN_MAX);
+}
+
+// Written as selects rather than an if/else chain so the loops stay branchless:
+// below SHRT_MIN -> SHRT_MIN, negative -> val / 5, then clamp at SHRT_MAX, where
+// the two saturated ends report INTNN_MAX.
+static inline int leakyrelu_elem(int val, int* grad) {
+    const int leakSlope = 5;
+    const int neg = clamp(val, SHRT_MIN, 0) / leakSlope;
+    const int saturated = val < SHRT_MIN || val >= SHRT_MAX;
 
-    //printf("output in tanh:\n");
-    //intnn_print_mat(matOut);
+    *grad = saturated ? INTNN_MAX : (val < 0 ? leakSlope : 1);
+    return val < 0 ? (val < SHRT_MIN ? SHRT_MIN : neg) : (val < SHRT_MAX ? val : SHRT_MAX);
 }
 
-void intnn_rescale(intnn_mat* matOut, intnn_mat* matIn, intnn_mat* matActvGradInv, int k) {
-    const int divisor = 1 << k;
-    intnn_set_all_constant(matActvGradInv, 1);
-    
-    for (int r = 0; r < intnn_rows(matOut); r++) {
-        for (int c = 0; c < intnn_cols(matOut); c++) {
-            int val = intnn_get_elem(matIn, r, c) / divisor;
-            intnn_set_elem(matOut, r, c, val);
-        }
+static inline int plu_elem(int x, int* grad) {
+    const int slope = 10;  // Slope 1/a
+    const int c = 1;
+    int plu_min = (x - c) / slope + c;
+    int plu_max = (x + c) / slope - c;
+    int y = clamp(x, plu_min, plu_max);
+
+    *grad = (x != 0) ? abs(y / x) : 1;
+    return clamp(y, INTNN_MIN, INTNN_MAX);
+}
+
+bool intnn_actv_is_elementwise(intnn_actv_type actv) {
+    switch (actv) {
+        case INTNN_ACTV_SIGMOID:
+        case INTNN_ACTV_TANH:
+        case INTNN_ACTV_RESCALE:
+        case INTNN_ACTV_RELU8BIT:
+        case INTNN_ACTV_LEAKYRELU:
+        case INTNN_ACTV_PLU:
+        case INTNN_ACTV_AS_IS:
+            return true;
+        default:
+            return false;  // softmax needs the whole row before it can scale
     }
 }
 
-void intnn_softmax(intnn_mat* matOut, intnn_mat* matIn, intnn_mat* matActvGradInv, int k) {
-    for (int r = 0; r < intnn_rows(matOut); r++) {
-        int rowSum = 0;
-        // First pass: clamp negatives and compute row sum
-        for (int c = 0; c < intnn_cols(matOut); c++) {
-            int val = intnn_get_elem(matIn, r, c);
-            if (val <= 0) {
-                intnn_set_elem(matOut, r, c, 0);
-            } else {
-                intnn_set_elem(matOut, r, c, val);
-                rowSum += val;
+static void activate_row_scalar(int* out, int* gradInv, const int* in, int n,
+                                intnn_actv_type actv, int k, int numItems) {
+    switch (actv) {
+        case INTNN_ACTV_SIGMOID: {
+            const int divisor = 1 << k;
+            for (int c = 0; c < n; c++)
+                out[c] = sigmoid_elem(in[c], divisor, &gradInv[c]);
+            break;
+        }
+        case INTNN_ACTV_TANH: {
+            const int divisor = (1 << k) * numItems;
+            for (int c = 0; c < n; c++)
+                out[c] = tanh_elem(in[c], divisor, &gradInv[c]);
+            break;
+        }
+        case INTNN_ACTV_RESCALE: {
+            const int divisor = 1 << k;
+            for (int c = 0; c < n; c++) {
+                out[c] = in[c] / divisor;
+                gradInv[c] = 1;
             }
+            break;
         }
+        case INTNN_ACTV_RELU8BIT:
+            for (int c = 0; c < n; c++)
+                out[c] = relu8bit_elem(in[c], &gradInv[c]);
+            break;
+        case INTNN_ACTV_LEAKYRELU:
+            for (int c = 0; c < n; c++)
+                out[c] = leakyrelu_elem(in[c], &gradInv[c]);
+            break;
+        case INTNN_ACTV_PLU:
+            for (int c = 0; c < n; c++)
+                out[c] = plu_elem(in[c], &gradInv[c]);
+            break;
+        case INTNN_ACTV_AS_IS:
+            for (int c = 0; c < n; c++) {
+                out[c] = in[c];
+                gradInv[c] = 1;
+            }
+            break;
+        default:
+            printf("Unsupported row-wise activation type\n");
+            assert(0);
+            break;
+    }
+}
 
-        rowSum = (rowSum == 0) ? 1 : rowSum;  // Avoid division by zero
-        const int scaleFactor = INTNN_MAX / rowSum;
-        
-        // Second pass: rescale values
-        for (int c = 0; c < intnn_cols(matOut); c++) {
-            int current = intnn_get_elem(matOut, r, c);
-            int newVal = (current == 0) ? 0 : current * scaleFactor;
-            
-            intnn_set_elem(matOut, r, c, newVal);
-            intnn_set_elem(matActvGradInv, r, c, (current == 0) ? INTNN_MAX : 1);
+// Output-only variant for inference: no gradient inverses are stored. out may
+// alias in (each element is read before it is written).
+static void activate_row_nograd_scalar(int* out, const int* in, int n,
+                                       intnn_actv_type actv, int k, int numItems) {
+    int grad;  // discarded; the element helpers are inlined so the stores vanish
+    switch (actv) {
+        case INTNN_ACTV_SIGMOID: {
+            const int divisor = 1 << k;
+            for (int c = 0; c < n; c++)
+                out[c] = sigmoid_elem(in[c], divisor, &grad);
+            break;
+        }
+        case INTNN_ACTV_TANH: {
+            const int divisor = (1 << k) * numItems;
+            for (int c = 0; c < n; c++)
+                out[c] = tanh_elem(in[c], divisor, &grad);
+            break;
+        }
+        case INTNN_ACTV_RESCALE: {
+            const int divisor = 1 << k;
+            for (int c = 0; c < n; c++)
+                out[c] = in[c] / divisor;
+            break;
         }
+        case INTNN_ACTV_RELU8BIT:
+            for (int c = 0; c < n; c++)
+                out[c] = relu8bit_elem(in[c], &grad);
+            break;
+        case INTNN_ACTV_LEAKYRELU:
+            for (int c = 0; c < n; c++)
+                out[c] = leakyrelu_elem(in[c], &grad);
+            break;
+        case INTNN_ACTV_PLU:
+            for (int c = 0; c < n; c++)
+                out[c] = plu_elem(in[c], &grad);
+            break;
+        case INTNN_ACTV_AS_IS:
+            if (out != in)
+                memmove(out, in, sizeof(int) * (size_t)n);
+            break;
+        default:
+            printf("Unsupported row-wise activation type\n");
+            assert(0);
+            break;
     }
 }
 
-void intnn_relu8bit(intnn_mat* matOut, intnn_mat* matIn, intnn_mat* matActvGradInv, int k) {
-    for (int r = 0; r < intnn_rows(matOut); r++) {
-        for (int c = 0; c < intnn_cols(matOut); c++) {
-            int val = intnn_get_elem(matIn, r, c);
-            int clamped = clamp(val, 0, INTNN_MAX);
-            int grad = (val < 0 || val > INTNN_MAX) ? INTNN_MAX : 1;
-            
-            intnn_set_elem(matOut, r, c, clamped);
-            intnn_set_elem(matActvGradInv, r, c, grad);
-        }
+// Shift-coded gradients -------------------------------------------------------
+// Every gradient inverse produced by the codable kernels is a power of two, the
+// saturation value INTNN_MAX or the leaky slope 5, so one byte per element is
+// enough and backward replaces the general division with a shift.
+
+static inline uint8_t grad_code_of(int gradInv) {
+    switch (gradInv) {
+        case 1: return 0;
+        case 2: return 1;
+        case 8: return 3;
+        case 5: return INTNN_GRAD_CODE_DIV5;
+        default: return INTNN_GRAD_CODE_SAT;  // INTNN_MAX
     }
 }
 
-void intnn_leakyrelu(intnn_mat* matOut, intnn_mat* matIn, intnn_mat* matActvGradInv, int k) {
-    const int leakSlope = 5;
-    
-    for (int r = 0; r < intnn_rows(matOut); r++) {
-        for (int c = 0; c < intnn_cols(matOut); c++) {
-            int val = intnn_get_elem(matIn, r, c);
-            int y, grad;
-            
-            if (val < SHRT_MIN)      { y = SHRT_MIN; grad = INTNN_MAX; }
-            else if (val < 0)        { y = val / leakSlope; grad = leakSlope; }
-            else if (val < SHRT_MAX) { y = val; grad = 1; }
-            else                     { y = SHRT_MAX; grad = INTNN_MAX; }
-            
-            intnn_set_elem(matOut, r, c, y);
-            intnn_set_elem(matActvGradInv, r, c, grad);
+bool intnn_actv_has_grad_code(intnn_actv_type actv) {
+    return intnn_actv_is_elementwise(actv) && actv != INTNN_ACTV_PLU;
+}
+
+static void activate_row_code_scalar(int* out, uint8_t* code, const int* in, int n,
+                                     intnn_actv_type actv, int k, int numItems) {
+    int grad;  // the element helpers are inlined, so each branch folds to a constant code
+    switch (actv) {
+        case INTNN_ACTV_SIGMOID: {
+            const int divisor = 1 << k;
+            for (int c = 0; c < n; c++) {
+                const int i = pwl_index(in[c], divisor);
+                out[c] = intnn_pwl_sigmoid_lut[i];
+                code[c] = (uint8_t)intnn_pwl_grad_code_lut[i];
+            }
+            break;
+        }
+        case INTNN_ACTV_TANH: {
+            const int divisor = (1 << k) * numItems;
+            for (int c = 0; c < n; c++) {
+                const int i = pwl_index(in[c], divisor);
+                out[c] = intnn_pwl_tanh_lut[i];
+                code[c] = (uint8_t)intnn_pwl_grad_code_lut[i];
+            }
+            break;
         }
+        case INTNN_ACTV_RESCALE: {
+            const int divisor = 1 << k;
+            for (int c = 0; c < n; c++)
+                out[c] = in[c] / divisor;
+            memset(code, 0, (size_t)n);
+            break;
+        }
+        case INTNN_ACTV_RELU8BIT:
+            for (int c = 0; c < n; c++) {
+                out[c] = relu8bit_elem(in[c], &grad);
+                code[c] = grad_code_of(grad);
+            }
+            break;
+        case INTNN_ACTV_LEAKYRELU:
+            for (int c = 0; c < n; c++) {
+                out[c] = leakyrelu_elem(in[c], &grad);
+                code[c] = grad_code_of(grad);
+            }
+            break;
+        case INTNN_ACTV_AS_IS:
+            for (int c = 0; c < n; c++)
+                out[c] = in[c];
+            memset(code, 0, (size_t)n);
+            break;
+        default:
+            printf("Activation type has no gradient code\n");
+            assert(0);
+            break;
     }
 }
 
-void intnn_plu(intnn_mat* matOut, intnn_mat* matIn, intnn_mat* matActvGradInv, int k) {
-    const int slope = 10;  // Slope 1/a
-    const int c = 1;
-    
-    for (int r = 0; r < intnn_rows(matOut); r++) {
-        for (int c_idx = 0; c_idx < intnn_cols(matOut); c_idx++) {
-            int x = intnn_get_elem(matIn, r, c_idx);
-            int plu_min = (x - c) / slope + c;
-            int plu_max = (x + c) / slope - c;
-            int y = clamp(x, plu_min, plu_max);
-            
-            intnn_set_elem(matOut, r, c_idx, clamp(y, INTNN_MIN, INTNN_MAX));
-            
-            int grad = (x != 0) ? abs(y / x) : 1;
-            intnn_set_elem(matActvGradInv, r, c_idx, grad);
-        }
+// Kernel dispatch ---------------------------------------------------------------
+// Same scheme as the GEMM micro-kernels: the scalar kernels above are always
+// available, the SIMD ones (intnn_actv_x86.c) are picked by CPUID on first use
+// or forced with INTNN_ACTV_KERNEL. The SIMD kernels cover the vector-width
+// prefix of a row and the scalar kernels finish the tail.
+
+typedef struct {
+    const char* mName;
+    intnn_actv_row_kernel mRow;           // NULL: scalar only
+    intnn_actv_softmax_kernel mSoftmax;
+} intnn_actv_kernel_set;
+
+static const intnn_actv_kernel_set gActvKernelSets[] = {
+    { "scalar", NULL, NULL },
+#ifdef INTNN_ACTV_X86
+    { "avx2", intnn_actv_row_avx2, intnn_actv_softmax_row_avx2 },
+#endif
+};
+static const int gNumActvKernelSets = (int)(sizeof(gActvKernelSets) / sizeof(gActvKernelSets[0]));
+
+static const intnn_actv_kernel_set* gActiveActvKernels = NULL;
+
+static bool intnn_actv_kernel_supported(int idx) {
+#ifdef INTNN_ACTV_X86
+    __builtin_cpu_init();
+    if (strcmp(gActvKernelSets[idx].mName, "avx2") == 0)
+        return __builtin_cpu_supports("avx2");
+#endif
+    return idx == 0;
+}
+
+// Returns the kernel set with this name, or NULL if it is unknown or the
+// CPU does not support it
+static const intnn_actv_kernel_set* intnn_actv_find_kernel(const char* name) {
+    for (int i = 0; i < gNumActvKernelSets; i++) {
+        if (strcmp(gActvKernelSets[i].mName, name) == 0)
+            return intnn_actv_kernel_supported(i) ? &gActvKernelSets[i] : NULL;
     }
+    return NULL;
 }
 
-void intnn_as_is(intnn_mat* matOut, intnn_mat* matIn, intnn_mat* matActvGradInv, int k) {
-    for (int r = 0; r < intnn_rows(matOut); r++) {
-        for (int c = 0; c < intnn_cols(matOut); c++) {
-            int val = intnn_get_elem(matIn, r, c);
-            intnn_set_elem(matOut, r, c, val);
+bool intnn_actv_set_kernel(const char* name) {
+    const intnn_actv_kernel_set* ks = name ? intnn_actv_find_kernel(name) : NULL;
+    if (!ks)
+        return false;
+    __atomic_store_n(&gActiveActvKernels, ks, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Resolved on first use: INTNN_ACTV_KERNEL wins, otherwise the fastest set
+// the CPU supports. Pipeline stages, Hogwild workers and eval workers can
+// all get here at once, so every racer computes the same choice and only the
+// thread whose compare-exchange publishes it reports a bad env value.
+static const intnn_actv_kernel_set* intnn_actv_active_kernels(void) {
+    const intnn_actv_kernel_set* active = __atomic_load_n(&gActiveActvKernels, __ATOMIC_ACQUIRE);
+    if (active)
+        return active;
+
+    const char* env = getenv("INTNN_ACTV_KERNEL");
+    const bool hasEnv = env && env[0];
+    const intnn_actv_kernel_set* chosen = hasEnv ? intnn_actv_find_kernel(env) : NULL;
+    const bool badEnv = hasEnv && !chosen;
+    for (int i = gNumActvKernelSets - 1; !chosen && i >= 0; i--) {
+        if (intnn_actv_kernel_supported(i))
+            chosen = &gActvKernelSets[i];
+    }
+
+    if (!__atomic_compare_exchange_n(&gActiveActvKernels, &active, chosen, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        return active;  // Another thread published first
+    if (badEnv)
+        printf("[WARN] INTNN_ACTV_KERNEL=%s is unknown or unsupported on this CPU, using auto\n", env);
+    return chosen;
+}
+
+const char* intnn_actv_kernel_name(void) {
+    return intnn_actv_active_kernels()->mName;
+}
+
+void intnn_activate_row(int* out, int* gradInv, const int* in, int n,
+                        intnn_actv_type actv, int k, int numItems) {
+    const intnn_actv_kernel_set* ks = intnn_actv_active_kernels();
+    const int done = ks->mRow ? ks->mRow(out, gradInv, NULL, in, n, actv, k, numItems) : 0;
+    activate_row_scalar(out + done, gradInv + done, in + done, n - done, actv, k, numItems);
+}
+
+void intnn_activate_row_nograd(int* out, const int* in, int n,
+                               intnn_actv_type actv, int k, int numItems) {
+    const intnn_actv_kernel_set* ks = intnn_actv_active_kernels();
+    const int done = ks->mRow ? ks->mRow(out, NULL, NULL, in, n, actv, k, numItems) : 0;
+    activate_row_nograd_scalar(out + done, in + done, n - done, actv, k, numItems);
+}
+
+void intnn_activate_row_code(int* out, uint8_t* code, const int* in, int n,
+                             intnn_actv_type actv, int k, int numItems) {
+    const intnn_actv_kernel_set* ks = intnn_actv_active_kernels();
+    const int done = ks->mRow && intnn_actv_has_grad_code(actv) ? ks->mRow(out, NULL, code, in, n, actv, k, numItems) : 0;
+    activate_row_code_scalar(out + done, code + done, in + done, n - done, actv, k, numItems);
+}
+
+static void softmax_row_scalar(int* out, int* gradInv, const int* in, int n) {
+    int rowSum = 0;
+    // First pass: clamp negatives and compute row sum
+    for (int c = 0; c < n; c++) {
+        out[c] = in[c] > 0 ? in[c] : 0;
+        rowSum += out[c];
+    }
+
+    rowSum = (rowSum == 0) ? 1 : rowSum;  // Avoid division by zero
+    const int scaleFactor = INTNN_MAX / rowSum;
+
+    // Second pass: rescale values
+    for (int c = 0; c < n; c++) {
+        gradInv[c] = (out[c] == 0) ? INTNN_MAX : 1;
+        out[c] *= scaleFactor;
+    }
+}
+
+int intnn_grad_code_inv(uint8_t code) {
+    if (code == INTNN_GRAD_CODE_SAT)
+        return INTNN_MAX;
+    if (code == INTNN_GRAD_CODE_DIV5)
+        return 5;
+    return 1 << code;
+}
+
+void intnn_apply_grad_code_row(int* out, const int* in, const uint8_t* code, int n) {
+    for (int c = 0; c < n; c++) {
+        const int v = in[c];
+        const unsigned s = code[c];
+        if (s < 32) {
+            // Adding 2^s - 1 to negative values makes the arithmetic shift round
+            // toward zero, matching C division by 2^s
+            out[c] = (v + (int)((unsigned)(v >> 31) & ((1u << s) - 1u))) >> s;
+        } else if (s == INTNN_GRAD_CODE_SAT) {
+            out[c] = v / INTNN_MAX;
+        } else {
+            out[c] = v / 5;
         }
     }
-    intnn_set_all_constant(matActvGradInv, 1);
+}
+
+// Matrix activation routines -------------------------------------------------
+
+static void check_activation_shapes(const intnn_mat* matOut, const intnn_mat* matIn, const intnn_mat* matActvGradInv) {
+    if (!intnn_dims_equal(matOut, matIn) ||
+        matActvGradInv->mRows < matOut->mRows || matActvGradInv->mCols < matOut->mCols) {
+        printf("Activation shape mismatch\n");
+        assert(0);
+    }
+}
+
+// Row-pointer loop over the row kernels: checks the shapes once instead of
+// bounds-checking every element
+static void activate_rows(intnn_mat* matOut, const intnn_mat* matIn, intnn_mat* matActvGradInv,
+                          intnn_actv_type actv, int k, int numItems) {
+    check_activation_shapes(matOut, matIn, matActvGradInv);
+    for (int r = 0; r < matOut->mRows; r++)
+        intnn_activate_row(INTNN_MAT_ROW(matOut, r), INTNN_MAT_ROW(matActvGradInv, r), INTNN_MAT_ROW(matIn, r),
+                           matOut->mCols, actv, k, numItems);
+}
+
+void intnn_sigmoid(intnn_mat* matOut, intnn_mat* matIn, intnn_mat* matActvGradInv, int k) {
+    activate_rows(matOut, matIn, matActvGradInv, INTNN_ACTV_SIGMOID, k, 1);
+}
+
+void intnn_tanh(intnn_mat* matOut, intnn_mat* matIn, intnn_mat* matActvGradInv, int k, int numItems) {
+    activate_rows(matOut, matIn, matActvGradInv, INTNN_ACTV_TANH, k, numItems);
+}
+
+void intnn_rescale(intnn_mat* matOut, intnn_mat* matIn, intnn_mat* matActvGradInv, int k) {
+    activate_rows(matOut, matIn, matActvGradInv, INTNN_ACTV_RESCALE, k, 1);
+}
+
+void intnn_softmax(intnn_mat* matOut, intnn_mat* matIn, intnn_mat* matActvGradInv, int k) {
+    (void)k;
+    check_activation_shapes(matOut, matIn, matActvGradInv);
+    const intnn_actv_kernel_set* ks = intnn_actv_active_kernels();
+    for (int r = 0; r < matOut->mRows; r++) {
+        int* out = INTNN_MAT_ROW(matOut, r);
+        int* gradInv = INTNN_MAT_ROW(matActvGradInv, r);
+        const int* in = INTNN_MAT_ROW(matIn, r);
+        if (ks->mSoftmax)
+            ks->mSoftmax(out, gradInv, in, matOut->mCols);
+        else
+            softmax_row_scalar(out, gradInv, in, matOut->mCols);
+    }
+}
+
+void intnn_relu8bit(intnn_mat* matOut, intnn_mat* matIn, intnn_mat* matActvGradInv, int k) {
+    (void)k;
+    activate_rows(matOut, matIn, matActvGradInv, INTNN_ACTV_RELU8BIT, 0, 1);
+}
+
+void intnn_leakyrelu(intnn_mat* matOut, intnn_mat* matIn, intnn_mat* matActvGradInv, int k) {
+    (void)k;
+    activate_rows(matOut, matIn, matActvGradInv, INTNN_ACTV_LEAKYRELU, 0, 1);
+}
+
+void intnn_plu(intnn_mat* matOut, intnn_mat* matIn, intnn_mat* matActvGradInv, int k) {
+    (void)k;
+    activate_rows(matOut, matIn, matActvGradInv, INTNN_ACTV_PLU, 0, 1);
+}
+
+void intnn_as_is(intnn_mat* matOut, intnn_mat* matIn, intnn_mat* matActvGradInv, int k) {
+    (void)k;
+    activate_rows(matOut, matIn, matActvGradInv, INTNN_ACTV_AS_IS, 0, 1);
 }
 
 // 3D Activation Functions -----------------------------------------------------
 
+// The tensor is stored as one (depth * rows) x cols matrix, so every
+// activation type runs over all slices in a single pass. Softmax stays
+// row-wise, which is the same as applying it to each slice. Output and
+// gradient tensors are only reshaped when their dimensions differ.
 void intnn_activate3d(intnn_mat3d* mat3dOut, intnn_mat3d* mat3dIn, 
                      intnn_mat3d* matActvGradInv3d, intnn_actv_type actv, 
                      int k, int numItems) {
-    // Get dimensions for reuse
     const int depth = intnn_mat3d_depth(mat3dIn);
     const int rows = intnn_mat3d_rows(mat3dIn);
     const int cols = intnn_mat3d_cols(mat3dIn);
-    
-    // Reset output if dimensions mismatch
-    if (!intnn_mat3d_dims_equal(mat3dOut, mat3dIn)) {
-        intnn_reset_zero3d(mat3dOut, depth, rows, cols);
-    }
-    
-    // Reset gradient tensor
-    intnn_reset_zero3d(matActvGradInv3d, depth, rows, cols);
-
-    // Process each depth slice
-    for (int d = 0; d < depth; d++) {
-        intnn_mat* outSlice = intnn_mat3d_get_mat_at_depth(mat3dOut, d);
-        intnn_mat* inSlice = intnn_mat3d_get_mat_at_depth(mat3dIn, d);
-        intnn_mat* gradSlice = intnn_mat3d_get_mat_at_depth(matActvGradInv3d, d);
-        
-        switch (actv) {
-            case INTNN_ACTV_SIGMOID:
-                intnn_sigmoid(outSlice, inSlice, gradSlice, k);
-                break;
-            case INTNN_ACTV_TANH:
-                intnn_tanh(outSlice, inSlice, gradSlice, k, numItems);
-                break;
-            case INTNN_ACTV_RESCALE:
-                intnn_rescale(outSlice, inSlice, gradSlice, k);
-                break;
-            default:
-                printf("Unsupported 3D activation type\n");
-                break;
-        }
-    }
+
+    // Every element of out and grad is written below, so no zeroing is needed
+    if (!intnn_mat3d_dims_equal(mat3dOut, mat3dIn))
+        intnn_resize3d(mat3dOut, depth, rows, cols);
+    if (!intnn_mat3d_dims_equal(matActvGradInv3d, mat3dIn))
+        intnn_resize3d(matActvGradInv3d, depth, rows, cols);
+
+    intnn_mat* flatIn = intnn_mat3d_flat(mat3dIn);
+    if (!flatIn)
+        return;
+    intnn_activate(intnn_mat3d_flat(mat3dOut), flatIn, intnn_mat3d_flat(matActvGradInv3d), actv, k, numItems);
 }
 
 void intnn_sigmoid3d(intnn_mat3d* mat3dOut, intnn_mat3d* mat3dIn, 
                      intnn_mat3d* matActvGradInv3d, int k) {
-    const int depth = intnn_mat3d_depth(mat3dIn);
-    for (int d = 0; d < depth; d++) {
-        intnn_mat* outSlice = intnn_mat3d_get_mat_at_depth(mat3dOut, d);
-        intnn_mat* inSlice = intnn_mat3d_get_mat_at_depth(mat3dIn, d);
-        intnn_mat* gradSlice = intnn_mat3d_get_mat_at_depth(matActvGradInv3d, d);
-        intnn_sigmoid(outSlice, inSlice, gradSlice, k);
-    }
+    intnn_activate3d(mat3dOut, mat3dIn, matActvGradInv3d, INTNN_ACTV_SIGMOID, k, 1);
 }
 
 void intnn_tanh3d(intnn_mat3d* mat3dOut, intnn_mat3d* mat3dIn, 
                  intnn_mat3d* matActvGradInv3d, int k, int numItems) {
-    const int depth = intnn_mat3d_depth(mat3dIn);
-    for (int d = 0; d < depth; d++) {
-        intnn_mat* outSlice = intnn_mat3d_get_mat_at_depth(mat3dOut, d);
-        intnn_mat* inSlice = intnn_mat3d_get_mat_at_depth(mat3dIn, d);
-        intnn_mat* gradSlice = intnn_mat3d_get_mat_at_depth(matActvGradInv3d, d);
-        intnn_tanh(outSlice, inSlice, gradSlice, k, numItems);
-    }
+    intnn_activate3d(mat3dOut, mat3dIn, matActvGradInv3d, INTNN_ACTV_TANH, k, numItems);
 }
 
 void intnn_rescale3d(intnn_mat3d* mat3dOut, intnn_mat3d* mat3dIn, 
                     intnn_mat3d* matActvGradInv3d, int k) {
-    const int depth = intnn_mat3d_depth(mat3dIn);
-    for (int d = 0; d < depth; d++) {
-        intnn_mat* outSlice = intnn_mat3d_get_mat_at_depth(mat3dOut, d);
-        intnn_mat* inSlice = intnn_mat3d_get_mat_at_depth(mat3dIn, d);
-        intnn_mat* gradSlice = intnn_mat3d_get_mat_at_depth(matActvGradInv3d, d);
-        intnn_rescale(outSlice, inSlice, gradSlice, k);
-    }
+    intnn_activate3d(mat3dOut, mat3dIn, matActvGradInv3d, INTNN_ACTV_RESCALE, k, 1);
 }
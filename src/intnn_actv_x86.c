@@ -0,0 +1,186 @@
+#include "intnn_actv_kernels.h"
+
+#ifdef INTNN_ACTV_X86
+
+#include <immintrin.h>
+#include <limits.h>
+#include "intnn_consts.h"
+#include "intnn_tools.h"
+
+// 以下函数各自带 target 属性，整个文件无需额外编译选项；只有 CPU 支持时才会被调用。
+// 每个分支都用比较掩码 + min/max/blend 表达，结果与 intnn_actv.c 的标量实现逐位一致
+
+#define INTNN_ACTV_AVX2 __attribute__((target("avx2")))
+
+// 向零取整的 v / 2^s：负数先加 2^s - 1 再算术右移
+static INTNN_ACTV_AVX2 inline __m256i intnn_actv_div_pow2(__m256i v, int s) {
+    const __m256i bias = _mm256_and_si256(_mm256_srai_epi32(v, 31), _mm256_set1_epi32((int)((1u << s) - 1u)));
+    return _mm256_sra_epi32(_mm256_add_epi32(v, bias), _mm_cvtsi32_si128(s));
+}
+
+// 向零取整的 a / b（b 各元素非零）：int32 转 double 相除再截断，商的相对间距远大于 double 精度，结果精确
+static INTNN_ACTV_AVX2 inline __m256i intnn_actv_div(__m256i a, __m256i b) {
+    const __m256d alo = _mm256_cvtepi32_pd(_mm256_castsi256_si128(a));
+    const __m256d ahi = _mm256_cvtepi32_pd(_mm256_extracti128_si256(a, 1));
+    const __m256d blo = _mm256_cvtepi32_pd(_mm256_castsi256_si128(b));
+    const __m256d bhi = _mm256_cvtepi32_pd(_mm256_extracti128_si256(b, 1));
+    const __m128i qlo = _mm256_cvttpd_epi32(_mm256_div_pd(alo, blo));
+    const __m128i qhi = _mm256_cvttpd_epi32(_mm256_div_pd(ahi, bhi));
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(qlo), qhi, 1);
+}
+
+// 向零取整的 v / divisor：2 的幂走移位，否则走 double 除法
+static INTNN_ACTV_AVX2 inline __m256i intnn_actv_div_const(__m256i v, int divisor, int shift) {
+    return shift >= 0 ? intnn_actv_div_pow2(v, shift) : intnn_actv_div(v, _mm256_set1_epi32(divisor));
+}
+
+// 8 个编码（0..255）收窄为字节写出
+static INTNN_ACTV_AVX2 inline void intnn_actv_store_codes(uint8_t* dst, __m256i codes) {
+    const __m128i c16 = _mm_packus_epi32(_mm256_castsi256_si128(codes), _mm256_extracti128_si256(codes, 1));
+    _mm_storel_epi64((__m128i*)dst, _mm_packus_epi16(c16, c16));
+}
+
+INTNN_ACTV_AVX2
+int intnn_actv_row_avx2(int* out, int* gradInv, uint8_t* code, const int* in, int n,
+                        intnn_actv_type actv, int k, int numItems) {
+    const int vecN = n & ~7;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i sat = _mm256_set1_epi32(INTNN_MAX);
+    const __m256i satCode = _mm256_set1_epi32(INTNN_GRAD_CODE_SAT);
+
+    switch (actv) {
+        case INTNN_ACTV_SIGMOID:
+        case INTNN_ACTV_TANH: {
+            const int divisor = actv == INTNN_ACTV_SIGMOID ? 1 << k : (1 << k) * numItems;
+            const int shift = intnn_exact_log2(divisor);
+            const int32_t* lut = actv == INTNN_ACTV_SIGMOID ? intnn_pwl_sigmoid_lut : intnn_pwl_tanh_lut;
+            const __m256i lo = _mm256_set1_epi32(INTNN_PWL_LUT_MIN);
+            const __m256i hi = _mm256_set1_epi32(INTNN_PWL_LUT_MIN + INTNN_PWL_LUT_SIZE - 1);
+            for (int c = 0; c < vecN; c += 8) {
+                const __m256i x = intnn_actv_div_const(_mm256_loadu_si256((const __m256i*)(in + c)), divisor, shift);
+                const __m256i idx = _mm256_sub_epi32(_mm256_min_epi32(_mm256_max_epi32(x, lo), hi), lo);
+                _mm256_storeu_si256((__m256i*)(out + c), _mm256_i32gather_epi32(lut, idx, 4));
+                if (gradInv)
+                    _mm256_storeu_si256((__m256i*)(gradInv + c), _mm256_i32gather_epi32(intnn_pwl_grad_inv_lut, idx, 4));
+                if (code)
+                    intnn_actv_store_codes(code + c, _mm256_i32gather_epi32(intnn_pwl_grad_code_lut, idx, 4));
+            }
+            return vecN;
+        }
+        case INTNN_ACTV_RESCALE:
+        case INTNN_ACTV_AS_IS:
+            for (int c = 0; c < vecN; c += 8) {
+                __m256i v = _mm256_loadu_si256((const __m256i*)(in + c));
+                if (actv == INTNN_ACTV_RESCALE)
+                    v = intnn_actv_div_pow2(v, k);
+                _mm256_storeu_si256((__m256i*)(out + c), v);
+                if (gradInv)
+                    _mm256_storeu_si256((__m256i*)(gradInv + c), one);
+                if (code)
+                    intnn_actv_store_codes(code + c, zero);
+            }
+            return vecN;
+        case INTNN_ACTV_RELU8BIT:
+            for (int c = 0; c < vecN; c += 8) {
+                const __m256i v = _mm256_loadu_si256((const __m256i*)(in + c));
+                const __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(zero, v), _mm256_cmpgt_epi32(v, sat));
+                _mm256_storeu_si256((__m256i*)(out + c), _mm256_min_epi32(_mm256_max_epi32(v, zero), sat));
+                if (gradInv)
+                    _mm256_storeu_si256((__m256i*)(gradInv + c), _mm256_blendv_epi8(one, sat, outside));
+                if (code)
+                    intnn_actv_store_codes(code + c, _mm256_and_si256(outside, satCode));
+            }
+            return vecN;
+        case INTNN_ACTV_LEAKYRELU: {
+            const __m256i shrtMin = _mm256_set1_epi32(SHRT_MIN);
+            const __m256i shrtMax = _mm256_set1_epi32(SHRT_MAX);
+            const __m256i five = _mm256_set1_epi32(5);
+            const __m256i div5Code = _mm256_set1_epi32(INTNN_GRAD_CODE_DIV5);
+            const __m256i magic = _mm256_set1_epi32(52429); // ⌊m × 52429 / 2^18⌋ = ⌊m / 5⌋，m ≤ 32768 时精确
+            for (int c = 0; c < vecN; c += 8) {
+                const __m256i v = _mm256_loadu_si256((const __m256i*)(in + c));
+                const __m256i neg = _mm256_cmpgt_epi32(zero, v);
+                const __m256i low = _mm256_cmpgt_epi32(shrtMin, v);
+                const __m256i saturated = _mm256_or_si256(low, _mm256_cmpgt_epi32(v, _mm256_sub_epi32(shrtMax, one)));
+                // 负半轴 v / 5：对 -max(v, SHRT_MIN) ∈ [0, 32768] 乘法取商后取反
+                const __m256i m = _mm256_sub_epi32(zero, _mm256_max_epi32(_mm256_min_epi32(v, zero), shrtMin));
+                const __m256i negY = _mm256_sub_epi32(zero, _mm256_srli_epi32(_mm256_mullo_epi32(m, magic), 18));
+                __m256i y = _mm256_blendv_epi8(_mm256_min_epi32(v, shrtMax), negY, neg);
+                y = _mm256_blendv_epi8(y, shrtMin, low);
+                _mm256_storeu_si256((__m256i*)(out + c), y);
+                if (gradInv)
+                    _mm256_storeu_si256((__m256i*)(gradInv + c),
+                                        _mm256_blendv_epi8(_mm256_blendv_epi8(one, five, neg), sat, saturated));
+                if (code)
+                    intnn_actv_store_codes(code + c,
+                                           _mm256_blendv_epi8(_mm256_and_si256(neg, div5Code), satCode, saturated));
+            }
+            return vecN;
+        }
+        case INTNN_ACTV_PLU: {
+            if (code)
+                return 0; // plu 没有移位编码，交给标量实现报错
+            const __m256i ten = _mm256_set1_epi32(10);
+            const __m256i yMin = _mm256_set1_epi32(INTNN_MIN);
+            for (int c = 0; c < vecN; c += 8) {
+                const __m256i x = _mm256_loadu_si256((const __m256i*)(in + c));
+                const __m256i pluMin = _mm256_add_epi32(intnn_actv_div(_mm256_sub_epi32(x, one), ten), one);
+                const __m256i pluMax = _mm256_sub_epi32(intnn_actv_div(_mm256_add_epi32(x, one), ten), one);
+                // clamp(x, pluMin, pluMax)：先判断 x < pluMin，再判断 x > pluMax
+                __m256i y = _mm256_blendv_epi8(x, pluMax, _mm256_cmpgt_epi32(x, pluMax));
+                y = _mm256_blendv_epi8(y, pluMin, _mm256_cmpgt_epi32(pluMin, x));
+                _mm256_storeu_si256((__m256i*)(out + c), _mm256_min_epi32(_mm256_max_epi32(y, yMin), sat));
+                if (gradInv) {
+                    const __m256i isZero = _mm256_cmpeq_epi32(x, zero);
+                    const __m256i q = _mm256_abs_epi32(intnn_actv_div(y, _mm256_blendv_epi8(x, one, isZero)));
+                    _mm256_storeu_si256((__m256i*)(gradInv + c), _mm256_blendv_epi8(q, one, isZero));
+                }
+            }
+            return vecN;
+        }
+        default:
+            return 0; // softmax 需要整行，走 intnn_actv_softmax_row_avx2
+    }
+}
+
+INTNN_ACTV_AVX2
+void intnn_actv_softmax_row_avx2(int* out, int* gradInv, const int* in, int n) {
+    const int vecN = n & ~7;
+    const __m256i zero = _mm256_setzero_si256();
+
+    // 第一遍：负数置零并求和（int 回绕加法满足结合律，与标量逐个累加结果相同）
+    __m256i acc = zero;
+    for (int c = 0; c < vecN; c += 8) {
+        const __m256i p = _mm256_max_epi32(_mm256_loadu_si256((const __m256i*)(in + c)), zero);
+        _mm256_storeu_si256((__m256i*)(out + c), p);
+        acc = _mm256_add_epi32(acc, p);
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    unsigned int rowSum = (unsigned int)_mm_cvtsi128_si32(s);
+    for (int c = vecN; c < n; ++c) {
+        out[c] = in[c] > 0 ? in[c] : 0;
+        rowSum += (unsigned int)out[c];
+    }
+
+    const int sum = rowSum == 0 ? 1 : (int)rowSum;
+    const int scaleFactor = INTNN_MAX / sum;
+
+    // 第二遍：正数按比例放大，梯度倒数正数为 1、其余为 INTNN_MAX
+    const __m256i scale = _mm256_set1_epi32(scaleFactor);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i sat = _mm256_set1_epi32(INTNN_MAX);
+    for (int c = 0; c < vecN; c += 8) {
+        const __m256i p = _mm256_loadu_si256((const __m256i*)(out + c));
+        _mm256_storeu_si256((__m256i*)(out + c), _mm256_mullo_epi32(p, scale));
+        _mm256_storeu_si256((__m256i*)(gradInv + c), _mm256_blendv_epi8(sat, one, _mm256_cmpgt_epi32(p, zero)));
+    }
+    for (int c = vecN; c < n; ++c) {
+        gradInv[c] = out[c] == 0 ? INTNN_MAX : 1;
+        out[c] = (int)((unsigned int)out[c] * (unsigned int)scaleFactor);
+    }
+}
+
+#endif // INTNN_ACTV_X86
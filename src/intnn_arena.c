@@ -0,0 +1,117 @@
+#include "intnn_arena.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "intnn_consts.h"
+#include "intnn_tools.h"
+
+// 当前线程激活的内存池：线程池的工作线程没有绑定，GEMM 等在其中使用堆
+#if defined(__GNUC__)
+static __thread intnn_arena* gActiveArena = NULL;
+#else
+static intnn_arena* gActiveArena = NULL;
+#endif
+
+static size_t intnn_arena_align_up(size_t bytes) {
+    return (bytes + INTNN_MAT_ALIGN - 1) / INTNN_MAT_ALIGN * INTNN_MAT_ALIGN;
+}
+
+intnn_arena* intnn_create_arena(size_t capacity) {
+    intnn_arena* arena = (intnn_arena*)malloc(sizeof(intnn_arena));
+    if (!arena)
+        return NULL;
+    capacity = intnn_arena_align_up(capacity);
+    arena->mBase = (char*)intnn_aligned_alloc(capacity);
+    if (!arena->mBase) {
+        free(arena);
+        return NULL;
+    }
+    arena->mCapacity = capacity;
+    arena->mUsed = 0;
+    arena->mHighWater = 0;
+    arena->mOwnsBase = true;
+    return arena;
+}
+
+void intnn_arena_init(intnn_arena* arena, void* buffer, size_t bytes) {
+    if (!arena || (!buffer && bytes > 0))
+        assert(0);
+    // 首地址向后对齐，容量扣除对齐损失
+    uintptr_t addr = (uintptr_t)buffer;
+    size_t skip = (size_t)((INTNN_MAT_ALIGN - addr % INTNN_MAT_ALIGN) % INTNN_MAT_ALIGN);
+    arena->mBase = (char*)buffer + (skip < bytes ? skip : bytes);
+    arena->mCapacity = skip < bytes ? bytes - skip : 0;
+    arena->mUsed = 0;
+    arena->mHighWater = 0;
+    arena->mOwnsBase = false;
+}
+
+void intnn_free_arena(intnn_arena* arena) {
+    if (!arena)
+        return;
+    if (gActiveArena == arena)
+        gActiveArena = NULL; // 只能解除当前线程的绑定，其他线程须自行解除
+    if (arena->mOwnsBase)
+        intnn_aligned_free(arena->mBase);
+    free(arena);
+}
+
+void* intnn_arena_alloc(intnn_arena* arena, size_t bytes) {
+    if (!arena)
+        assert(0);
+    size_t need = intnn_arena_align_up(bytes == 0 ? 1 : bytes);
+    if (need > arena->mCapacity - arena->mUsed) {
+        printf("[ERROR] arena_alloc: need %zu bytes, %zu of %zu available\n",
+               need, arena->mCapacity - arena->mUsed, arena->mCapacity);
+        assert(0);
+        return NULL;
+    }
+    void* ptr = arena->mBase + arena->mUsed;
+    arena->mUsed += need;
+    if (arena->mUsed > arena->mHighWater)
+        arena->mHighWater = arena->mUsed;
+    return ptr;
+}
+
+void intnn_arena_reset(intnn_arena* arena) {
+    if (!arena)
+        assert(0);
+    arena->mUsed = 0;
+}
+
+size_t intnn_arena_mark(const intnn_arena* arena) {
+    if (!arena)
+        assert(0);
+    return arena->mUsed;
+}
+
+void intnn_arena_rewind(intnn_arena* arena, size_t mark) {
+    if (!arena || mark > arena->mUsed)
+        assert(0);
+    arena->mUsed = mark;
+}
+
+size_t intnn_arena_used(const intnn_arena* arena) {
+    return arena ? arena->mUsed : 0;
+}
+
+size_t intnn_arena_high_water(const intnn_arena* arena) {
+    return arena ? arena->mHighWater : 0;
+}
+
+void intnn_arena_clear_high_water(intnn_arena* arena) {
+    if (!arena)
+        assert(0);
+    arena->mHighWater = arena->mUsed;
+}
+
+intnn_arena* intnn_arena_bind(intnn_arena* arena) {
+    intnn_arena* prev = gActiveArena;
+    gActiveArena = arena;
+    return prev;
+}
+
+intnn_arena* intnn_arena_active(void) {
+    return gActiveArena;
+}
@@ -2,13 +2,76 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <assert.h>
 #include "intnn_examples.h"
 #include "intnn_fc_layer.h"
+#include "intnn_fc_hogwild.h"
+#include "intnn_fc_pipeline.h"
+#include "intnn_net.h"
 #include "intnn_mat.h"
+#include "intnn_arena.h"
+#include "intnn_tmat.h"
+#include "intnn_gemm.h"
+#include "intnn_thread_pool.h"
 #include "intnn_consts.h"
 #include "intnn_actv.h"
+#include "intnn_loss.h"
 #include "intnn_tools.h"
 
+// 评估的取数回调：图像按块拓宽为 int；目标以类别下标给出，不写 y
+static void example_intnn_eval_fill(void* ctx, int start, int end, intnn_mat* x, intnn_mat* y) {
+    (void)y;
+    intnn_tmat_rows_to_mat(x, (const intnn_tmat*)ctx, start, end);
+}
+
+// 分块流式评估整个数据集，返回预测正确的样本数；峰值内存只与分块大小有关
+static int example_intnn_count_correct(intnn_net* net, const intnn_tmat* images, const int* labels, int chunk) {
+    return intnn_net_evaluate_labels(net, images->mRows, chunk, example_intnn_eval_fill, (void*)images,
+                                     labels, INTNN_UNSIGNED_4BIT_MAX).mCorrect;
+}
+
+// 把 (n, 1) 的标签矩阵展开为类别下标数组
+static int* example_intnn_label_indices(const intnn_mat* labels) {
+    int* out = (int*)malloc(sizeof(int) * labels->mRows);
+    if (!out)
+        assert(0);
+    for (int i = 0; i < labels->mRows; ++i)
+        out[i] = INTNN_MAT_ROW(labels, i)[0];
+    return out;
+}
+
+// 流水线训练的回调上下文：按打乱后的下标取小批，并累计损失与正确数
+typedef struct {
+    const intnn_tmat* mImages;
+    const int* mLabels;
+    int* mIndices;
+    int mBatchSize;
+    int mTotalLoss;
+    int mTotalCorrect;
+} example_intnn_train_ctx;
+
+static void example_intnn_train_input(void* ctx, int batch, intnn_mat* x) {
+    const example_intnn_train_ctx* t = (const example_intnn_train_ctx*)ctx;
+    intnn_tmat_indexed_slice_to_mat(x, t->mImages, t->mIndices, batch * t->mBatchSize, (batch + 1) * t->mBatchSize);
+}
+
+static void example_intnn_train_loss(void* ctx, int batch, const intnn_mat* output, intnn_mat* delta) {
+    example_intnn_train_ctx* t = (example_intnn_train_ctx*)ctx;
+    intnn_loss_result r = intnn_batch_loss_fused_labels(delta, output, t->mLabels, t->mIndices + batch * t->mBatchSize,
+                                                        INTNN_UNSIGNED_4BIT_MAX, INTNN_LOSS_L2);
+    t->mTotalLoss += r.mLoss;
+    t->mTotalCorrect += r.mCorrect;
+}
+
+// Hogwild 训练的回调：每个工作线程使用 ctx 数组中自己的那一项（独立的统计）
+static void example_intnn_hogwild_input(void* ctx, int worker, int batch, intnn_mat* x) {
+    example_intnn_train_input((example_intnn_train_ctx*)ctx + worker, batch, x);
+}
+
+static void example_intnn_hogwild_loss(void* ctx, int worker, int batch, const intnn_mat* output, intnn_mat* delta) {
+    example_intnn_train_loss((example_intnn_train_ctx*)ctx + worker, batch, output, delta);
+}
+
 int example_intnn_fc_dfa_mnist() {
     const int numTrain = 60000;
     const int numTest = 10000;
@@ -18,28 +81,29 @@ int example_intnn_fc_dfa_mnist() {
     const int dim2 = 50;
     const int epochs = 10;
     const int miniBatchSize = 20;
+    const int evalChunk = 1000;
     int lrInv = 1000;
 
     srand(114514);
 
-    // 加载数据
-    intnn_mat* trainImages = intnn_create_mat(numTrain, dimInput);
+    // 加载数据（图像按 UINT8 存储，取 mini-batch 时再拓宽）
+    intnn_tmat* trainImages = intnn_create_tmat(numTrain, dimInput, INTNN_DTYPE_UINT8);
     intnn_mat* trainLabels = intnn_create_mat(numTrain, 1);
-    intnn_mat* testImages = intnn_create_mat(numTest, dimInput);
+    intnn_tmat* testImages = intnn_create_tmat(numTest, dimInput, INTNN_DTYPE_UINT8);
     intnn_mat* testLabels = intnn_create_mat(numTest, 1);
-    intnn_load_mnist_images(trainImages, numTrain, true);
+    intnn_load_mnist_images_tmat(trainImages, numTrain, true);
     intnn_load_mnist_labels(trainLabels, numTrain, true);
-    intnn_load_mnist_images(testImages, numTest, false);
+    intnn_load_mnist_images_tmat(testImages, numTest, false);
     intnn_load_mnist_labels(testLabels, numTest, false);
     printf("Loaded MNIST train/test samples.\n");
+    printf("GEMM kernel: %s\n", intnn_gemm_kernel_name());
+    printf("Threads: %d\n", intnn_thread_pool_size());
 
-    // 构造 One-hot 目标
-    intnn_mat* trainTarget = intnn_create_mat(numTrain, numClasses);
-    intnn_mat* testTarget = intnn_create_mat(numTest, numClasses);
-    for (int i = 0; i < numTrain; ++i)
-        trainTarget->mMat[i][trainLabels->mMat[i][0]] = INTNN_UNSIGNED_4BIT_MAX;
-    for (int i = 0; i < numTest; ++i)
-        testTarget->mMat[i][testLabels->mMat[i][0]] = INTNN_UNSIGNED_4BIT_MAX;
+    // 目标直接使用类别下标（等价于目标类为 INTNN_UNSIGNED_4BIT_MAX 的 one-hot），不构造 one-hot 矩阵
+    int* trainLabelIdx = example_intnn_label_indices(trainLabels);
+    int* testLabelIdx = example_intnn_label_indices(testLabels);
+    intnn_free_mat(trainLabels);
+    intnn_free_mat(testLabels);
 
     // 创建训练用层
     intnn_fc_layer* fc1 = intnn_fc_create(dimInput, dim1);
@@ -52,30 +116,33 @@ int example_intnn_fc_dfa_mnist() {
     intnn_fc_use_dfa(fc2, true);
     intnn_fc_use_dfa(fc3, true);
 
-	fc1->mWeight = intnn_create_mat(dimInput, dim1);
-	fc2->mWeight = intnn_create_mat(dim1, dim2);
-	fc3->mWeight = intnn_create_mat(dim2, numClasses);
+	fc1->mWeight = intnn_create_tmat(dimInput, dim1, INTNN_DTYPE_INT16);
+	fc2->mWeight = intnn_create_tmat(dim1, dim2, INTNN_DTYPE_INT16);
+	fc3->mWeight = intnn_create_tmat(dim2, numClasses, INTNN_DTYPE_INT16);
 	fc1->mBias = intnn_create_mat(1, dim1);
 	fc2->mBias = intnn_create_mat(1, dim2);
 	fc3->mBias = intnn_create_mat(1, numClasses);
 
-    fc1->mNext = fc2;
-    fc2->mPrev = fc1;
-    fc2->mNext = fc3;
-    fc3->mPrev = fc2;
-    fc3->mNext = NULL; // 最后一层没有下一层
-    fc1->mPrev = NULL; // 第一层没有前一层
+    // 网络持有各层并维护层间链接
+    intnn_net* net = intnn_net_create();
+    intnn_net_add(net, fc1);
+    intnn_net_add(net, fc2);
+    intnn_net_add(net, fc3);
+
+    // 执行计划与静态内存规划：所有中间矩阵按最大批（评估分块）放进同一块 slab，存活区间不重叠的共享内存
+    printf("Inference activation memory: %zu bytes\n", intnn_net_memory_required(net, evalChunk, INTNN_NET_MEM_INFERENCE));
+    intnn_net_plan_memory(net, evalChunk, INTNN_NET_MEM_TRAINING, NULL, 0);
+    printf("Training activation memory: %zu bytes (%zu without reuse)\n",
+           net->mPlan.mPeakBytes, net->mPlan.mUnaliasedBytes);
 
     int correct;
 
     //// 初始化前向精度（训练用）
-    intnn_fc_forward(fc1, trainImages);
-    correct = intnn_count_max_match(intnn_fc_get_output(fc3), trainTarget);
+    correct = example_intnn_count_correct(net, trainImages, trainLabelIdx, evalChunk);
     printf("Initial training correct: %d / %d\n", correct, numTrain);
     printf("Initial training accuracy: %.2f%%\n", correct * 100.0 / numTrain);
 
-    intnn_fc_forward(fc1, testImages);
-    correct = intnn_count_max_match(intnn_fc_get_output(fc3), testTarget);
+    correct = example_intnn_count_correct(net, testImages, testLabelIdx, evalChunk);
     printf("Initial test correct: %d / %d\n", correct, numTest);
     printf("Initial test accuracy: %.2f%%\n", correct * 100.0 / numTest);
 
@@ -84,39 +151,90 @@ int example_intnn_fc_dfa_mnist() {
     for (int i = 0; i < numTrain; ++i) indices[i] = i;
 
     intnn_mat* miniX = intnn_create_mat(miniBatchSize, dimInput);
-    intnn_mat* miniY = intnn_create_mat(miniBatchSize, numClasses);
-    intnn_mat* lossMat = intnn_create_mat(miniBatchSize, numClasses);
     intnn_mat* deltaMat = intnn_create_mat(miniBatchSize, numClasses);
+    // 每个训练步的临时内存（GEMM 打包缓冲等）从固定容量的内存池取，步末 O(1) 重置
+    intnn_arena* stepArena = intnn_create_arena(1 << 20);
+    // 设置 INTNN_PIPELINE_STALENESS（>= 0）时改用分层流水线训练
+    const char* stalenessEnv = getenv("INTNN_PIPELINE_STALENESS");
+    int pipelineStaleness = stalenessEnv ? atoi(stalenessEnv) : -1;
+    intnn_fc_pipeline* pipeline = NULL;
+    example_intnn_train_ctx train = { trainImages, trainLabelIdx, indices, miniBatchSize, 0, 0 };
+    // 设置 INTNN_HOGWILD_WORKERS（> 0）时改用 Hogwild 数据并行训练（流水线优先）
+    const char* hogwildEnv = getenv("INTNN_HOGWILD_WORKERS");
+    int hogwildWorkers = hogwildEnv ? atoi(hogwildEnv) : 0;
+    intnn_fc_hogwild* hogwild = NULL;
+    example_intnn_train_ctx* hogwildTrain = NULL;
     printf("Epoch,\tTrainLoss,\tTrainAcc,\tTestAcc\n");
 
-    clock_t start = clock();
+    double start = intnn_wall_seconds();
 
     for (int ep = 1; ep <= epochs; ++ep) {
         intnn_tools_shuffle_indices(indices, numTrain);
         int totalCorrect = 0;
         int totalLoss = 0;
 
-        for (int i = 0; i < numTrain / miniBatchSize; ++i) {
-            intnn_indexed_slice_of(miniX, trainImages, indices, i * miniBatchSize, (i + 1) * miniBatchSize);
+        // 在首次打乱之后创建，DFA 反馈矩阵的随机数顺序与逐批训练一致；层链不满足流水线条件时退回逐批训练
+        if (pipelineStaleness >= 0 && !pipeline) {
+            pipeline = intnn_fc_pipeline_create(fc1, miniBatchSize, pipelineStaleness);
+            if (!pipeline) {
+                printf("Pipeline training unavailable for this layer stack, training serially\n");
+                pipelineStaleness = -1;
+            }
+        }
+        if (pipelineStaleness < 0 && hogwildWorkers > 0 && !hogwild) {
+            hogwild = intnn_fc_hogwild_create(fc1, hogwildWorkers, miniBatchSize);
+            if (!hogwild) {
+                printf("Hogwild training unavailable for this layer stack, training serially\n");
+                hogwildWorkers = 0;
+            } else {
+                const int workers = intnn_fc_hogwild_num_workers(hogwild);
+                hogwildTrain = (example_intnn_train_ctx*)malloc(sizeof(example_intnn_train_ctx) * workers);
+                for (int w = 0; w < workers; ++w)
+                    hogwildTrain[w] = train;
+            }
+        }
+
+        if (pipeline) {
+            train.mTotalLoss = 0;
+            train.mTotalCorrect = 0;
+            intnn_fc_pipeline_run(pipeline, numTrain / miniBatchSize, lrInv,
+                                  example_intnn_train_input, example_intnn_train_loss, &train);
+            totalLoss = train.mTotalLoss;
+            totalCorrect = train.mTotalCorrect;
+        } else if (hogwild) {
+            const int workers = intnn_fc_hogwild_num_workers(hogwild);
+            for (int w = 0; w < workers; ++w)
+                hogwildTrain[w].mTotalLoss = hogwildTrain[w].mTotalCorrect = 0;
+            intnn_fc_hogwild_run(hogwild, numTrain / miniBatchSize, lrInv,
+                                 example_intnn_hogwild_input, example_intnn_hogwild_loss, hogwildTrain);
+            for (int w = 0; w < workers; ++w) {
+                totalLoss += hogwildTrain[w].mTotalLoss;
+                totalCorrect += hogwildTrain[w].mTotalCorrect;
+            }
+        }
+
+        for (int i = 0; pipeline == NULL && hogwild == NULL && i < numTrain / miniBatchSize; ++i) {
+            intnn_arena_bind(stepArena);
+            intnn_tmat_indexed_slice_to_mat(miniX, trainImages, indices, i * miniBatchSize, (i + 1) * miniBatchSize);
 
            /* printf("\n======================================\n");
             printf("FORWARD START:\n");
             printf("\n======================================\n");*/
-            intnn_fc_forward(fc1, miniX);
-            int aa = 0;
-            intnn_indexed_slice_of(miniY, trainTarget, indices, i * miniBatchSize, (i + 1) * miniBatchSize);
-            totalLoss += intnn_batch_l2_loss(lossMat, miniY, intnn_fc_get_output(fc3));
-            intnn_batch_l2_loss_delta(deltaMat, miniY, intnn_fc_get_output(fc3));
-            totalCorrect += intnn_count_max_match(intnn_fc_get_output(fc3), miniY);
+            intnn_mat* output = intnn_net_forward(net, miniX);
+            intnn_loss_result stepLoss = intnn_batch_loss_fused_labels(deltaMat, output, trainLabelIdx, indices + i * miniBatchSize,
+                                                                       INTNN_UNSIGNED_4BIT_MAX, INTNN_LOSS_L2);
+            totalLoss += stepLoss.mLoss;
+            totalCorrect += stepLoss.mCorrect;
 
             /*printf("\n======================================\n");
             printf("BACKWARD START:\n");
             printf("\n======================================\n");*/
-            intnn_fc_backward(fc3, deltaMat, lrInv);
+            intnn_net_backward(net, deltaMat, lrInv);
+            intnn_arena_reset(stepArena);
+            intnn_arena_bind(NULL);
         }
 
-        intnn_fc_forward(fc1, testImages);
-        int testCorrect = intnn_count_max_match(intnn_fc_get_output(fc3), testTarget);
+        int testCorrect = example_intnn_count_correct(net, testImages, testLabelIdx, evalChunk);
 
         printf("%d,\t%-8d,\t%.2f%%,\t\t%.2f%%\n", ep, totalLoss,
             totalCorrect * 100.0 / numTrain,
@@ -130,19 +248,75 @@ int example_intnn_fc_dfa_mnist() {
         if ((ep % 10 == 0) && lrInv < 20000) lrInv *= 2;
     }
 
-    clock_t end = clock();
-    double elapsed_secs = (double)(end - start) / CLOCKS_PER_SEC;
+    double elapsed_secs = intnn_wall_seconds() - start;
     printf("Training time: %.2f seconds\n", elapsed_secs);
+    if (pipeline)
+        printf("Pipeline staleness: %d\n", intnn_fc_pipeline_staleness(pipeline));
+    if (hogwild)
+        printf("Hogwild workers: %d\n", intnn_fc_hogwild_num_workers(hogwild));
+    printf("Step arena high water: %zu / %zu bytes\n",
+           intnn_arena_high_water(stepArena), stepArena->mCapacity);
 
     // 释放所有资源
-    intnn_fc_free(fc1);
-    intnn_fc_free(fc2);
-    intnn_fc_free(fc3);
-    intnn_free_mat(trainImages); intnn_free_mat(trainLabels);
-    intnn_free_mat(testImages);  intnn_free_mat(testLabels);
-    intnn_free_mat(trainTarget); intnn_free_mat(testTarget);
-    intnn_free_mat(miniX);       intnn_free_mat(miniY);
-    intnn_free_mat(lossMat);     intnn_free_mat(deltaMat);
+    intnn_net_free(net);
+    intnn_free_tmat(trainImages); free(trainLabelIdx);
+    intnn_free_tmat(testImages);  free(testLabelIdx);
+    intnn_free_mat(miniX);        intnn_free_mat(deltaMat);
+    intnn_free_arena(stepArena);
+    intnn_fc_pipeline_free(pipeline);
+    free(hogwildTrain);
+    intnn_fc_hogwild_free(hogwild);
     free(indices);
     return 0;
 }
+
+// 激活微基准：每种模式分别用标量与 SIMD 实现激活同一批数据，输出每纳秒处理的元素数；
+// 可移位编码的模式另测训练前向实际使用的 intnn_activate_row_code
+int example_intnn_bench_actv() {
+    const int rows = 256, cols = 1024, reps = 40;
+    const intnn_actv_type types[] = {
+        INTNN_ACTV_SIGMOID, INTNN_ACTV_TANH, INTNN_ACTV_RESCALE, INTNN_ACTV_SOFTMAX,
+        INTNN_ACTV_RELU8BIT, INTNN_ACTV_LEAKYRELU, INTNN_ACTV_PLU, INTNN_ACTV_AS_IS
+    };
+    const char* names[] = { "sigmoid", "tanh", "rescale", "softmax", "relu8bit", "leakyrelu", "plu", "as_is" };
+    const char* kernels[] = { "scalar", "avx2" };
+    const char* original = intnn_actv_kernel_name();
+
+    intnn_mat* in = intnn_create_mat(rows, cols);
+    intnn_mat* out = intnn_create_mat(rows, cols);
+    intnn_mat* grad = intnn_create_mat(rows, cols);
+    intnn_tmat* code = intnn_create_tmat(rows, cols, INTNN_DTYPE_UINT8);
+    srand(1);
+    intnn_set_random(in, true, -100000, 100000);
+
+    printf("%-10s %-7s %12s %12s\n", "mode", "kernel", "grad el/ns", "code el/ns");
+    for (int t = 0; t < (int)(sizeof(types) / sizeof(types[0])); ++t) {
+        for (int v = 0; v < (int)(sizeof(kernels) / sizeof(kernels[0])); ++v) {
+            if (!intnn_actv_set_kernel(kernels[v]))
+                continue;
+            intnn_activate(out, in, grad, types[t], INTNN_K_BIT, 300); // 预热
+            double begin = intnn_wall_seconds();
+            for (int i = 0; i < reps; ++i)
+                intnn_activate(out, in, grad, types[t], INTNN_K_BIT, 300);
+            const double gradRate = (double)rows * cols * reps / ((intnn_wall_seconds() - begin) * 1e9);
+
+            if (!intnn_actv_has_grad_code(types[t])) {
+                printf("%-10s %-7s %12.3f %12s\n", names[t], kernels[v], gradRate, "-");
+                continue;
+            }
+            begin = intnn_wall_seconds();
+            for (int i = 0; i < reps; ++i)
+                for (int r = 0; r < rows; ++r)
+                    intnn_activate_row_code(INTNN_MAT_ROW(out, r), (uint8_t*)code->mData + (size_t)r * code->mStride,
+                                            INTNN_MAT_ROW(in, r), cols, types[t], INTNN_K_BIT, 300);
+            const double codeRate = (double)rows * cols * reps / ((intnn_wall_seconds() - begin) * 1e9);
+            printf("%-10s %-7s %12.3f %12.3f\n", names[t], kernels[v], gradRate, codeRate);
+        }
+    }
+    intnn_actv_set_kernel(original);
+
+    intnn_free_mat(in); intnn_free_mat(out); intnn_free_mat(grad);
+    free(in); free(out); free(grad);
+    intnn_free_tmat(code);
+    return 0;
+}
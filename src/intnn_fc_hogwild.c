@@ -0,0 +1,196 @@
+#include "intnn_fc_hogwild.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "intnn_thread_pool.h"
+
+// Windows（MinGW）构建不链接 pthread，退化为单个工作线程
+#if !defined(_WIN32)
+#define INTNN_HAVE_PTHREADS 1
+#include <pthread.h>
+#endif
+
+struct intnn_fc_hogwild {
+    intnn_fc_layer** mLayers;   // 各工作线程的层链副本 [worker * mNumLayers + k]
+    int mNumLayers;
+    int mNumWorkers;
+    intnn_mat** mInputs;        // 各工作线程的输入 [worker]
+    intnn_mat** mDeltas;        // 各工作线程的最后一层误差 [worker]
+
+    // 当前一次 run 的参数
+    int mNumBatches;
+    int mLrInv;
+    intnn_hogwild_input_fn mInputFn;
+    intnn_hogwild_loss_fn mLossFn;
+    void* mCtx;
+    int mNextBatch;             // 下一个待领取的批号，原子递增
+};
+
+intnn_fc_hogwild* intnn_fc_hogwild_create(intnn_fc_layer* first, int numWorkers, int maxBatch) {
+    if (!first || maxBatch <= 0)
+        assert(0);
+
+    int numLayers = 0;
+    intnn_fc_layer* last = first;
+    for (intnn_fc_layer* l = first; l != NULL; l = l->mNext) {
+        if (l->mUseBn || (l->mNext != NULL && !l->mUseDfa)) {
+            printf("[WARN] fc_hogwild: every layer but the last must use DFA without batch normalization\n");
+            return NULL;
+        }
+        last = l;
+        ++numLayers;
+    }
+
+    intnn_fc_hogwild* h = (intnn_fc_hogwild*)calloc(1, sizeof(intnn_fc_hogwild));
+    if (!h)
+        return NULL;
+#ifdef INTNN_HAVE_PTHREADS
+    h->mNumWorkers = numWorkers > 0 ? numWorkers : intnn_thread_pool_size();
+#else
+    (void)numWorkers;
+    h->mNumWorkers = 1;
+#endif
+    h->mNumLayers = numLayers;
+
+    // 与 intnn_fc_backward 相同，从后往前初始化 DFA 反馈矩阵，之后各副本共享
+    for (intnn_fc_layer* l = last->mPrev; l != NULL; l = l->mPrev)
+        intnn_fc_ensure_dfa_weight(l, last->mOutDim);
+
+    const int workers = h->mNumWorkers;
+    h->mLayers = (intnn_fc_layer**)malloc(sizeof(intnn_fc_layer*) * workers * numLayers);
+    h->mInputs = (intnn_mat**)malloc(sizeof(intnn_mat*) * workers);
+    h->mDeltas = (intnn_mat**)malloc(sizeof(intnn_mat*) * workers);
+    if (!h->mLayers || !h->mInputs || !h->mDeltas)
+        assert(0);
+
+    for (int w = 0; w < workers; ++w) {
+        intnn_fc_layer** chain = h->mLayers + w * numLayers;
+        int k = 0;
+        for (intnn_fc_layer* l = first; l != NULL; l = l->mNext, ++k) {
+            intnn_fc_layer* r = intnn_fc_create(l->mInDim, l->mOutDim);
+            if (!r)
+                assert(0);
+            // 副本不持有权重：释放自带的权重/偏置，改为指向原层
+            intnn_free_tmat(r->mWeight);
+            intnn_free_mat(r->mBias);
+            free(r->mBias);
+            r->mWeight = l->mWeight;
+            r->mBias = l->mBias;
+            r->mDfaWeight = l->mDfaWeight;
+            r->mUseDfa = l->mUseDfa;
+            r->mActv = l->mActv;
+            r->mAtomicUpdate = true;
+            if (k > 0) {
+                r->mPrev = chain[k - 1];
+                chain[k - 1]->mNext = r;
+            }
+            intnn_fc_reserve(r, maxBatch);
+            chain[k] = r;
+        }
+        h->mInputs[w] = intnn_create_mat(maxBatch, first->mInDim);
+        h->mDeltas[w] = intnn_create_mat(maxBatch, last->mOutDim);
+    }
+    return h;
+}
+
+static void intnn_fc_hogwild_destroy_mat(intnn_mat* mat) {
+    intnn_free_mat(mat);
+    free(mat);
+}
+
+void intnn_fc_hogwild_free(intnn_fc_hogwild* h) {
+    if (!h)
+        return;
+    for (int i = 0; i < h->mNumWorkers * h->mNumLayers; ++i) {
+        intnn_fc_layer* r = h->mLayers[i];
+        // 共享矩阵属于原层链，不随副本释放
+        r->mWeight = NULL;
+        r->mBias = NULL;
+        r->mDfaWeight = NULL;
+        intnn_fc_free(r);
+        free(r);
+    }
+    for (int w = 0; w < h->mNumWorkers; ++w) {
+        intnn_fc_hogwild_destroy_mat(h->mInputs[w]);
+        intnn_fc_hogwild_destroy_mat(h->mDeltas[w]);
+    }
+    free(h->mLayers);
+    free(h->mInputs);
+    free(h->mDeltas);
+    free(h);
+}
+
+int intnn_fc_hogwild_num_workers(const intnn_fc_hogwild* h) {
+    return h ? h->mNumWorkers : 0;
+}
+
+// 工作线程 w 不断领取批号直到取完：取输入、前向、算误差、反向并原子地应用更新
+static void intnn_fc_hogwild_work(intnn_fc_hogwild* h, int w) {
+    intnn_fc_layer* head = h->mLayers[w * h->mNumLayers];
+    intnn_fc_layer* tail = h->mLayers[w * h->mNumLayers + h->mNumLayers - 1];
+    intnn_mat* x = h->mInputs[w];
+    intnn_mat* delta = h->mDeltas[w];
+    for (;;) {
+        const int batch = __atomic_fetch_add(&h->mNextBatch, 1, __ATOMIC_RELAXED);
+        if (batch >= h->mNumBatches)
+            break;
+        h->mInputFn(h->mCtx, w, batch, x);
+        intnn_fc_forward(head, x);
+        h->mLossFn(h->mCtx, w, batch, intnn_fc_get_output(tail), delta);
+        intnn_fc_backward(tail, delta, h->mLrInv);
+    }
+}
+
+#ifdef INTNN_HAVE_PTHREADS
+
+typedef struct {
+    intnn_fc_hogwild* mHogwild;
+    int mWorker;
+} intnn_fc_hogwild_arg;
+
+static void* intnn_fc_hogwild_thread(void* arg) {
+    const intnn_fc_hogwild_arg* ha = (const intnn_fc_hogwild_arg*)arg;
+    intnn_fc_hogwild_work(ha->mHogwild, ha->mWorker);
+    return NULL;
+}
+
+#endif // INTNN_HAVE_PTHREADS
+
+void intnn_fc_hogwild_run(intnn_fc_hogwild* h, int numBatches, int lrInv,
+                          intnn_hogwild_input_fn input, intnn_hogwild_loss_fn loss, void* ctx) {
+    if (!h || !input || !loss)
+        assert(0);
+    if (numBatches <= 0)
+        return;
+
+    h->mNumBatches = numBatches;
+    h->mLrInv = lrInv;
+    h->mInputFn = input;
+    h->mLossFn = loss;
+    h->mCtx = ctx;
+    h->mNextBatch = 0;
+
+#ifdef INTNN_HAVE_PTHREADS
+    if (h->mNumWorkers > 1) {
+        // 工作线程 0 由调用线程担任；各线程内的 GEMM 等在线程池忙时自动串行
+        const int extra = h->mNumWorkers - 1;
+        pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * extra);
+        intnn_fc_hogwild_arg* args = (intnn_fc_hogwild_arg*)malloc(sizeof(intnn_fc_hogwild_arg) * extra);
+        if (!threads || !args)
+            assert(0);
+        for (int i = 0; i < extra; ++i) {
+            args[i].mHogwild = h;
+            args[i].mWorker = i + 1;
+            if (pthread_create(&threads[i], NULL, intnn_fc_hogwild_thread, &args[i]) != 0)
+                assert(0);
+        }
+        intnn_fc_hogwild_work(h, 0);
+        for (int i = 0; i < extra; ++i)
+            pthread_join(threads[i], NULL);
+        free(threads);
+        free(args);
+        return;
+    }
+#endif
+    intnn_fc_hogwild_work(h, 0);
+}
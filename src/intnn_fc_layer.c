@@ -5,10 +5,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include "intnn_actv.h"
+#include "intnn_arena.h"
 #include "intnn_consts.h"
+#include "intnn_gemm.h"
 #include "intnn_loss.h"
 #include "intnn_mat.h"
 #include "intnn_mat3d.h"
+#include "intnn_thread_pool.h"
 #include "intnn_tools.h"
 /**
  * @brief 创建一个全连接层（堆分配）
@@ -22,9 +25,12 @@ intnn_fc_layer* intnn_fc_create(int inDim, int outDim) {
     layer->mInDim = inDim;
     layer->mOutDim = outDim;
     layer->mInput = NULL;
+    layer->mCopyInput = false;
+    layer->mAtomicUpdate = false;
+    layer->mInputCopy = NULL;
 
     // 创建权重和偏置（由 intnn_create_mat 返回指针）
-    layer->mWeight = intnn_create_mat(inDim, outDim);
+    layer->mWeight = intnn_create_tmat(inDim, outDim, INTNN_DTYPE_INT16);
     layer->mBias = intnn_create_mat(1, outDim);
 
     layer->mInter = NULL;
@@ -34,6 +40,7 @@ intnn_fc_layer* intnn_fc_create(int inDim, int outDim) {
     layer->mDeltasTranspose = NULL;
     layer->mDActvTranspose = NULL;
     layer->mActvGradInv = NULL;
+    layer->mActvGradCode = NULL;
     layer->mWeightUpdate = intnn_create_mat(inDim, outDim);
     layer->mBiasUpdate = intnn_create_mat(1, outDim);
 
@@ -75,8 +82,12 @@ void intnn_fc_free(intnn_fc_layer* layer) {
     if (!layer)
         return;
 
-    if (layer->mWeight)
-        intnn_free_mat(layer->mWeight);
+    if (layer->mInputCopy)
+        intnn_free_mat(layer->mInputCopy);
+    if (layer->mWeight) {
+        intnn_free_tmat(layer->mWeight);
+        layer->mWeight = NULL;
+    }
     if (layer->mBias)
         intnn_free_mat(layer->mBias);
     if (layer->mInter)
@@ -91,6 +102,10 @@ void intnn_fc_free(intnn_fc_layer* layer) {
         intnn_free_mat(layer->mDActvTranspose);
     if (layer->mActvGradInv)
         intnn_free_mat(layer->mActvGradInv);
+    if (layer->mActvGradCode) {
+        intnn_free_tmat(layer->mActvGradCode);
+        layer->mActvGradCode = NULL;
+    }
     if (layer->mWeightUpdate)
         intnn_free_mat(layer->mWeightUpdate);
     if (layer->mBiasUpdate)
@@ -130,54 +145,305 @@ void intnn_fc_free(intnn_fc_layer* layer) {
     }
 }
 
-void intnn_fc_forward(intnn_fc_layer* layer, intnn_mat* x) {
+// 激活梯度移位编码第 r 行起始地址
+static uint8_t* intnn_fc_grad_code_row(const intnn_fc_layer* layer, int r) {
+    return (uint8_t*)layer->mActvGradCode->mData + (size_t)r * layer->mActvGradCode->mStride;
+}
+
+// GEMM 写回回调：mInter 行段加偏置后激活，写 mOutput 与激活梯度（移位编码或 mActvGradInv）的对应行段
+static void intnn_fc_forward_epilogue(void* ctx, int r, int c0, int* inter, int n) {
+    intnn_fc_layer* layer = (intnn_fc_layer*)ctx;
+    const int* bias = INTNN_MAT_ROW(layer->mBias, 0) + c0;
+    for (int j = 0; j < n; ++j)
+        inter[j] += bias[j]; // (1, D(k)) 广播
+    if (intnn_actv_has_grad_code(layer->mActv))
+        intnn_activate_row_code(INTNN_MAT_ROW(layer->mOutput, r) + c0, intnn_fc_grad_code_row(layer, r) + c0,
+                                inter, n, layer->mActv, INTNN_K_BIT, layer->mInDim);
+    else
+        intnn_activate_row(INTNN_MAT_ROW(layer->mOutput, r) + c0, INTNN_MAT_ROW(layer->mActvGradInv, r) + c0,
+                           inter, n, layer->mActv, INTNN_K_BIT, layer->mInDim);
+}
+
+// 融合前向：mInter = x × W + B，mOutput = activation(mInter)，一次 GEMM 完成
+static void intnn_fc_forward_fused(intnn_fc_layer* layer, const intnn_mat* x) {
+    if (x->mCols != layer->mWeight->mRows) {
+        printf("Matrix multiplication dimension mismatch: x (%d, %d), W (%d, %d)\n",
+               x->mRows, x->mCols, layer->mWeight->mRows, layer->mWeight->mCols);
+        assert(0);
+    }
+    intnn_gemm_operand opX = { x->mData, x->mStride, INTNN_DTYPE_INT32, false };
+    intnn_gemm_operand opW = { layer->mWeight->mData, layer->mWeight->mStride, INTNN_DTYPE_INT16, false };
+    intnn_gemm_epilogue epilogue = { intnn_fc_forward_epilogue, layer };
+    intnn_gemm_ex(layer->mInter, &opX, &opW, x->mCols, &epilogue); // (N, D(k)) = (N, D(k-1)) × (D(k-1), D(k))
+}
+
+// out = x × W（int16 权重在 GEMM 打包时拓宽），out 须已是 (x.rows, outDim)；softmax 分步路径使用
+static void intnn_fc_mul_weight(intnn_mat* out, const intnn_mat* x, const intnn_fc_layer* layer) {
+    if (x->mCols != layer->mWeight->mRows || out->mRows != x->mRows || out->mCols != layer->mWeight->mCols)
+        assert(0);
+    intnn_gemm_operand opX = { x->mData, x->mStride, INTNN_DTYPE_INT32, false };
+    intnn_gemm_operand opW = { layer->mWeight->mData, layer->mWeight->mStride, INTNN_DTYPE_INT16, false };
+    intnn_gemm_ex(out, &opX, &opW, x->mCols, NULL);
+}
+
+// 按当前批大小设置工作矩阵的逻辑尺寸：首次使用时创建，之后仅在容量不足时重新分配
+static void intnn_fc_ensure_mat(intnn_mat** mat, int rows, int cols) {
+    // 工作矩阵跨步保留，即使绑定了步内内存池也在堆上分配
+    intnn_arena* arena = intnn_arena_bind(NULL);
+    if (!*mat)
+        *mat = intnn_create_mat(rows, cols);
+    else
+        intnn_resize(*mat, rows, cols);
+    intnn_arena_bind(arena);
+}
+
+// 激活梯度缓冲区：可移位编码的激活用 UINT8 编码，其余（plu、softmax）用 int 的 mActvGradInv
+static void intnn_fc_ensure_actv_grad(intnn_fc_layer* layer, int rows, int cols) {
+    if (intnn_actv_has_grad_code(layer->mActv)) {
+        if (!layer->mActvGradCode)
+            layer->mActvGradCode = intnn_create_tmat(rows, cols, INTNN_DTYPE_UINT8);
+        else
+            intnn_tmat_resize(layer->mActvGradCode, rows, cols, INTNN_DTYPE_UINT8);
+    } else {
+        intnn_fc_ensure_mat(&layer->mActvGradInv, rows, cols);
+    }
+}
+
+// out = in / 激活梯度倒数，out 可与 in 相同；移位编码按位移实现，不做除法
+static void intnn_fc_div_actv_grad(const intnn_fc_layer* layer, intnn_mat* out, const intnn_mat* in) {
+    if (intnn_actv_has_grad_code(layer->mActv)) {
+        const intnn_tmat* code = layer->mActvGradCode;
+        if (!code || code->mRows != in->mRows || code->mCols != in->mCols || !intnn_dims_equal(out, in))
+            assert(0);
+        for (int r = 0; r < in->mRows; ++r)
+            intnn_apply_grad_code_row(INTNN_MAT_ROW(out, r), INTNN_MAT_ROW(in, r), intnn_fc_grad_code_row(layer, r), in->mCols);
+    } else if (out == in) {
+        intnn_self_elem_div_mat(out, layer->mActvGradInv);
+    } else {
+        intnn_mat_elem_div_mat(out, in, layer->mActvGradInv);
+    }
+}
+
+void intnn_fc_reserve(intnn_fc_layer* layer, int maxBatch) {
+    assert(layer != NULL && maxBatch > 0);
+    intnn_fc_ensure_mat(&layer->mInter, maxBatch, layer->mOutDim);
+    intnn_fc_ensure_mat(&layer->mOutput, maxBatch, layer->mOutDim);
+    intnn_fc_ensure_actv_grad(layer, maxBatch, layer->mOutDim);
+    intnn_fc_ensure_mat(&layer->mDeltas, maxBatch, layer->mOutDim);
+    intnn_fc_ensure_mat(&layer->mWeightUpdate, layer->mInDim, layer->mOutDim);
+    intnn_fc_ensure_mat(&layer->mBiasUpdate, 1, layer->mOutDim);
+}
+
+void intnn_fc_forward_layer(intnn_fc_layer* layer, intnn_mat* x) {
     assert(layer != NULL && x != NULL);
-    
-    layer->mInput = intnn_copy_mat(x);
 
-    if (layer->mInter) intnn_free_mat(layer->mInter);
-    layer->mInter = intnn_create_mat(x->mRows, layer->mWeight->mCols);
-    intnn_mat_mul_mat(layer->mInter, x, layer->mWeight); // (N, D(k)) = (N, D(k-1)) × (D(k-1), D(k)) 
+    if (layer->mCopyInput) {
+        // 调用方会改写 x：复制到层内复用的缓冲区
+        intnn_fc_ensure_mat(&layer->mInputCopy, x->mRows, x->mCols);
+        for (int r = 0; r < x->mRows; ++r)
+            memcpy(INTNN_MAT_ROW(layer->mInputCopy, r), INTNN_MAT_ROW(x, r), sizeof(int) * x->mCols);
+        layer->mInput = layer->mInputCopy;
+    } else {
+        layer->mInput = x; // 只引用，不复制
+    }
 
-    //printf("X OF (%d, %d):\n", layer->mInDim, layer->mOutDim);
-    //intnn_print_mat(x);
-   /* for (int i = 0; i < 10; i++, printf("\n"))
-        for (int j = 0; j < 10; j++)
-            printf("%d ", x->mMat[i][j]);*/
-    //printf("W OF (%d, %d):\n", layer->mInDim, layer->mOutDim);
-    /*for (int i = 0; i < 10; i++, printf("\n"))
-        for (int j = 0; j < 10; j++)
-            printf("%d ", layer->mWeight->mMat[i][j]);*/
-    /*intnn_print_mat(layer->mWeight);
-    
-    printf("INTER OF (%d, %d):\n", layer->mInDim, layer->mOutDim);
-    intnn_print_mat(layer->mInter);*/
-    /*for(int i=0;i<10;i++,printf("\n"))
-        for(int j=0;j<10;j++)
-			printf("%d ", layer->mInter->mMat[i][j]);*/
+    intnn_fc_ensure_mat(&layer->mInter, x->mRows, layer->mWeight->mCols);
 
     if(layer->mUseBn){
         assert(0); // 不支持
-    }else{
-        intnn_self_add_mat(layer->mInter, layer->mBias); // (N, D(k)) += (1, D(k)) => (N, D(k))
-
-        if (layer->mOutput) intnn_free_mat(layer->mOutput);
-        layer->mOutput = intnn_create_mat(layer->mInter->mRows, layer->mInter->mCols);
+    }
 
-        if (layer->mActvGradInv) intnn_free_mat(layer->mActvGradInv);
-        layer->mActvGradInv = intnn_create_mat(layer->mInter->mRows, layer->mInter->mCols);
+    intnn_fc_ensure_mat(&layer->mOutput, layer->mInter->mRows, layer->mInter->mCols);
+    intnn_fc_ensure_actv_grad(layer, layer->mInter->mRows, layer->mInter->mCols);
 
+    if (intnn_actv_is_elementwise(layer->mActv)) {
+        // 偏置与激活在 GEMM 写回时完成，不再单独遍历 mInter
+        intnn_fc_forward_fused(layer, x); // (N, D(k)) = activation((N, D(k-1)) × (D(k-1), D(k)) + (1, D(k)))
+    } else {
+        // softmax 需要整行结果，走分步路径
+        intnn_fc_mul_weight(layer->mInter, x, layer); // (N, D(k)) = (N, D(k-1)) × (D(k-1), D(k))
+        intnn_self_add_mat(layer->mInter, layer->mBias); // (N, D(k)) += (1, D(k)) => (N, D(k))
         intnn_activate(layer->mOutput, layer->mInter, layer->mActvGradInv,
             layer->mActv, INTNN_K_BIT, layer->mInDim); // (N, D(k)) = activation((N, D(k)))
     }
+}
+
+// 推理写回回调：在 mOutput 上就地加偏置并激活，不写激活梯度
+static void intnn_fc_infer_epilogue(void* ctx, int r, int c0, int* vals, int n) {
+    const intnn_fc_layer* layer = (const intnn_fc_layer*)ctx;
+    const int* bias = INTNN_MAT_ROW(layer->mBias, 0) + c0;
+    (void)r;
+    for (int j = 0; j < n; ++j)
+        vals[j] += bias[j]; // (1, D(k)) 广播
+    intnn_activate_row_nograd(vals, vals, n, layer->mActv, INTNN_K_BIT, layer->mInDim);
+}
+
+// 推理核心：结果写入 out；softmax 分步路径的中间结果写入 inter / gradInv，为 NULL 时用临时矩阵
+static void intnn_fc_infer_core(const intnn_fc_layer* layer, const intnn_mat* x, intnn_mat* out,
+                                intnn_mat* inter, intnn_mat* gradInv) {
+    assert(layer != NULL && x != NULL && out != NULL && out != x);
+    if (layer->mUseBn) {
+        assert(0); // 不支持
+    }
+    if (x->mCols != layer->mWeight->mRows) {
+        printf("Matrix multiplication dimension mismatch: x (%d, %d), W (%d, %d)\n",
+               x->mRows, x->mCols, layer->mWeight->mRows, layer->mWeight->mCols);
+        assert(0);
+    }
+
+    intnn_resize(out, x->mRows, layer->mOutDim);
+    if (intnn_actv_is_elementwise(layer->mActv)) {
+        // GEMM 结果直接写入 out，写回时就地加偏置并激活；不使用 mInter / mActvGradInv，不记录输入
+        intnn_gemm_operand opX = { x->mData, x->mStride, INTNN_DTYPE_INT32, false };
+        intnn_gemm_operand opW = { layer->mWeight->mData, layer->mWeight->mStride, INTNN_DTYPE_INT16, false };
+        intnn_gemm_epilogue epilogue = { intnn_fc_infer_epilogue, (void*)layer };
+        intnn_gemm_ex(out, &opX, &opW, x->mCols, &epilogue); // (N, D(k)) = activation((N, D(k-1)) × (D(k-1), D(k)) + (1, D(k)))
+    } else {
+        // softmax 需要整行结果，仍走分步路径（激活梯度写入 gradInv，但不记录输入）
+        intnn_mat tmpInter = {0};
+        intnn_mat tmpGrad = {0};
+        if (!inter)
+            inter = &tmpInter;
+        if (!gradInv)
+            gradInv = &tmpGrad;
+        intnn_resize(inter, x->mRows, layer->mOutDim);
+        intnn_resize(gradInv, x->mRows, layer->mOutDim);
+        intnn_fc_mul_weight(inter, x, layer);
+        intnn_self_add_mat(inter, layer->mBias);
+        intnn_activate(out, inter, gradInv, layer->mActv, INTNN_K_BIT, layer->mInDim);
+        intnn_free_mat(&tmpInter);
+        intnn_free_mat(&tmpGrad);
+    }
+}
+
+void intnn_fc_infer_layer(intnn_fc_layer* layer, const intnn_mat* x) {
+    assert(layer != NULL && x != NULL);
+    intnn_fc_ensure_mat(&layer->mOutput, x->mRows, layer->mOutDim);
+    if (intnn_actv_is_elementwise(layer->mActv)) {
+        intnn_fc_infer_core(layer, x, layer->mOutput, NULL, NULL);
+    } else {
+        intnn_fc_ensure_mat(&layer->mInter, x->mRows, layer->mOutDim);
+        intnn_fc_ensure_mat(&layer->mActvGradInv, x->mRows, layer->mOutDim);
+        intnn_fc_infer_core(layer, x, layer->mOutput, layer->mInter, layer->mActvGradInv);
+    }
+}
 
+void intnn_fc_infer_to(const intnn_fc_layer* layer, const intnn_mat* x, intnn_mat* out) {
+    intnn_fc_infer_core(layer, x, out, NULL, NULL);
+}
 
+void intnn_fc_infer(intnn_fc_layer* layer, const intnn_mat* x) {
+    for (; layer != NULL; layer = layer->mNext) {
+        intnn_fc_infer_layer(layer, x);
+        x = layer->mOutput;
+    }
+}
+
+void intnn_fc_forward(intnn_fc_layer* layer, intnn_mat* x) {
+    intnn_fc_forward_layer(layer, x);
     if(layer->mNext != NULL){
         intnn_fc_forward(layer->mNext, layer->mOutput); // 递归调用下一层
     }
 }
 
-void intnn_fc_backward(intnn_fc_layer* layer,
+// 参数更新：update = 累加量 / -lrInv，参数 += update 后限幅到 [-32767, 32767]。
+// 加法按 int 回绕后再限幅，与 intnn_self_add_mat + intnn_clamp_mat 逐位一致
+typedef struct {
+    const intnn_fc_layer* mLayer;
+    int mDivisor;   // -lrInv
+    int mShift;     // lrInv 为 2 的幂时的指数（向零取整右移后取反，与除法逐位一致），否则为 -1
+} intnn_fc_update_job;
+
+static intnn_fc_update_job intnn_fc_update_job_of(const intnn_fc_layer* layer, int lrInv) {
+    if (lrInv == 0)
+        assert(0); // 与 intnn_self_div_const 相同，不允许除零
+    intnn_fc_update_job job = { layer, -lrInv, intnn_exact_log2(lrInv) };
+    return job;
+}
+
+// 按学习率缩放一行更新量（原地）
+static void intnn_fc_scale_update_row(const intnn_fc_update_job* job, int* upd, int n) {
+    if (job->mShift >= 0) {
+        const int shift = job->mShift;
+        const unsigned int bias = (1u << shift) - 1u;
+        for (int c = 0; c < n; ++c)
+            upd[c] = -((upd[c] + (int)((unsigned int)(upd[c] >> 31) & bias)) >> shift);
+    } else {
+        for (int c = 0; c < n; ++c)
+            upd[c] /= job->mDivisor;
+    }
+}
+
+static int intnn_fc_clamp_param(int old, int upd) {
+    const int val = (int)((unsigned int)old + (unsigned int)upd);
+    return val < -32767 ? -32767 : (val > 32767 ? 32767 : val);
+}
+
+// 偏置：缩放一行更新量后加到参数对应行并限幅；Hogwild 模式下逐元素 relaxed CAS，不加锁
+static void intnn_fc_apply_update_row(const intnn_fc_update_job* job, int* target, int* upd, int n) {
+    intnn_fc_scale_update_row(job, upd, n);
+    if (job->mLayer->mAtomicUpdate) {
+        for (int c = 0; c < n; ++c) {
+            int old = __atomic_load_n(&target[c], __ATOMIC_RELAXED);
+            int val;
+            do {
+                val = intnn_fc_clamp_param(old, upd[c]);
+                if (val == old)
+                    break;
+            } while (!__atomic_compare_exchange_n(&target[c], &old, val, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+        }
+        return;
+    }
+    for (int c = 0; c < n; ++c)
+        target[c] = intnn_fc_clamp_param(target[c], upd[c]);
+}
+
+// 权重：同上，目标为 int16；限幅范围在 int16 内，窄存储不改变结果
+static void intnn_fc_apply_update_row16(const intnn_fc_update_job* job, int16_t* target, int* upd, int n) {
+    intnn_fc_scale_update_row(job, upd, n);
+    if (job->mLayer->mAtomicUpdate) {
+        for (int c = 0; c < n; ++c) {
+            int16_t old = __atomic_load_n(&target[c], __ATOMIC_RELAXED);
+            int16_t val;
+            do {
+                val = (int16_t)intnn_fc_clamp_param(old, upd[c]);
+                if (val == old)
+                    break;
+            } while (!__atomic_compare_exchange_n(&target[c], &old, val, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+        }
+        return;
+    }
+    for (int c = 0; c < n; ++c)
+        target[c] = (int16_t)intnn_fc_clamp_param(target[c], upd[c]);
+}
+
+// 权重更新 GEMM 的写回回调：mWeightUpdate 行段缩放后直接加到 mWeight 的同一行段
+static void intnn_fc_weight_update_epilogue(void* ctx, int r, int c0, int* vals, int n) {
+    const intnn_fc_update_job* job = (const intnn_fc_update_job*)ctx;
+    const intnn_tmat* w = job->mLayer->mWeight;
+    intnn_fc_apply_update_row16(job, (int16_t*)w->mData + (size_t)r * w->mStride + c0, vals, n);
+}
+
+// 本层最近一次前向的输入：上一层输出，第一层为 mInput
+static const intnn_mat* intnn_fc_get_input(const intnn_fc_layer* layer) {
+    return layer->mPrev != NULL ? layer->mPrev->mOutput : layer->mInput;
+}
+
+// DFA 反馈矩阵首次使用时随机初始化，形状 (最后一层输出维度, 本层输出维度)
+void intnn_fc_ensure_dfa_weight(intnn_fc_layer* layer, int lastDim) {
+    if (layer->mDfaWeight)
+        return;
+    int range = intnn_floor_sqrt((12 * SHRT_MAX) / (layer->mInDim + layer->mOutDim));
+    intnn_fc_ensure_mat(&layer->mDfaWeight, lastDim, layer->mWeight->mCols);
+    intnn_set_random(layer->mDfaWeight, false, -range, range);
+    //printf("DFA initialized!\n");
+    //printf("initial DFA of layer %d->%d, size:(%d, %d)\n", layer->mInDim, layer->mOutDim, layer->mDfaWeight->mRows, layer->mDfaWeight->mCols);
+    //intnn_print_mat(layer->mDfaWeight);
+}
+
+// 单层反向：计算本层误差并更新本层权重和偏置，不递归
+void intnn_fc_backward_layer(intnn_fc_layer* layer,
+    const intnn_mat* input,
     intnn_mat* lastDeltas,
     int lrInv) {
      // COMPUTE DELTAS
@@ -187,36 +453,22 @@ void intnn_fc_backward(intnn_fc_layer* layer,
     }
 
     if(layer->mNext == NULL){
-        if (layer->mDeltas) intnn_free_mat(layer->mDeltas);
-        layer->mDeltas = intnn_create_mat(lastDeltas->mRows, lastDeltas->mCols);
+        intnn_fc_ensure_mat(&layer->mDeltas, lastDeltas->mRows, lastDeltas->mCols);
 
-        intnn_mat_elem_div_mat(layer->mDeltas, lastDeltas, layer->mActvGradInv); // (N, D(k)) = (N, D(k)) / (1, D(k))
+        intnn_fc_div_actv_grad(layer, layer->mDeltas, lastDeltas); // (N, D(k)) = (N, D(k)) / (1, D(k))
     }
     else {
         if (!layer->mUseDfa) {
             assert(0); // 不支持
         }
         else {
-            if (!layer->mDfaWeight) {
-                int range = intnn_floor_sqrt((12 * SHRT_MAX) / (layer->mInDim + layer->mOutDim));
-                layer->mDfaWeight = intnn_create_mat(lastDeltas->mCols, layer->mWeight->mCols);
-                intnn_set_random(layer->mDfaWeight, false, -range, range);
-                //printf("DFA initialized!\n");
-                //printf("initial DFA of layer %d->%d, size:(%d, %d)\n", layer->mInDim, layer->mOutDim, layer->mDfaWeight->mRows, layer->mDfaWeight->mCols);
-                //intnn_print_mat(layer->mDfaWeight);
-            }
-            if (layer->mDeltas) intnn_free_mat(layer->mDeltas);
-            layer->mDeltas = intnn_create_mat(lastDeltas->mRows, layer->mDfaWeight->mCols);
+            intnn_fc_ensure_dfa_weight(layer, lastDeltas->mCols);
+            intnn_fc_ensure_mat(&layer->mDeltas, lastDeltas->mRows, layer->mDfaWeight->mCols);
             intnn_mat_mul_mat(layer->mDeltas, lastDeltas, layer->mDfaWeight); // (N, D(k)) = (N, D(k-1)) × (D(k-1), D(k))
-            intnn_self_elem_div_mat(layer->mDeltas, layer->mActvGradInv); // (N, D(k)) = (N, D(k)) / (1, D(k))
+            intnn_fc_div_actv_grad(layer, layer->mDeltas, layer->mDeltas); // (N, D(k)) = (N, D(k)) / (1, D(k))
         }
     }
     
-    if (layer->mDeltasTranspose) intnn_free_mat(layer->mDeltasTranspose);
-    layer->mDeltasTranspose = intnn_create_mat(layer->mDeltas->mCols, layer->mDeltas->mRows);
-
-    intnn_transpose_of(layer->mDeltasTranspose, layer->mDeltas); // (D(k), N) = (N, D(k))
-
     // AFTER COMPUTE DELTAS
 
     /*printf("MDELTAS of layer %d->%d \n", layer->mInDim, layer->mOutDim);
@@ -230,24 +482,22 @@ void intnn_fc_backward(intnn_fc_layer* layer,
             printf("%d | ", lastDeltas->mMat[i][j]);*/
     
 
-    int batchSize = layer->mDeltas->mRows;
-
-    intnn_mat* prevOutputTranspose;
-    if(layer->mPrev != NULL) {
-        prevOutputTranspose = intnn_create_mat(layer->mPrev->mOutput->mCols, layer->mPrev->mOutput->mRows);
-        intnn_transpose_of(prevOutputTranspose, layer->mPrev->mOutput); // (D(k-1), N) = (N, D(k-1))
-    } else {
-        prevOutputTranspose = intnn_create_mat(layer->mInput->mCols, layer->mInput->mRows);
-        intnn_transpose_of(prevOutputTranspose, layer->mInput); // (D(k-1), N) = (N, D(k-1))
-    }
+    // 本层前向输入（上一层输出或第一层输入），GEMM 以转置方式直接读取，不生成转置副本
+    const intnn_mat* prevOutput = input; // (N, D(k-1))
 
     //intnn_print_mat(layer->mDeltas);
 
-    if (!layer->mWeightUpdate) layer->mWeightUpdate = intnn_create_mat(layer->mInDim, layer->mOutDim);
-    intnn_reset_zero(layer->mWeightUpdate, layer->mInDim, layer->mOutDim); // 重置权重更新矩阵
-    intnn_mat_mul_mat(layer->mWeightUpdate, prevOutputTranspose, layer->mDeltas); // (D(k-1), D(k)) = (D(k-1), N) × (N, D(k))
+    intnn_fc_ensure_mat(&layer->mWeightUpdate, layer->mInDim, layer->mOutDim); // GEMM 直接覆盖，无需清零
+    if (prevOutput->mRows != layer->mDeltas->mRows || prevOutput->mCols != layer->mInDim ||
+        layer->mDeltas->mCols != layer->mOutDim)
+        assert(0);
 
-    intnn_self_div_const(layer->mWeightUpdate, -lrInv); // (D(k-1), D(k)) /= -lrInv
+    // 一次 GEMM 完成权重更新：写回时 /= -lrInv 并加到 mWeight、限幅，mWeightUpdate 保留缩放后的更新量
+    const intnn_fc_update_job job = intnn_fc_update_job_of(layer, lrInv);
+    intnn_gemm_operand opX = { prevOutput->mData, prevOutput->mStride, INTNN_DTYPE_INT32, true };
+    intnn_gemm_operand opD = { layer->mDeltas->mData, layer->mDeltas->mStride, INTNN_DTYPE_INT32, false };
+    intnn_gemm_epilogue epilogue = { intnn_fc_weight_update_epilogue, (void*)&job };
+    intnn_gemm_ex(layer->mWeightUpdate, &opX, &opD, prevOutput->mRows, &epilogue); // (D(k-1), D(k)) = (N, D(k-1))ᵀ × (N, D(k)) / -lrInv
 
 
     /*printf("WEIGHT UPDATE of layer %d->%d:\n", layer->mInDim, layer->mOutDim);
@@ -255,24 +505,17 @@ void intnn_fc_backward(intnn_fc_layer* layer,
         for (int j = 0; j < layer->mWeightUpdate->mCols; j++)
             printf("%d | ", layer->mWeightUpdate->mMat[i][j]);*/
 
-    intnn_self_add_mat(layer->mWeight, layer->mWeightUpdate); // (D(k-1), D(k)) += (D(k-1), D(k))
-
     //intnn_print_mat(layer->mWeightUpdate);
 
     if(layer->mUseBn){
         assert(0);
     }else{
-        intnn_mat* allOneMat = intnn_create_mat(1, batchSize);
-        intnn_reset_all_ones(allOneMat, 1, batchSize); // (1, N) = (1, N)
-
-        if (layer->mBiasUpdate) intnn_free_mat(layer->mBiasUpdate);
-        layer->mBiasUpdate = intnn_create_mat(allOneMat->mRows, layer->mDeltas->mCols);
-        intnn_mat_mul_mat(layer->mBiasUpdate, allOneMat, layer->mDeltas); // (1, D(k)) = (1, N) × (N, D(k))
-        intnn_self_div_const(layer->mBiasUpdate, -lrInv); // (1, D(k)) /= -lrInv
+        intnn_fc_ensure_mat(&layer->mBiasUpdate, 1, layer->mDeltas->mCols);
+        intnn_sum_colwise_of(layer->mBiasUpdate, layer->mDeltas); // (1, D(k)) = (1, N) 全 1 × (N, D(k))
 
-        if (!layer->mBias) layer->mBias = intnn_create_mat(layer->mBiasUpdate->mRows, layer->mBiasUpdate->mCols);
-        intnn_self_add_mat(layer->mBias, layer->mBiasUpdate); // (1, D(k)) += (1, D(k))
-        intnn_free_mat(allOneMat); // 释放临时矩阵
+        if (!layer->mBias) intnn_fc_ensure_mat(&layer->mBias, layer->mBiasUpdate->mRows, layer->mBiasUpdate->mCols);
+        intnn_fc_apply_update_row(&job, INTNN_MAT_ROW(layer->mBias, 0), INTNN_MAT_ROW(layer->mBiasUpdate, 0),
+                                  layer->mBiasUpdate->mCols); // (1, D(k)) += (1, D(k)) / -lrInv
     }
 
 	/*printf("Size: %d, %d\n", layer->mWeight->mRows, layer->mWeight->mCols);
@@ -283,12 +526,60 @@ void intnn_fc_backward(intnn_fc_layer* layer,
     printf("Bias:\n");
 	for (int i = 0; i < 10; i++, printf("\n"))
 		printf("%d ", layer->mBias->mMat[0][i]);*/
+}
+
+// DFA 反向的并行任务：每层只依赖最后一层误差、本层激活梯度和前一层前向输出，层间无写依赖
+typedef struct {
+    intnn_fc_layer** mLayers;
+    intnn_mat* mLastDeltas;
+    int mLrInv;
+} intnn_fc_dfa_job;
+
+static void intnn_fc_backward_dfa_task(void* ctx, int begin, int end, int tid) {
+    const intnn_fc_dfa_job* job = (const intnn_fc_dfa_job*)ctx;
+    (void)tid;
+    for (int i = begin; i < end; ++i)
+        intnn_fc_backward_layer(job->mLayers[i], intnn_fc_get_input(job->mLayers[i]), job->mLastDeltas, job->mLrInv);
+}
 
-    intnn_free_mat(prevOutputTranspose); // 释放转置矩阵
+// 从最后一层向前都是 DFA 层（最后一层本身除外）时，各层反向可同时进行
+static bool intnn_fc_chain_is_dfa(const intnn_fc_layer* last) {
+    for (const intnn_fc_layer* l = last->mPrev; l != NULL; l = l->mPrev) {
+        if (!l->mUseDfa || l->mUseBn)
+            return false;
+    }
+    return true;
+}
 
-    intnn_clamp_mat(layer->mWeight, -32767, 32767); // 限制权重范围
-    intnn_clamp_mat(layer->mBias, -32767, 32767); // 限制偏置范围
+void intnn_fc_backward(intnn_fc_layer* layer,
+    intnn_mat* lastDeltas,
+    int lrInv) {
+    assert(layer != NULL && lastDeltas != NULL);
+
+    if (layer->mNext == NULL && layer->mPrev != NULL && !layer->mUseBn && intnn_fc_chain_is_dfa(layer)) {
+        int numLayers = 0;
+        for (intnn_fc_layer* l = layer; l != NULL; l = l->mPrev)
+            ++numLayers;
+        intnn_fc_layer* stackLayers[16];
+        intnn_fc_layer** layers = numLayers <= 16 ? stackLayers
+                                                  : (intnn_fc_layer**)malloc(sizeof(intnn_fc_layer*) * numLayers);
+        if (!layers)
+            assert(0);
+        // 按串行反向的顺序（从后往前）初始化 DFA 反馈矩阵，随机数序列与串行一致；之后各层互不依赖
+        int n = 0;
+        for (intnn_fc_layer* l = layer; l != NULL; l = l->mPrev) {
+            if (l != layer)
+                intnn_fc_ensure_dfa_weight(l, lastDeltas->mCols);
+            layers[n++] = l;
+        }
+        intnn_fc_dfa_job job = { layers, lastDeltas, lrInv };
+        intnn_parallel_for(numLayers, 1, intnn_fc_backward_dfa_task, &job);
+        if (layers != stackLayers)
+            free(layers);
+        return;
+    }
 
+    intnn_fc_backward_layer(layer, intnn_fc_get_input(layer), lastDeltas, lrInv);
     if(layer->mPrev != NULL){
         intnn_fc_backward(layer->mPrev, lastDeltas, lrInv); // 递归调用上一层
     }
@@ -300,13 +591,19 @@ intnn_mat* intnn_fc_get_output(intnn_fc_layer* layer) {
     return layer->mOutput;
 }
 
-intnn_mat* intnn_fc_get_weight(intnn_fc_layer* layer) {
+intnn_tmat* intnn_fc_get_weight(intnn_fc_layer* layer) {
     assert(layer != NULL);
     return layer->mWeight;
 }
 
 intnn_mat* intnn_fc_get_deltas_transpose(intnn_fc_layer* layer) {
     assert(layer != NULL);
+    if (!layer->mDeltas)
+        return NULL;
+    // 反向传播不再使用转置副本，仅在调用方需要时按当前误差生成
+    if (!layer->mDeltasTranspose)
+        layer->mDeltasTranspose = intnn_create_mat(layer->mDeltas->mCols, layer->mDeltas->mRows);
+    intnn_transpose_of(layer->mDeltasTranspose, layer->mDeltas); // (D(k), N) = (N, D(k))
     return layer->mDeltasTranspose;
 }
 
@@ -320,13 +617,13 @@ void intnn_fc_set_actv(intnn_fc_layer* layer, intnn_actv_type actv) {
 }
 
 void intnn_fc_set_random_weight_bias(intnn_fc_layer* layer) {
-    intnn_set_random(layer->mWeight, false, -127, 127);
+    intnn_tmat_set_random(layer->mWeight, false, -127, 127);
     intnn_set_random(layer->mBias, true, 0, 0);
 }
 
 void intnn_fc_set_he_init(intnn_fc_layer* layer) {
     int range = sqrt((12 * INTNN_MAX) / (layer->mInDim + layer->mOutDim));
-    intnn_set_random(layer->mWeight, false, -range, range);
+    intnn_tmat_set_random(layer->mWeight, false, -range, range);
     intnn_set_random(layer->mBias, false, -range, range);
 }
 
@@ -337,14 +634,14 @@ void intnn_fc_use_bn(intnn_fc_layer* layer, bool use_bn) {
 void intnn_fc_use_dfa(intnn_fc_layer* layer, bool use_dfa) {
     layer->mUseDfa = use_dfa;
     if (use_dfa) {
-        intnn_set_all_constant(layer->mWeight, 0);
+        intnn_tmat_set_all_constant(layer->mWeight, 0);
         intnn_set_all_constant(layer->mBias, 0);
     }
 }
 
 void intnn_fc_set_random_weight(intnn_fc_layer* layer) {
     assert(layer && layer->mWeight);
-    intnn_set_random(layer->mWeight, false, -127, 127);  // 使用已有的随机函数
+    intnn_tmat_set_random(layer->mWeight, false, -127, 127);  // 使用已有的随机函数
 }
 
 void intnn_fc_set_random_bias(intnn_fc_layer* layer) {
@@ -369,11 +666,19 @@ void intnn_fc_init_he_weight_bias(intnn_fc_layer* layer) {
     int range = sqrt((12 * INTNN_MAX) / (layer->mInDim + layer->mOutDim));
 
     // Initialize weights and biases
-    intnn_set_random(layer->mWeight, false, -range, range);
+    intnn_tmat_set_random(layer->mWeight, false, -range, range);
     intnn_set_all_constant(layer->mBias,
                            0);  // He initialization typically sets bias to 0
 }
 
+void intnn_fc_set_copy_input(intnn_fc_layer* layer, bool copyInput) {
+    if (!layer)
+        return;
+    layer->mCopyInput = copyInput;
+    if (!copyInput && layer->mInput == layer->mInputCopy)
+        layer->mInput = NULL; // 旧副本不再代表当前输入
+}
+
 void intnn_fc_use_batch_normalization(intnn_fc_layer* layer, bool useBn) {
     if (!layer)
         return;
@@ -383,7 +688,7 @@ void intnn_fc_use_batch_normalization(intnn_fc_layer* layer, bool useBn) {
 void intnn_fc_print_weight(intnn_fc_layer* layer, FILE* out) {
     if (!layer || !layer->mWeight)
         return;
-    intnn_print_mat(layer->mWeight);
+    intnn_print_tmat(layer->mWeight);
 }
 
 void intnn_fc_print_bias(intnn_fc_layer* layer, FILE* out) {
@@ -405,6 +710,6 @@ void intnn_fc_print_output(intnn_fc_layer* layer, FILE* out) {
 }
 
 void intnn_fc_copy_weights(intnn_fc_layer* dest, const intnn_fc_layer* src) {
-    dest->mWeight = intnn_copy_mat(src->mWeight);
+    dest->mWeight = intnn_copy_tmat(src->mWeight);
     dest->mBias = intnn_copy_mat(src->mBias);
 }
@@ -0,0 +1,359 @@
+#include "intnn_fc_pipeline.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Windows（MinGW）构建不链接 pthread，流水线退化为串行
+#if !defined(_WIN32)
+#define INTNN_HAVE_PTHREADS 1
+#include <pthread.h>
+#endif
+
+// 每级独占的工作矩阵：前向中间结果、本层误差与更新量只在本级线程内使用，不随批次轮换
+typedef struct {
+    intnn_mat* mInter;
+    intnn_mat* mDeltas;
+    intnn_mat* mWeightUpdate;
+    intnn_mat* mBiasUpdate;
+} intnn_fc_stage_scratch;
+
+struct intnn_fc_pipeline {
+    intnn_fc_layer** mLayers;   // 第一层到最后一层
+    int mNumLayers;
+    int mStaleness;
+    int mSlots;                 // 环形缓冲槽数 = 陈旧度 + 1，第 j 批使用槽 j % mSlots
+    intnn_mat** mInputs;        // 第一层输入 [slot]
+    intnn_mat** mOutputs;       // 各层输出 [layer * mSlots + slot]
+    intnn_mat** mGradInvs;      // 各层激活梯度 [layer * mSlots + slot]，仅无移位编码的激活使用，否则为 NULL
+    intnn_tmat** mGradCodes;    // 各层激活梯度移位编码 [layer * mSlots + slot]，仅可编码的激活使用，否则为 NULL
+    intnn_mat** mDeltas;        // 最后一层误差 [slot]
+    intnn_mat** mOrigOutputs;   // 各层原有的 mOutput / mActvGradInv / mActvGradCode，运行结束后恢复
+    intnn_mat** mOrigGradInvs;
+    intnn_tmat** mOrigGradCodes;
+    intnn_fc_stage_scratch* mScratch; // 各级工作矩阵 [layer]，运行期间与层自己的交换
+
+    // 当前一次 run 的参数
+    int mNumBatches;
+    int mLrInv;
+    intnn_pipeline_input_fn mInputFn;
+    intnn_pipeline_loss_fn mLossFn;
+    void* mCtx;
+
+    // 进度：mFwdDone[k] / mBwdDone[k] 为第 k 层已完成前向 / 已应用更新的批数，mLossDone 为已算出误差的批数
+    int* mFwdDone;
+    int* mBwdDone;
+    int mLossDone;
+#ifdef INTNN_HAVE_PTHREADS
+    pthread_mutex_t mLock;
+    pthread_cond_t mCond;
+#endif
+};
+
+intnn_fc_pipeline* intnn_fc_pipeline_create(intnn_fc_layer* first, int maxBatch, int staleness) {
+    if (!first || maxBatch <= 0)
+        assert(0);
+
+    int numLayers = 0;
+    intnn_fc_layer* last = first;
+    for (intnn_fc_layer* l = first; l != NULL; l = l->mNext) {
+        if (l->mUseBn || (l->mNext != NULL && !l->mUseDfa)) {
+            printf("[WARN] fc_pipeline: every layer but the last must use DFA without batch normalization\n");
+            return NULL;
+        }
+        last = l;
+        ++numLayers;
+    }
+
+    intnn_fc_pipeline* p = (intnn_fc_pipeline*)calloc(1, sizeof(intnn_fc_pipeline));
+    if (!p)
+        return NULL;
+#ifdef INTNN_HAVE_PTHREADS
+    p->mStaleness = staleness > 0 ? staleness : 0;
+    pthread_mutex_init(&p->mLock, NULL);
+    pthread_cond_init(&p->mCond, NULL);
+#else
+    (void)staleness;
+    p->mStaleness = 0;
+#endif
+    p->mSlots = p->mStaleness + 1;
+    p->mNumLayers = numLayers;
+
+    const int slots = p->mSlots;
+    p->mLayers = (intnn_fc_layer**)malloc(sizeof(intnn_fc_layer*) * numLayers);
+    p->mInputs = (intnn_mat**)malloc(sizeof(intnn_mat*) * slots);
+    p->mOutputs = (intnn_mat**)malloc(sizeof(intnn_mat*) * numLayers * slots);
+    p->mGradInvs = (intnn_mat**)malloc(sizeof(intnn_mat*) * numLayers * slots);
+    p->mGradCodes = (intnn_tmat**)malloc(sizeof(intnn_tmat*) * numLayers * slots);
+    p->mDeltas = (intnn_mat**)malloc(sizeof(intnn_mat*) * slots);
+    p->mOrigOutputs = (intnn_mat**)malloc(sizeof(intnn_mat*) * numLayers);
+    p->mOrigGradInvs = (intnn_mat**)malloc(sizeof(intnn_mat*) * numLayers);
+    p->mOrigGradCodes = (intnn_tmat**)malloc(sizeof(intnn_tmat*) * numLayers);
+    p->mScratch = (intnn_fc_stage_scratch*)malloc(sizeof(intnn_fc_stage_scratch) * numLayers);
+    p->mFwdDone = (int*)calloc(numLayers, sizeof(int));
+    p->mBwdDone = (int*)calloc(numLayers, sizeof(int));
+    if (!p->mLayers || !p->mInputs || !p->mOutputs || !p->mGradInvs || !p->mGradCodes || !p->mDeltas ||
+        !p->mOrigOutputs || !p->mOrigGradInvs || !p->mOrigGradCodes || !p->mScratch || !p->mFwdDone || !p->mBwdDone)
+        assert(0);
+
+    int k = 0;
+    for (intnn_fc_layer* l = first; l != NULL; l = l->mNext, ++k) {
+        p->mLayers[k] = l;
+        p->mOrigOutputs[k] = l->mOutput;
+        p->mOrigGradInvs[k] = l->mActvGradInv;
+        p->mOrigGradCodes[k] = l->mActvGradCode;
+        const bool coded = intnn_actv_has_grad_code(l->mActv);
+        for (int s = 0; s < slots; ++s) {
+            p->mOutputs[k * slots + s] = intnn_create_mat(maxBatch, l->mOutDim);
+            p->mGradInvs[k * slots + s] = coded ? NULL : intnn_create_mat(maxBatch, l->mOutDim);
+            p->mGradCodes[k * slots + s] = coded ? intnn_create_tmat(maxBatch, l->mOutDim, INTNN_DTYPE_UINT8) : NULL;
+        }
+        intnn_fc_stage_scratch* sc = &p->mScratch[k];
+        sc->mInter = intnn_create_mat(maxBatch, l->mOutDim);
+        sc->mDeltas = intnn_create_mat(maxBatch, l->mOutDim);
+        sc->mWeightUpdate = intnn_create_mat(l->mInDim, l->mOutDim);
+        sc->mBiasUpdate = intnn_create_mat(1, l->mOutDim);
+    }
+    for (int s = 0; s < slots; ++s) {
+        p->mInputs[s] = intnn_create_mat(maxBatch, first->mInDim);
+        p->mDeltas[s] = intnn_create_mat(maxBatch, last->mOutDim);
+    }
+
+    // 与 intnn_fc_backward 相同，从后往前初始化 DFA 反馈矩阵
+    for (k = numLayers - 2; k >= 0; --k)
+        intnn_fc_ensure_dfa_weight(p->mLayers[k], last->mOutDim);
+    return p;
+}
+
+static void intnn_fc_pipeline_destroy_mat(intnn_mat* mat) {
+    intnn_free_mat(mat);
+    free(mat);
+}
+
+void intnn_fc_pipeline_free(intnn_fc_pipeline* p) {
+    if (!p)
+        return;
+    const int slots = p->mSlots;
+    for (int k = 0; k < p->mNumLayers; ++k) {
+        for (int s = 0; s < slots; ++s) {
+            intnn_fc_pipeline_destroy_mat(p->mOutputs[k * slots + s]);
+            if (p->mGradInvs[k * slots + s])
+                intnn_fc_pipeline_destroy_mat(p->mGradInvs[k * slots + s]);
+            if (p->mGradCodes[k * slots + s])
+                intnn_free_tmat(p->mGradCodes[k * slots + s]);
+        }
+        intnn_fc_pipeline_destroy_mat(p->mScratch[k].mInter);
+        intnn_fc_pipeline_destroy_mat(p->mScratch[k].mDeltas);
+        intnn_fc_pipeline_destroy_mat(p->mScratch[k].mWeightUpdate);
+        intnn_fc_pipeline_destroy_mat(p->mScratch[k].mBiasUpdate);
+    }
+    for (int s = 0; s < slots; ++s) {
+        intnn_fc_pipeline_destroy_mat(p->mInputs[s]);
+        intnn_fc_pipeline_destroy_mat(p->mDeltas[s]);
+    }
+#ifdef INTNN_HAVE_PTHREADS
+    pthread_mutex_destroy(&p->mLock);
+    pthread_cond_destroy(&p->mCond);
+#endif
+    free(p->mLayers);
+    free(p->mInputs);
+    free(p->mOutputs);
+    free(p->mGradInvs);
+    free(p->mGradCodes);
+    free(p->mDeltas);
+    free(p->mOrigOutputs);
+    free(p->mOrigGradInvs);
+    free(p->mOrigGradCodes);
+    free(p->mScratch);
+    free(p->mFwdDone);
+    free(p->mBwdDone);
+    free(p);
+}
+
+int intnn_fc_pipeline_staleness(const intnn_fc_pipeline* p) {
+    return p ? p->mStaleness : 0;
+}
+
+static void intnn_fc_pipeline_swap_mat(intnn_mat** a, intnn_mat** b) {
+    intnn_mat* t = *a;
+    *a = *b;
+    *b = t;
+}
+
+// 交换第 k 层与本级的工作矩阵：运行前换入本级的，运行后换回层自己的（可能绑定在静态内存规划的 slab 上）
+static void intnn_fc_pipeline_swap_scratch(intnn_fc_pipeline* p, int k) {
+    intnn_fc_layer* layer = p->mLayers[k];
+    intnn_fc_stage_scratch* sc = &p->mScratch[k];
+    intnn_fc_pipeline_swap_mat(&layer->mInter, &sc->mInter);
+    intnn_fc_pipeline_swap_mat(&layer->mDeltas, &sc->mDeltas);
+    intnn_fc_pipeline_swap_mat(&layer->mWeightUpdate, &sc->mWeightUpdate);
+    intnn_fc_pipeline_swap_mat(&layer->mBiasUpdate, &sc->mBiasUpdate);
+}
+
+// 第 k 层对第 j 批做前向，输出与激活梯度写入第 j 批的槽
+static void intnn_fc_pipeline_forward(intnn_fc_pipeline* p, int k, int j) {
+    const int slot = j % p->mSlots;
+    intnn_fc_layer* layer = p->mLayers[k];
+    intnn_mat* x;
+    if (k == 0) {
+        x = p->mInputs[slot];
+        p->mInputFn(p->mCtx, j, x);
+    } else {
+        x = p->mOutputs[(k - 1) * p->mSlots + slot];
+    }
+    layer->mOutput = p->mOutputs[k * p->mSlots + slot];
+    layer->mActvGradInv = p->mGradInvs[k * p->mSlots + slot];
+    layer->mActvGradCode = p->mGradCodes[k * p->mSlots + slot];
+    intnn_fc_forward_layer(layer, x);
+}
+
+// 第 k 层应用第 i 批的更新，使用该批前向时保存的输入与激活梯度
+static void intnn_fc_pipeline_backward(intnn_fc_pipeline* p, int k, int i) {
+    const int slot = i % p->mSlots;
+    intnn_fc_layer* layer = p->mLayers[k];
+    const intnn_mat* input = k == 0 ? p->mInputs[slot] : p->mOutputs[(k - 1) * p->mSlots + slot];
+    layer->mActvGradInv = p->mGradInvs[k * p->mSlots + slot];
+    layer->mActvGradCode = p->mGradCodes[k * p->mSlots + slot];
+    intnn_fc_backward_layer(layer, input, p->mDeltas[slot], p->mLrInv);
+}
+
+// 第 j 批的误差由最后一层输出计算
+static void intnn_fc_pipeline_loss(intnn_fc_pipeline* p, int j) {
+    const int slot = j % p->mSlots;
+    const int k = p->mNumLayers - 1;
+    p->mLossFn(p->mCtx, j, p->mOutputs[k * p->mSlots + slot], p->mDeltas[slot]);
+}
+
+#ifdef INTNN_HAVE_PTHREADS
+
+typedef struct {
+    intnn_fc_pipeline* mPipeline;
+    int mStage;
+} intnn_fc_stage_arg;
+
+static int intnn_fc_pipeline_min_bwd(const intnn_fc_pipeline* p) {
+    int m = p->mBwdDone[0];
+    for (int k = 1; k < p->mNumLayers; ++k)
+        if (p->mBwdDone[k] < m)
+            m = p->mBwdDone[k];
+    return m;
+}
+
+// 应用第 k 层下一批的更新（等待该批误差就绪）
+static void intnn_fc_pipeline_apply_next(intnn_fc_pipeline* p, int k) {
+    const int i = p->mBwdDone[k]; // 只有本级线程写 mBwdDone[k]
+    pthread_mutex_lock(&p->mLock);
+    while (p->mLossDone <= i)
+        pthread_cond_wait(&p->mCond, &p->mLock);
+    pthread_mutex_unlock(&p->mLock);
+
+    intnn_fc_pipeline_backward(p, k, i);
+
+    pthread_mutex_lock(&p->mLock);
+    p->mBwdDone[k] = i + 1;
+    pthread_cond_broadcast(&p->mCond);
+    pthread_mutex_unlock(&p->mLock);
+}
+
+static void* intnn_fc_pipeline_stage(void* arg) {
+    const intnn_fc_stage_arg* sa = (const intnn_fc_stage_arg*)arg;
+    intnn_fc_pipeline* p = sa->mPipeline;
+    const int k = sa->mStage;
+    const int last = p->mNumLayers - 1;
+    const int S = p->mStaleness;
+    const int N = p->mNumBatches;
+
+    for (int j = 0; j < N; ++j) {
+        // 前向第 j 批之前恰好应用到第 j-1-S 批的更新
+        while (p->mBwdDone[k] < j - S)
+            intnn_fc_pipeline_apply_next(p, k);
+
+        // 等待输入就绪，且下一层已用完该槽的上一任（第 j-1-S 批）
+        pthread_mutex_lock(&p->mLock);
+        while ((k > 0 && p->mFwdDone[k - 1] <= j) || (k < last && p->mBwdDone[k + 1] < j - S))
+            pthread_cond_wait(&p->mCond, &p->mLock);
+        pthread_mutex_unlock(&p->mLock);
+
+        intnn_fc_pipeline_forward(p, k, j);
+
+        pthread_mutex_lock(&p->mLock);
+        p->mFwdDone[k] = j + 1;
+        pthread_cond_broadcast(&p->mCond);
+        pthread_mutex_unlock(&p->mLock);
+
+        if (k == last) {
+            // 误差槽的上一任（第 j-1-S 批）须已被所有层用完
+            pthread_mutex_lock(&p->mLock);
+            while (intnn_fc_pipeline_min_bwd(p) < j - S)
+                pthread_cond_wait(&p->mCond, &p->mLock);
+            pthread_mutex_unlock(&p->mLock);
+
+            intnn_fc_pipeline_loss(p, j);
+
+            pthread_mutex_lock(&p->mLock);
+            p->mLossDone = j + 1;
+            pthread_cond_broadcast(&p->mCond);
+            pthread_mutex_unlock(&p->mLock);
+        }
+    }
+    while (p->mBwdDone[k] < N)
+        intnn_fc_pipeline_apply_next(p, k);
+    return NULL;
+}
+
+#endif // INTNN_HAVE_PTHREADS
+
+void intnn_fc_pipeline_run(intnn_fc_pipeline* p, int numBatches, int lrInv,
+                           intnn_pipeline_input_fn input, intnn_pipeline_loss_fn loss, void* ctx) {
+    if (!p || !input || !loss)
+        assert(0);
+    if (numBatches <= 0)
+        return;
+
+    p->mNumBatches = numBatches;
+    p->mLrInv = lrInv;
+    p->mInputFn = input;
+    p->mLossFn = loss;
+    p->mCtx = ctx;
+    p->mLossDone = 0;
+    for (int k = 0; k < p->mNumLayers; ++k) {
+        p->mFwdDone[k] = p->mBwdDone[k] = 0;
+        intnn_fc_pipeline_swap_scratch(p, k);
+    }
+
+#ifdef INTNN_HAVE_PTHREADS
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * p->mNumLayers);
+    intnn_fc_stage_arg* args = (intnn_fc_stage_arg*)malloc(sizeof(intnn_fc_stage_arg) * p->mNumLayers);
+    if (!threads || !args)
+        assert(0);
+    for (int k = 0; k < p->mNumLayers; ++k) {
+        args[k].mPipeline = p;
+        args[k].mStage = k;
+        if (pthread_create(&threads[k], NULL, intnn_fc_pipeline_stage, &args[k]) != 0)
+            assert(0);
+    }
+    for (int k = 0; k < p->mNumLayers; ++k)
+        pthread_join(threads[k], NULL);
+    free(threads);
+    free(args);
+#else
+    // 串行：逐批前向、计算误差、从后往前更新
+    for (int j = 0; j < numBatches; ++j) {
+        for (int k = 0; k < p->mNumLayers; ++k)
+            intnn_fc_pipeline_forward(p, k, j);
+        intnn_fc_pipeline_loss(p, j);
+        for (int k = p->mNumLayers - 1; k >= 0; --k)
+            intnn_fc_pipeline_backward(p, k, j);
+    }
+#endif
+
+    // 各层恢复自己的工作矩阵；mInput 指向的环形缓冲不再代表当前输入
+    for (int k = 0; k < p->mNumLayers; ++k) {
+        intnn_fc_layer* layer = p->mLayers[k];
+        layer->mOutput = p->mOrigOutputs[k];
+        layer->mActvGradInv = p->mOrigGradInvs[k];
+        layer->mActvGradCode = p->mOrigGradCodes[k];
+        intnn_fc_pipeline_swap_scratch(p, k);
+        if (!layer->mCopyInput)
+            layer->mInput = NULL;
+    }
+}
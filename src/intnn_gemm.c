@@ -0,0 +1,414 @@
+#include "intnn_gemm.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intnn_arena.h"
+#include "intnn_gemm_kernels.h"
+#include "intnn_thread_pool.h"
+#include "intnn_tools.h"
+
+#define MR INTNN_GEMM_MR
+#define NR INTNN_GEMM_NR
+
+// 读取操作数逻辑第 r 行从 c 列起的 n 个元素，符号扩展后按 uint32 存放
+// 转置操作数的逻辑行即存储的一列，按行跨度跳读
+static void intnn_gemm_load(uint32_t* dst, const intnn_gemm_operand* op, int r, int c, int n) {
+    size_t offset = op->mTrans ? (size_t)c * op->mStride + r : (size_t)r * op->mStride + c;
+    size_t step = op->mTrans ? (size_t)op->mStride : 1;
+    switch (op->mType) {
+        case INTNN_DTYPE_INT8: {
+            const int8_t* src = (const int8_t*)op->mData + offset;
+            for (int j = 0; j < n; ++j)
+                dst[j] = (uint32_t)(int32_t)src[j * step];
+            break;
+        }
+        case INTNN_DTYPE_UINT8: {
+            const uint8_t* src = (const uint8_t*)op->mData + offset;
+            for (int j = 0; j < n; ++j)
+                dst[j] = (uint32_t)src[j * step];
+            break;
+        }
+        case INTNN_DTYPE_INT16: {
+            const int16_t* src = (const int16_t*)op->mData + offset;
+            for (int j = 0; j < n; ++j)
+                dst[j] = (uint32_t)(int32_t)src[j * step];
+            break;
+        }
+        default: {
+            const int32_t* src = (const int32_t*)op->mData + offset;
+            if (step == 1) {
+                for (int j = 0; j < n; ++j)
+                    dst[j] = (uint32_t)src[j];
+            } else {
+                for (int j = 0; j < n; ++j)
+                    dst[j] = (uint32_t)src[j * step];
+            }
+            break;
+        }
+    }
+}
+
+// 每种面板格式一个 k 步包含的 k 数
+static int intnn_gemm_group(intnn_gemm_panel panel) {
+    switch (panel) {
+        case INTNN_GEMM_PANEL_I16X2:
+            return 2;
+        case INTNN_GEMM_PANEL_U8S8X4:
+            return 4;
+        default:
+            return 1;
+    }
+}
+
+// 把相邻 k 的 g 个值压成一个 32 位单元（低位对应较小的 k）
+static uint32_t intnn_gemm_combine(intnn_gemm_panel panel, const uint32_t* v, size_t step) {
+    switch (panel) {
+        case INTNN_GEMM_PANEL_I16X2:
+            return (v[0] & 0xFFFFu) | (v[step] & 0xFFFFu) << 16;
+        case INTNN_GEMM_PANEL_U8S8X4:
+            return (v[0] & 0xFFu) | (v[step] & 0xFFu) << 8 |
+                   (v[2 * step] & 0xFFu) << 16 | (v[3 * step] & 0xFFu) << 24;
+        default:
+            return v[0];
+    }
+}
+
+// 打包 A 的 mc x kc 块（起点 (i0, p0)）：每 MR 行为一个面板，面板内按 k 步优先存放，不足 MR 行、不足一组的 k 补零
+static void intnn_gemm_pack_a(uint32_t* buf, intnn_gemm_panel panel, const intnn_gemm_operand* a,
+                              int i0, int p0, int mc, int kc) {
+    const int g = intnn_gemm_group(panel);
+    const int steps = (kc + g - 1) / g;
+    uint32_t row[INTNN_GEMM_KC + 4];
+    for (int ir = 0; ir < mc; ir += MR) {
+        int mr = intnn_min(MR, mc - ir);
+        for (int i = 0; i < MR; ++i) {
+            if (i < mr) {
+                intnn_gemm_load(row, a, i0 + ir + i, p0, kc);
+                for (int k = kc; k < steps * g; ++k)
+                    row[k] = 0;
+            } else {
+                memset(row, 0, sizeof(uint32_t) * steps * g);
+            }
+            for (int s = 0; s < steps; ++s)
+                buf[s * MR + i] = intnn_gemm_combine(panel, row + s * g, 1);
+        }
+        buf += (size_t)MR * steps;
+    }
+}
+
+// 打包 B 的 kc x nc 块（起点 (p0, j0)）：每 NR 列为一个面板，面板内按 k 步优先存放，不足 NR 列、不足一组的 k 补零
+static void intnn_gemm_pack_b(uint32_t* buf, intnn_gemm_panel panel, const intnn_gemm_operand* b,
+                              int p0, int j0, int kc, int nc) {
+    const int g = intnn_gemm_group(panel);
+    const int steps = (kc + g - 1) / g;
+    uint32_t rows[4][NR];
+    for (int jr = 0; jr < nc; jr += NR) {
+        int nr = intnn_min(NR, nc - jr);
+        for (int s = 0; s < steps; ++s) {
+            for (int t = 0; t < g; ++t) {
+                int k = s * g + t;
+                if (k < kc) {
+                    intnn_gemm_load(rows[t], b, p0 + k, j0 + jr, nr);
+                    for (int j = nr; j < NR; ++j)
+                        rows[t][j] = 0;
+                } else {
+                    memset(rows[t], 0, sizeof(rows[t]));
+                }
+            }
+            for (int j = 0; j < NR; ++j)
+                buf[j] = intnn_gemm_combine(panel, &rows[0][j], NR);
+            buf += NR;
+        }
+    }
+}
+
+// 标量微块：tile(MR x NR) = Σk pa[k] ⊗ pb[k]，在 uint32 上回绕累加
+static void intnn_gemm_ukernel_scalar_i32(int steps, const uint32_t* pa, const uint32_t* pb, uint32_t tile[MR][NR]) {
+    uint32_t acc[MR][NR] = {{0}};
+    for (int k = 0; k < steps; ++k) {
+        for (int i = 0; i < MR; ++i) {
+            uint32_t av = pa[i];
+            for (int j = 0; j < NR; ++j)
+                acc[i][j] += av * pb[j];
+        }
+        pa += MR;
+        pb += NR;
+    }
+    memcpy(tile, acc, sizeof(acc));
+}
+
+// ------------------------------
+// 微块选择
+// ------------------------------
+
+// 一组微块实现，按面板格式索引；NULL 表示该实现不支持此格式
+typedef struct {
+    const char* mName;
+    intnn_gemm_ukernel mKernels[INTNN_GEMM_PANEL_COUNT];
+} intnn_gemm_kernel_set;
+
+// 按优先级从低到高排列，自动选择时取最后一个 CPU 支持的
+static const intnn_gemm_kernel_set gKernelSets[] = {
+    { "scalar", { intnn_gemm_ukernel_scalar_i32, NULL, NULL } },
+#ifdef INTNN_GEMM_X86
+    { "avx2", { intnn_gemm_ukernel_avx2_i32, intnn_gemm_ukernel_avx2_i16x2, NULL } },
+    { "avx512vnni", { intnn_gemm_ukernel_avx512_i32, intnn_gemm_ukernel_avx512vnni_i16x2,
+                      intnn_gemm_ukernel_avx512vnni_u8s8x4 } },
+#endif
+};
+static const int gNumKernelSets = (int)(sizeof(gKernelSets) / sizeof(gKernelSets[0]));
+
+static const intnn_gemm_kernel_set* gActiveKernels = NULL;
+
+// 当前 CPU 是否支持第 idx 组微块
+static bool intnn_gemm_kernel_supported(int idx) {
+#ifdef INTNN_GEMM_X86
+    __builtin_cpu_init();
+    if (strcmp(gKernelSets[idx].mName, "avx2") == 0)
+        return __builtin_cpu_supports("avx2");
+    if (strcmp(gKernelSets[idx].mName, "avx512vnni") == 0)
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vnni");
+#endif
+    return idx == 0;
+}
+
+// 按名字查找微块组，未知或 CPU 不支持时返回 NULL
+static const intnn_gemm_kernel_set* intnn_gemm_find_kernel(const char* name) {
+    for (int i = 0; i < gNumKernelSets; ++i) {
+        if (strcmp(gKernelSets[i].mName, name) == 0)
+            return intnn_gemm_kernel_supported(i) ? &gKernelSets[i] : NULL;
+    }
+    return NULL;
+}
+
+bool intnn_gemm_set_kernel(const char* name) {
+    const intnn_gemm_kernel_set* ks = name ? intnn_gemm_find_kernel(name) : NULL;
+    if (!ks)
+        return false;
+    __atomic_store_n(&gActiveKernels, ks, __ATOMIC_RELEASE);
+    return true;
+}
+
+// 首次使用时选择：环境变量 INTNN_GEMM_KERNEL 优先，否则取 CPU 支持的最快实现。
+// 流水线各级、Hogwild 与评估的工作线程可能同时首次调用：各线程算出相同结果，
+// 由 CAS 发布，只有发布成功的线程打印环境变量无效的警告
+static const intnn_gemm_kernel_set* intnn_gemm_active_kernels(void) {
+    const intnn_gemm_kernel_set* active = __atomic_load_n(&gActiveKernels, __ATOMIC_ACQUIRE);
+    if (active)
+        return active;
+
+    const char* env = getenv("INTNN_GEMM_KERNEL");
+    const bool hasEnv = env && env[0];
+    const intnn_gemm_kernel_set* chosen = hasEnv ? intnn_gemm_find_kernel(env) : NULL;
+    const bool badEnv = hasEnv && !chosen;
+    for (int i = gNumKernelSets - 1; !chosen && i >= 0; --i) {
+        if (intnn_gemm_kernel_supported(i))
+            chosen = &gKernelSets[i];
+    }
+
+    if (!__atomic_compare_exchange_n(&gActiveKernels, &active, chosen, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        return active;  // 其他线程已先发布
+    if (badEnv)
+        printf("[WARN] INTNN_GEMM_KERNEL=%s is unknown or unsupported on this CPU, using auto\n", env);
+    return chosen;
+}
+
+const char* intnn_gemm_kernel_name(void) {
+    return intnn_gemm_active_kernels()->mName;
+}
+
+// 操作数逻辑 rows x cols 区域的取值范围；窄类型直接由类型给出，int32 需扫描
+static void intnn_gemm_operand_range(const intnn_gemm_operand* op, int rows, int cols, int* lo, int* hi) {
+    if (op->mType != INTNN_DTYPE_INT32) {
+        *lo = intnn_dtype_min(op->mType);
+        *hi = intnn_dtype_max(op->mType);
+        return;
+    }
+    if (op->mTrans) {
+        // 按存储布局扫描
+        int t = rows;
+        rows = cols;
+        cols = t;
+    }
+    int mn = 0, mx = 0;
+    for (int r = 0; r < rows; ++r) {
+        const int* row = (const int*)op->mData + (size_t)r * op->mStride;
+        for (int c = 0; c < cols; ++c) {
+            mn = row[c] < mn ? row[c] : mn;
+            mx = row[c] > mx ? row[c] : mx;
+        }
+        if (mn < INT16_MIN || mx > INT16_MAX)
+            break;  // 已超出 int16，其余行无需再看
+    }
+    *lo = mn;
+    *hi = mx;
+}
+
+// 按操作数取值范围选择最窄的可精确计算的面板格式
+static intnn_gemm_panel intnn_gemm_choose_panel(const intnn_gemm_kernel_set* set,
+                                                const intnn_gemm_operand* a, const intnn_gemm_operand* b,
+                                                int m, int n, int k) {
+    if (!set->mKernels[INTNN_GEMM_PANEL_I16X2] && !set->mKernels[INTNN_GEMM_PANEL_U8S8X4])
+        return INTNN_GEMM_PANEL_I32;
+
+    int loA, hiA, loB, hiB;
+    intnn_gemm_operand_range(a, m, k, &loA, &hiA);
+    if (loA < INT16_MIN || hiA > INT16_MAX)
+        return INTNN_GEMM_PANEL_I32;
+    intnn_gemm_operand_range(b, k, n, &loB, &hiB);
+
+    if (set->mKernels[INTNN_GEMM_PANEL_U8S8X4] &&
+        loA >= 0 && hiA <= UINT8_MAX && loB >= INT8_MIN && hiB <= INT8_MAX)
+        return INTNN_GEMM_PANEL_U8S8X4;
+    if (set->mKernels[INTNN_GEMM_PANEL_I16X2] && loB >= INT16_MIN && hiB <= INT16_MAX)
+        return INTNN_GEMM_PANEL_I16X2;
+    return INTNN_GEMM_PANEL_I32;
+}
+
+// 把微块写回 C（首个 K 块直接覆盖，其余累加），只写有效的 mr x nr 部分；
+// 最后一个 K 块写回后逐行调用 epilogue（起点为 C 的 (r0, c0)）
+static void intnn_gemm_store(int* c, int ldc, int mr, int nr, uint32_t tile[MR][NR], bool accumulate,
+                             const intnn_gemm_epilogue* epilogue, int r0, int c0) {
+    for (int i = 0; i < mr; ++i) {
+        int* row = c + (size_t)i * ldc;
+        if (accumulate) {
+            for (int j = 0; j < nr; ++j)
+                row[j] = (int)((uint32_t)row[j] + tile[i][j]);
+        } else {
+            for (int j = 0; j < nr; ++j)
+                row[j] = (int)tile[i][j];
+        }
+        if (epilogue)
+            epilogue->mFn(epilogue->mCtx, r0 + i, c0, row, nr);
+    }
+}
+
+void intnn_gemm(intnn_mat* out, const intnn_mat* a, const intnn_mat* b) {
+    assert(out && a && b);
+    assert(a->mCols == b->mRows);
+
+    intnn_gemm_trans(out, a, false, b, false);
+}
+
+void intnn_gemm_trans(intnn_mat* out, const intnn_mat* a, bool transA, const intnn_mat* b, bool transB) {
+    assert(out && a && b);
+    int k = transA ? a->mRows : a->mCols;
+    assert(k == (transB ? b->mCols : b->mRows));
+    assert(out->mRows == (transA ? a->mCols : a->mRows));
+    assert(out->mCols == (transB ? b->mRows : b->mCols));
+
+    intnn_gemm_operand opA = { a->mData, a->mStride, INTNN_DTYPE_INT32, transA };
+    intnn_gemm_operand opB = { b->mData, b->mStride, INTNN_DTYPE_INT32, transB };
+    intnn_gemm_ex(out, &opA, &opB, k, NULL);
+}
+
+// 一个 (jc, pc) 块内按输出行并行：B 面板共享，每个线程使用自己的 A 面板缓冲
+typedef struct {
+    intnn_mat* mOut;
+    const intnn_gemm_operand* mA;
+    intnn_gemm_panel mPanel;
+    intnn_gemm_ukernel mKernel;
+    const uint32_t* mPackB;
+    uint32_t* mPackA;           // 每线程一段，长度 mPackAElems
+    size_t mPackAElems;
+    int mJc;
+    int mPc;
+    int mNc;
+    int mKc;
+    int mSteps;
+    const intnn_gemm_epilogue* mEpi;
+} intnn_gemm_block;
+
+static void intnn_gemm_block_rows(void* ctx, int begin, int end, int tid) {
+    const intnn_gemm_block* blk = (const intnn_gemm_block*)ctx;
+    uint32_t* packA = blk->mPackA + (size_t)tid * blk->mPackAElems;
+    const int steps = blk->mSteps;
+    intnn_mat* out = blk->mOut;
+
+    uint32_t tile[MR][NR];
+    for (int ic = begin; ic < end; ic += INTNN_GEMM_MC) {
+        int mc = intnn_min(INTNN_GEMM_MC, end - ic);
+        intnn_gemm_pack_a(packA, blk->mPanel, blk->mA, ic, blk->mPc, mc, blk->mKc);
+
+        for (int jr = 0; jr < blk->mNc; jr += NR) {
+            int nr = intnn_min(NR, blk->mNc - jr);
+            for (int ir = 0; ir < mc; ir += MR) {
+                int mr = intnn_min(MR, mc - ir);
+                blk->mKernel(steps, packA + (size_t)ir * steps, blk->mPackB + (size_t)jr * steps, tile);
+                intnn_gemm_store(INTNN_MAT_ROW(out, ic + ir) + blk->mJc + jr, out->mStride,
+                                 mr, nr, tile, blk->mPc > 0, blk->mEpi, ic + ir, blk->mJc + jr);
+            }
+        }
+    }
+}
+
+void intnn_gemm_ex(intnn_mat* out, const intnn_gemm_operand* a, const intnn_gemm_operand* b, int k,
+                   const intnn_gemm_epilogue* epilogue) {
+    assert(out && a && b && k > 0);
+
+    const int m = out->mRows;
+    const int n = out->mCols;
+
+    // 每个线程至少分到 INTNN_GEMM_PARALLEL_MIN_MACS 次乘加，行数按 MR 对齐；小矩阵不并行
+    long long rowMacs = (long long)intnn_min(n, INTNN_GEMM_NC) * intnn_min(k, INTNN_GEMM_KC);
+    int grain = (int)((INTNN_GEMM_PARALLEL_MIN_MACS + rowMacs - 1) / rowMacs);
+    grain = (grain + MR - 1) / MR * MR;
+    const int parts = intnn_parallel_parts(m, grain);
+
+    // 打包缓冲按实际尺寸截断，小矩阵不必申请整块；A 面板每线程一段，各段起始对齐
+    const int mcMax = intnn_min(INTNN_GEMM_MC, (m + MR - 1) / MR * MR);
+    const int ncMax = intnn_min(INTNN_GEMM_NC, (n + NR - 1) / NR * NR);
+    const int kcMax = intnn_min(INTNN_GEMM_KC, k);
+    const size_t alignElems = INTNN_MAT_ALIGN / sizeof(uint32_t);
+    const size_t packAElems = ((size_t)mcMax * kcMax + alignElems - 1) / alignElems * alignElems;
+    // 绑定了内存池时打包缓冲从池中取，返回前回退，不占用堆
+    intnn_arena* arena = intnn_arena_active();
+    const size_t arenaMark = arena ? intnn_arena_mark(arena) : 0;
+    const size_t bytesA = sizeof(uint32_t) * packAElems * parts;
+    const size_t bytesB = sizeof(uint32_t) * (size_t)kcMax * ncMax;
+    uint32_t* packA = (uint32_t*)(arena ? intnn_arena_alloc(arena, bytesA) : intnn_aligned_alloc(bytesA));
+    uint32_t* packB = (uint32_t*)(arena ? intnn_arena_alloc(arena, bytesB) : intnn_aligned_alloc(bytesB));
+    if (!packA || !packB)
+        assert(0);
+
+    const intnn_gemm_kernel_set* set = intnn_gemm_active_kernels();
+    const intnn_gemm_panel panel = intnn_gemm_choose_panel(set, a, b, m, n, k);
+    const int g = intnn_gemm_group(panel);
+
+    intnn_gemm_block blk;
+    blk.mOut = out;
+    blk.mA = a;
+    blk.mPanel = panel;
+    blk.mKernel = set->mKernels[panel];
+    blk.mPackB = packB;
+    blk.mPackA = packA;
+    blk.mPackAElems = packAElems;
+
+    for (int jc = 0; jc < n; jc += INTNN_GEMM_NC) {
+        int nc = intnn_min(INTNN_GEMM_NC, n - jc);
+        for (int pc = 0; pc < k; pc += INTNN_GEMM_KC) {
+            int kc = intnn_min(INTNN_GEMM_KC, k - pc);
+            intnn_gemm_pack_b(packB, panel, b, pc, jc, kc, nc);
+
+            blk.mJc = jc;
+            blk.mPc = pc;
+            blk.mNc = nc;
+            blk.mKc = kc;
+            blk.mSteps = (kc + g - 1) / g;
+            blk.mEpi = (pc + kc == k) ? epilogue : NULL;
+            if (parts > 1)
+                intnn_parallel_for_max(m, grain, parts, intnn_gemm_block_rows, &blk);
+            else
+                intnn_gemm_block_rows(&blk, 0, m, 0);
+        }
+    }
+
+    if (arena) {
+        intnn_arena_rewind(arena, arenaMark);
+    } else {
+        intnn_aligned_free(packA);
+        intnn_aligned_free(packB);
+    }
+}
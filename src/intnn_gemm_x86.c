@@ -0,0 +1,119 @@
+#include "intnn_gemm_kernels.h"
+
+#ifdef INTNN_GEMM_X86
+
+#include <immintrin.h>
+
+#define MR INTNN_GEMM_MR
+#define NR INTNN_GEMM_NR
+
+// 以下函数各自带 target 属性，整个文件无需额外编译选项；只有 CPU 支持时才会被调用
+
+// AVX2：int32 面板，vpmulld 逐元素相乘后累加（低 32 位回绕，与标量一致）
+__attribute__((target("avx2")))
+void intnn_gemm_ukernel_avx2_i32(int steps, const uint32_t* pa, const uint32_t* pb, uint32_t tile[MR][NR]) {
+    __m256i acc[MR][2];
+    for (int i = 0; i < MR; ++i)
+        acc[i][0] = acc[i][1] = _mm256_setzero_si256();
+
+    for (int k = 0; k < steps; ++k) {
+        __m256i b0 = _mm256_loadu_si256((const __m256i*)pb);
+        __m256i b1 = _mm256_loadu_si256((const __m256i*)(pb + 8));
+        for (int i = 0; i < MR; ++i) {
+            __m256i a = _mm256_set1_epi32((int)pa[i]);
+            acc[i][0] = _mm256_add_epi32(acc[i][0], _mm256_mullo_epi32(a, b0));
+            acc[i][1] = _mm256_add_epi32(acc[i][1], _mm256_mullo_epi32(a, b1));
+        }
+        pa += MR;
+        pb += NR;
+    }
+
+    for (int i = 0; i < MR; ++i) {
+        _mm256_storeu_si256((__m256i*)tile[i], acc[i][0]);
+        _mm256_storeu_si256((__m256i*)(tile[i] + 8), acc[i][1]);
+    }
+}
+
+// AVX2：int16 成对面板，vpmaddwd 一次完成两个 k 的乘加
+__attribute__((target("avx2")))
+void intnn_gemm_ukernel_avx2_i16x2(int steps, const uint32_t* pa, const uint32_t* pb, uint32_t tile[MR][NR]) {
+    __m256i acc[MR][2];
+    for (int i = 0; i < MR; ++i)
+        acc[i][0] = acc[i][1] = _mm256_setzero_si256();
+
+    for (int k = 0; k < steps; ++k) {
+        __m256i b0 = _mm256_loadu_si256((const __m256i*)pb);
+        __m256i b1 = _mm256_loadu_si256((const __m256i*)(pb + 8));
+        for (int i = 0; i < MR; ++i) {
+            __m256i a = _mm256_set1_epi32((int)pa[i]);
+            acc[i][0] = _mm256_add_epi32(acc[i][0], _mm256_madd_epi16(a, b0));
+            acc[i][1] = _mm256_add_epi32(acc[i][1], _mm256_madd_epi16(a, b1));
+        }
+        pa += MR;
+        pb += NR;
+    }
+
+    for (int i = 0; i < MR; ++i) {
+        _mm256_storeu_si256((__m256i*)tile[i], acc[i][0]);
+        _mm256_storeu_si256((__m256i*)(tile[i] + 8), acc[i][1]);
+    }
+}
+
+// AVX-512：int32 面板，一行 NR=16 正好一个 zmm
+__attribute__((target("avx512f")))
+void intnn_gemm_ukernel_avx512_i32(int steps, const uint32_t* pa, const uint32_t* pb, uint32_t tile[MR][NR]) {
+    __m512i acc[MR];
+    for (int i = 0; i < MR; ++i)
+        acc[i] = _mm512_setzero_si512();
+
+    for (int k = 0; k < steps; ++k) {
+        __m512i b = _mm512_loadu_si512((const void*)pb);
+        for (int i = 0; i < MR; ++i)
+            acc[i] = _mm512_add_epi32(acc[i], _mm512_mullo_epi32(_mm512_set1_epi32((int)pa[i]), b));
+        pa += MR;
+        pb += NR;
+    }
+
+    for (int i = 0; i < MR; ++i)
+        _mm512_storeu_si512((void*)tile[i], acc[i]);
+}
+
+// AVX-512 VNNI：int16 成对面板，vpdpwssd 融合乘加（不饱和，回绕）
+__attribute__((target("avx512f,avx512vnni")))
+void intnn_gemm_ukernel_avx512vnni_i16x2(int steps, const uint32_t* pa, const uint32_t* pb, uint32_t tile[MR][NR]) {
+    __m512i acc[MR];
+    for (int i = 0; i < MR; ++i)
+        acc[i] = _mm512_setzero_si512();
+
+    for (int k = 0; k < steps; ++k) {
+        __m512i b = _mm512_loadu_si512((const void*)pb);
+        for (int i = 0; i < MR; ++i)
+            acc[i] = _mm512_dpwssd_epi32(acc[i], _mm512_set1_epi32((int)pa[i]), b);
+        pa += MR;
+        pb += NR;
+    }
+
+    for (int i = 0; i < MR; ++i)
+        _mm512_storeu_si512((void*)tile[i], acc[i]);
+}
+
+// AVX-512 VNNI：uint8 x int8 四元组面板，vpdpbusd 一次完成四个 k 的乘加（不饱和）
+__attribute__((target("avx512f,avx512vnni")))
+void intnn_gemm_ukernel_avx512vnni_u8s8x4(int steps, const uint32_t* pa, const uint32_t* pb, uint32_t tile[MR][NR]) {
+    __m512i acc[MR];
+    for (int i = 0; i < MR; ++i)
+        acc[i] = _mm512_setzero_si512();
+
+    for (int k = 0; k < steps; ++k) {
+        __m512i b = _mm512_loadu_si512((const void*)pb);
+        for (int i = 0; i < MR; ++i)
+            acc[i] = _mm512_dpbusd_epi32(acc[i], _mm512_set1_epi32((int)pa[i]), b);
+        pa += MR;
+        pb += NR;
+    }
+
+    for (int i = 0; i < MR; ++i)
+        _mm512_storeu_si512((void*)tile[i], acc[i]);
+}
+
+#endif // INTNN_GEMM_X86
@@ -186,26 +186,34 @@ void intnn_parse_dataset_diabetes(intnn_mat* outMat, const char* filename) {
 // 加载 MNIST/Fashion-MNIST 图像
 // ------------------------------
 
-// 辅助：从 idx3-ubyte 文件加载 numToLoad 张图像到 outMat
-static void intnn_load_idx3_images(intnn_mat* outMat, const char* filepath, int numToLoad) {
+// 辅助：打开 idx3-ubyte 文件并读取 header（魔数、项目数、行数、列数，4 个 32bit big-endian）
+static FILE* intnn_open_idx3(const char* filepath, int* numRows, int* numCols) {
     FILE* fp = fopen(filepath, "rb");
     if (!fp) {
         printf("Failed to open %s\n", filepath);
-        return;
+        return NULL;
     }
-    // 读 header：魔数、项目数、行数、列数（4 个 32bit big-endian）
-    int magic = 0, numItems = 0, numRows = 0, numCols = 0;
+    int magic = 0, numItems = 0;
     fread(&magic, sizeof(int), 1, fp);
     fread(&numItems, sizeof(int), 1, fp);
-    fread(&numRows, sizeof(int), 1, fp);
-    fread(&numCols, sizeof(int), 1, fp);
+    fread(numRows, sizeof(int), 1, fp);
+    fread(numCols, sizeof(int), 1, fp);
     magic = intnn_reverse_int(magic);
     numItems = intnn_reverse_int(numItems);
-    numRows = intnn_reverse_int(numRows);
-    numCols = intnn_reverse_int(numCols);
+    *numRows = intnn_reverse_int(*numRows);
+    *numCols = intnn_reverse_int(*numCols);
 
     printf("Loading %s: magic=%d, items=%d, rows=%d, cols=%d\n",
-           filepath, magic, numItems, numRows, numCols);
+           filepath, magic, numItems, *numRows, *numCols);
+    return fp;
+}
+
+// 辅助：从 idx3-ubyte 文件加载 numToLoad 张图像到 outMat
+static void intnn_load_idx3_images(intnn_mat* outMat, const char* filepath, int numToLoad) {
+    int numRows = 0, numCols = 0;
+    FILE* fp = intnn_open_idx3(filepath, &numRows, &numCols);
+    if (!fp)
+        return;
 
     // 初始化 outMat: numToLoad x (numRows*numCols)
     intnn_reset_zero(outMat, numToLoad, numRows * numCols);
@@ -224,6 +232,28 @@ static void intnn_load_idx3_images(intnn_mat* outMat, const char* filepath, int
     printf("Loaded %d images from %s\n", numToLoad, filepath);
 }
 
+// 辅助：从 idx3-ubyte 文件加载 numToLoad 张图像到 UINT8 矩阵，像素按行直接读入
+static void intnn_load_idx3_images_tmat(intnn_tmat* outMat, const char* filepath, int numToLoad) {
+    int numRows = 0, numCols = 0;
+    FILE* fp = intnn_open_idx3(filepath, &numRows, &numCols);
+    if (!fp)
+        return;
+
+    int dim = numRows * numCols;
+    intnn_tmat_reset_zero(outMat, numToLoad, dim, INTNN_DTYPE_UINT8);
+
+    for (int i = 0; i < numToLoad; i++) {
+        uint8_t* row = (uint8_t*)outMat->mData + (size_t)i * outMat->mStride;
+        if (fread(row, sizeof(uint8_t), dim, fp) != (size_t)dim) {
+            printf("Unexpected end of file in %s\n", filepath);
+            break;
+        }
+    }
+    fclose(fp);
+
+    printf("Loaded %d images from %s\n", numToLoad, filepath);
+}
+
 void intnn_load_mnist_images(intnn_mat* outMat, int numImagesToLoad, bool isTrain) {
     const char* filepath = isTrain
         ? "dataset/mnist/train-images.idx3-ubyte"
@@ -231,6 +261,13 @@ void intnn_load_mnist_images(intnn_mat* outMat, int numImagesToLoad, bool isTrai
     intnn_load_idx3_images(outMat, filepath, numImagesToLoad);
 }
 
+void intnn_load_mnist_images_tmat(intnn_tmat* outMat, int numImagesToLoad, bool isTrain) {
+    const char* filepath = isTrain
+        ? "dataset/mnist/train-images.idx3-ubyte"
+        : "dataset/mnist/t10k-images.idx3-ubyte";
+    intnn_load_idx3_images_tmat(outMat, filepath, numImagesToLoad);
+}
+
 void intnn_load_fashion_mnist_images(intnn_mat* outMat, int numImagesToLoad, bool isTrain) {
     const char* filepath = isTrain
         ? "dataset/fashion_mnist/train-images-idx3-ubyte"
@@ -238,6 +275,13 @@ void intnn_load_fashion_mnist_images(intnn_mat* outMat, int numImagesToLoad, boo
     intnn_load_idx3_images(outMat, filepath, numImagesToLoad);
 }
 
+void intnn_load_fashion_mnist_images_tmat(intnn_tmat* outMat, int numImagesToLoad, bool isTrain) {
+    const char* filepath = isTrain
+        ? "dataset/fashion_mnist/train-images-idx3-ubyte"
+        : "dataset/fashion_mnist/t10k-images-idx3-ubyte";
+    intnn_load_idx3_images_tmat(outMat, filepath, numImagesToLoad);
+}
+
 // ------------------------------
 // 加载 MNIST/Fashion-MNIST 标签
 // ------------------------------
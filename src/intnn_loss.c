@@ -1,5 +1,6 @@
 #include "intnn_loss.h"
 #include <assert.h>
+#include <string.h>
 
 int intnn_scalar_l2_loss(int y, int yHat) {
     int diff = yHat - y;
@@ -150,3 +151,127 @@ int intnn_batch_cross_entropy_loss_delta(intnn_mat* delta_mat, const intnn_mat*
     }
     return sumDelta;
 }
+
+// 各损失类型的逐元素规则与上面的分步实现一致：
+// L2 每个元素都有损失与误差；口袋交叉熵与交叉熵只在目标类（INT_MAX / 1）处有，其余误差为 0
+intnn_loss_result intnn_batch_loss_fused(intnn_mat* deltaMat, const intnn_mat* yMat, const intnn_mat* yHatMat,
+                                         intnn_loss_type type) {
+    if (!intnn_dims_equal(yMat, yHatMat)) {
+        printf("yMat size: (%d, %d)\n", yMat->mRows, yMat->mCols);
+        printf("yHatMat size: (%d, %d)\n", yHatMat->mRows, yHatMat->mCols);
+        assert(0);
+    }
+    const int rows = yHatMat->mRows;
+    const int cols = yHatMat->mCols;
+    if (deltaMat && !intnn_dims_equal(deltaMat, yHatMat))
+        intnn_resize(deltaMat, rows, cols);   // 每个元素都会写入，无需清零
+
+    intnn_loss_result result = { 0, 0 };
+    for (int r = 0; r < rows; ++r) {
+        const int* y = INTNN_MAT_ROW(yMat, r);
+        const int* yHat = INTNN_MAT_ROW(yHatMat, r);
+        int* delta = deltaMat ? INTNN_MAT_ROW(deltaMat, r) : NULL;
+        unsigned rowLoss = 0;   // 口袋交叉熵每个目标类的损失接近 INT_MAX，按补码回绕累加（同分步实现的结果）
+        int maxPredIdx = 0;
+        int maxTargetIdx = 0;
+
+        for (int c = 0; c < cols; ++c) {
+            int d = 0;
+            switch (type) {
+                case INTNN_LOSS_L2:
+                    rowLoss += (unsigned)intnn_scalar_l2_loss(y[c], yHat[c]);
+                    d = intnn_scalar_l2_loss_delta(y[c], yHat[c]);
+                    break;
+                case INTNN_LOSS_POCKET_CROSS:
+                    if (y[c] == INT_MAX) {
+                        rowLoss += (unsigned)(INT_MAX - yHat[c]);
+                        d = -1;
+                    }
+                    break;
+                case INTNN_LOSS_CROSS_ENTROPY:
+                    if (y[c] == 1) {
+                        d = yHat[c] - INTNN_MAX;
+                        rowLoss += (unsigned)((d * d) / 2);
+                    }
+                    break;
+                default:
+                    printf("Unsupported loss type\n");
+                    assert(0);
+            }
+            if (delta)
+                delta[c] = d;
+            // 与 intnn_count_max_match 相同：并列时取最靠前的位置
+            if (yHat[c] > yHat[maxPredIdx])
+                maxPredIdx = c;
+            if (y[c] > y[maxTargetIdx])
+                maxTargetIdx = c;
+        }
+        result.mLoss = (int)((unsigned)result.mLoss + rowLoss);
+        result.mCorrect += (maxPredIdx == maxTargetIdx);
+    }
+    return result;
+}
+
+// 与 intnn_batch_loss_fused 对 one-hot 目标的结果相同；非目标类的目标值为 0，
+// 口袋交叉熵与交叉熵在这些位置既无损失也无误差，只需处理目标类
+intnn_loss_result intnn_batch_loss_fused_labels(intnn_mat* deltaMat, const intnn_mat* yHatMat, const int* labels,
+                                                const int* indices, int target, intnn_loss_type type) {
+    if (!yHatMat || !labels || (type == INTNN_LOSS_L2 && target <= 0))
+        assert(0);
+    const int rows = yHatMat->mRows;
+    const int cols = yHatMat->mCols;
+    if (deltaMat && !intnn_dims_equal(deltaMat, yHatMat))
+        intnn_resize(deltaMat, rows, cols);
+
+    intnn_loss_result result = { 0, 0 };
+    for (int r = 0; r < rows; ++r) {
+        const int label = labels[indices ? indices[r] : r];
+        if (label < 0 || label >= cols) {
+            printf("label %d out of range [0, %d)\n", label, cols);
+            assert(0);
+        }
+        const int* yHat = INTNN_MAT_ROW(yHatMat, r);
+        int* delta = deltaMat ? INTNN_MAT_ROW(deltaMat, r) : NULL;
+        unsigned rowLoss = 0;
+
+        switch (type) {
+            case INTNN_LOSS_L2:
+                for (int c = 0; c < cols; ++c) {
+                    const int y = (c == label) ? target : 0;
+                    rowLoss += (unsigned)intnn_scalar_l2_loss(y, yHat[c]);
+                    if (delta)
+                        delta[c] = intnn_scalar_l2_loss_delta(y, yHat[c]);
+                }
+                break;
+            case INTNN_LOSS_POCKET_CROSS:
+                rowLoss = (unsigned)(INT_MAX - yHat[label]);
+                if (delta) {
+                    memset(delta, 0, sizeof(int) * cols);
+                    delta[label] = -1;
+                }
+                break;
+            case INTNN_LOSS_CROSS_ENTROPY: {
+                const int d = yHat[label] - INTNN_MAX;
+                rowLoss = (unsigned)((d * d) / 2);
+                if (delta) {
+                    memset(delta, 0, sizeof(int) * cols);
+                    delta[label] = d;
+                }
+                break;
+            }
+            default:
+                printf("Unsupported loss type\n");
+                assert(0);
+        }
+        result.mLoss = (int)((unsigned)result.mLoss + rowLoss);
+
+        // 目标类取值为正、其余为 0，one-hot 行的最大值位置就是 label
+        int maxPredIdx = 0;
+        for (int c = 1; c < cols; ++c) {
+            if (yHat[c] > yHat[maxPredIdx])
+                maxPredIdx = c;
+        }
+        result.mCorrect += (maxPredIdx == label);
+    }
+    return result;
+}
@@ -1,9 +1,100 @@
 #include "intnn_mat.h"
+#include "intnn_arena.h"
+#include "intnn_gemm.h"
+#include "intnn_thread_pool.h"
+#include "intnn_tools.h"
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+// 计算行跨度：列数向上取整到 INTNN_MAT_ALIGN 字节，使每行起始地址对齐
+static int intnn_aligned_stride(int cols) {
+    const int unit = INTNN_MAT_ALIGN / (int)sizeof(int);
+    return (cols + unit - 1) / unit * unit;
+}
+
+// 分配一整块对齐存储：数据区在前，行指针兼容层在后，数据清零
+// 绑定了内存池时从池中分配，此时矩阵不拥有存储（释放时不归还堆，随池重置失效）
+static bool intnn_alloc_storage(intnn_mat* mat, int rows, int cols) {
+    int stride = intnn_aligned_stride(cols);
+    size_t dataBytes = (size_t)rows * stride * sizeof(int);
+    size_t blockBytes = dataBytes + (size_t)rows * sizeof(int*);
+    intnn_arena* arena = intnn_arena_active();
+    char* block = arena ? (char*)intnn_arena_alloc(arena, blockBytes) : (char*)intnn_aligned_alloc(blockBytes);
+    if (!block)
+        return false;
+    memset(block, 0, dataBytes);
+    mat->mDeleteOnDestruct = (arena == NULL);
+
+    mat->mRows = rows;
+    mat->mCols = cols;
+    mat->mStride = stride;
+    mat->mCapRows = arena ? 0 : rows; // 池内存随池重置失效，不参与容量复用
+    mat->mData = (int*)block;
+    mat->mMat = (int**)(block + dataBytes);
+    for (int r = 0; r < rows; ++r)
+        mat->mMat[r] = mat->mData + (size_t)r * stride;
+    return true;
+}
+
+// 释放存储（仅当矩阵拥有该存储时），并清空指针防止重复释放
+static void intnn_release_storage(intnn_mat* mat) {
+    if (mat->mDeleteOnDestruct && mat->mData)
+        intnn_aligned_free(mat->mData);
+    mat->mData = NULL;
+    mat->mMat = NULL;
+    mat->mCapRows = 0;
+}
+
+// 已有存储能否容纳 rows x cols（自有存储和 intnn_bind_storage 绑定的存储按容量复用；视图与池内存容量为 0，总是重新分配）
+static bool intnn_fits_storage(const intnn_mat* mat, int rows, int cols) {
+    return mat->mData && rows <= mat->mCapRows && cols <= mat->mStride;
+}
+
+size_t intnn_storage_bytes(int rows, int cols) {
+    return (size_t)rows * intnn_aligned_stride(cols) * sizeof(int);
+}
+
+// 绑定外部存储（如静态内存规划的大块内存）：矩阵不拥有存储，行数不超过 capRows 时调整尺寸原地复用
+void intnn_bind_storage(intnn_mat* mat, int* data, int capRows, int cols) {
+    if (!mat || !data || capRows <= 0 || cols <= 0)
+        assert(0);
+    if ((size_t)data % INTNN_MAT_ALIGN != 0) {
+        printf("[WARN] bind_storage: data is not %d-byte aligned\n", INTNN_MAT_ALIGN);
+        assert(0);
+    }
+    intnn_release_storage(mat);
+    mat->mRows = capRows;
+    mat->mCols = cols;
+    mat->mStride = intnn_aligned_stride(cols);
+    mat->mCapRows = capRows;
+    mat->mData = data;
+    mat->mMat = NULL; // 不建立行指针兼容层
+    mat->mDeleteOnDestruct = false;
+}
+
+// 逐元素运算每个线程至少处理的元素数，更小的矩阵在调用线程上完成
+#define INTNN_MAT_PARALLEL_MIN_ELEMS (1 << 16)
+
+// 逐元素运算的行区间任务：多线程时各线程处理互不重叠的行段
+typedef struct {
+    intnn_mat* mOut;
+    const intnn_mat* mA;
+    const intnn_mat* mB;
+    int mVal;
+    int mLow;
+    int mHigh;
+} intnn_elem_job;
+
+static void intnn_elem_for_rows(int rows, int cols, intnn_parallel_fn fn, intnn_elem_job* job) {
+    int grain = (INTNN_MAT_PARALLEL_MIN_ELEMS + cols - 1) / intnn_max(cols, 1);
+    if (rows <= grain)
+        fn(job, 0, rows, 0);
+    else
+        intnn_parallel_for(rows, grain, fn, job);
+}
+
 // 创建矩阵，所有元素初始化为0
 intnn_mat* intnn_create_mat(int rows, int cols) {
     if (rows <= 0 || cols <= 0)
@@ -13,29 +104,13 @@ intnn_mat* intnn_create_mat(int rows, int cols) {
     if (!mat)
         return NULL;
 
-    mat->mRows = rows;
-    mat->mCols = cols;
     mat->mDeleteOnDestruct = true;
     mat->mName = NULL;
-
-    mat->mMat = (int**)malloc(rows * sizeof(int*));
-    if (!mat->mMat) {
+    if (!intnn_alloc_storage(mat, rows, cols)) {
         free(mat);
         return NULL;
     }
 
-    for (int r = 0; r < rows; ++r) {
-        mat->mMat[r] = (int*)calloc(cols, sizeof(int));
-        if (!mat->mMat[r]) {
-            // 释放已分配行
-            for (int i = 0; i < r; ++i)
-                free(mat->mMat[i]);
-            free(mat->mMat);
-            free(mat);
-            return NULL;
-        }
-    }
-
     return mat;
 }
 
@@ -43,14 +118,7 @@ intnn_mat* intnn_create_mat(int rows, int cols) {
 void intnn_free_mat(intnn_mat* mat) {
     if (!mat)
         assert(0);
-    if (mat->mDeleteOnDestruct) {
-        if (mat->mMat) {
-            for (int r = 0; r < mat->mRows; ++r) {
-                free(mat->mMat[r]);
-            }
-            free(mat->mMat);
-        }
-    }
+    intnn_release_storage(mat);
     //free(mat);
 }
 
@@ -63,7 +131,7 @@ intnn_mat* intnn_copy_mat(const intnn_mat* src) {
         return NULL;
 
     for (int r = 0; r < src->mRows; ++r) {
-        memcpy(dst->mMat[r], src->mMat[r], sizeof(int) * src->mCols);
+        memcpy(INTNN_MAT_ROW(dst, r), INTNN_MAT_ROW(src, r), sizeof(int) * src->mCols);
     }
     dst->mName = src->mName;  // 指针复制，不拷贝字符串内容
     return dst;
@@ -81,8 +149,9 @@ void intnn_set_all_constant(intnn_mat* mat, int value) {
     if (!mat)
         assert(0);
     for (int r = 0; r < mat->mRows; ++r) {
+        int* row = INTNN_MAT_ROW(mat, r);
         for (int c = 0; c < mat->mCols; ++c) {
-            mat->mMat[r][c] = value;
+            row[c] = value;
         }
     }
 }
@@ -97,7 +166,7 @@ void intnn_set_random(intnn_mat* mat, bool allowZero, int minVal, int maxVal) {
             do {
                 val = minVal + rand() % (maxVal - minVal + 1);
             } while (!allowZero && val == 0);
-            mat->mMat[r][c] = val;
+            INTNN_MAT_ROW(mat, r)[c] = val;
         }
     }
 }
@@ -108,7 +177,7 @@ void intnn_set_elem(intnn_mat* mat, int r, int c, int val) {
         assert(0);
     if (r < 0 || r >= mat->mRows || c < 0 || c >= mat->mCols)
         assert(0);
-    mat->mMat[r][c] = val;
+    INTNN_MAT_ROW(mat, r)[c] = val;
 }
 
 // 从一维数组创建矩阵（按行优先）
@@ -120,35 +189,44 @@ intnn_mat* intnn_set_mat_from_array(int rows, int cols, int* data) {
         return NULL;
 
     for (int r = 0; r < rows; ++r) {
-        memcpy(mat->mMat[r], &data[r * cols], sizeof(int) * cols);
+        memcpy(INTNN_MAT_ROW(mat, r), &data[r * cols], sizeof(int) * cols);
     }
     return mat;
 }
 
-// 重新设置矩阵大小并清零（旧数据释放）
-void intnn_reset_zero(intnn_mat* mat, int rows, int cols) {
+// 重新设置矩阵大小（容量足够时只改逻辑尺寸，否则释放旧数据重新分配）
+void intnn_resize(intnn_mat* mat, int rows, int cols) {
     if (!mat || rows <= 0 || cols <= 0)
         assert(0);
-    if (mat->mDeleteOnDestruct && mat->mMat) {
-        for (int r = 0; r < mat->mRows; ++r)
-            free(mat->mMat[r]);
-        free(mat->mMat);
+    if (intnn_fits_storage(mat, rows, cols)) {
+        mat->mRows = rows;
+        mat->mCols = cols;
+        return;
     }
-    mat->mRows = rows;
-    mat->mCols = cols;
-    mat->mMat = (int**)malloc(rows * sizeof(int*));
-    for (int r = 0; r < rows; ++r) {
-        mat->mMat[r] = (int*)calloc(cols, sizeof(int));
+    intnn_release_storage(mat);
+    if (!intnn_alloc_storage(mat, rows, cols))
+        assert(0);
+}
+
+// 重新设置矩阵大小并清零
+void intnn_reset_zero(intnn_mat* mat, int rows, int cols) {
+    if (!mat || rows <= 0 || cols <= 0)
+        assert(0);
+    if (intnn_fits_storage(mat, rows, cols)) {
+        mat->mRows = rows;
+        mat->mCols = cols;
+        memset(mat->mData, 0, (size_t)rows * mat->mStride * sizeof(int));
+        return;
     }
-    mat->mDeleteOnDestruct = true;
+    intnn_release_storage(mat);
+    if (!intnn_alloc_storage(mat, rows, cols))
+        assert(0);
 }
 
 // 重新设置矩阵大小，所有元素设为1
 void intnn_reset_all_ones(intnn_mat* mat, int rows, int cols) {
     intnn_reset_zero(mat, rows, cols);
-    for (int r = 0; r < rows; ++r)
-        for (int c = 0; c < cols; ++c)
-            mat->mMat[r][c] = 1;
+    intnn_set_all_constant(mat, 1);
 }
 
 // 获取行数
@@ -170,9 +248,11 @@ int intnn_sum(const intnn_mat* mat) {
     if (!mat)
         return 0;
     int total = 0;
-    for (int r = 0; r < mat->mRows; ++r)
+    for (int r = 0; r < mat->mRows; ++r) {
+        const int* row = INTNN_MAT_ROW(mat, r);
         for (int c = 0; c < mat->mCols; ++c)
-            total += mat->mMat[r][c];
+            total += row[c];
+    }
     return total;
 }
 
@@ -189,7 +269,7 @@ int intnn_get_elem(const intnn_mat* mat, int r, int c) {
         return 0;
     if (r < 0 || r >= mat->mRows || c < 0 || c >= mat->mCols)
         return 0;
-    return mat->mMat[r][c];
+    return INTNN_MAT_ROW(mat, r)[c];
 }
 
 // 获取内部二维数据指针（非const，谨慎使用）
@@ -221,10 +301,10 @@ int intnn_get_max_index_in_row(const intnn_mat* mat, int r) {
         return -1;
 
     int maxIndex = 0;
-    int maxVal = mat->mMat[r][0];
+    int maxVal = INTNN_MAT_ROW(mat, r)[0];
     for (int c = 1; c < mat->mCols; ++c) {
-        if (mat->mMat[r][c] > maxVal) {
-            maxVal = mat->mMat[r][c];
+        if (INTNN_MAT_ROW(mat, r)[c] > maxVal) {
+            maxVal = INTNN_MAT_ROW(mat, r)[c];
             maxIndex = c;
         }
     }
@@ -238,10 +318,10 @@ int intnn_get_row_min(const intnn_mat* mat, int r) {
     if (r < 0 || r >= mat->mRows)
         return 0;
 
-    int minVal = mat->mMat[r][0];
+    int minVal = INTNN_MAT_ROW(mat, r)[0];
     for (int c = 1; c < mat->mCols; ++c) {
-        if (mat->mMat[r][c] < minVal) {
-            minVal = mat->mMat[r][c];
+        if (INTNN_MAT_ROW(mat, r)[c] < minVal) {
+            minVal = INTNN_MAT_ROW(mat, r)[c];
         }
     }
     return minVal;
@@ -254,10 +334,10 @@ int intnn_get_row_max(const intnn_mat* mat, int r) {
     if (r < 0 || r >= mat->mRows)
         return 0;
 
-    int maxVal = mat->mMat[r][0];
+    int maxVal = INTNN_MAT_ROW(mat, r)[0];
     for (int c = 1; c < mat->mCols; ++c) {
-        if (mat->mMat[r][c] > maxVal) {
-            maxVal = mat->mMat[r][c];
+        if (INTNN_MAT_ROW(mat, r)[c] > maxVal) {
+            maxVal = INTNN_MAT_ROW(mat, r)[c];
         }
     }
     return maxVal;
@@ -270,10 +350,10 @@ int intnn_get_col_min(const intnn_mat* mat, int c) {
     if (c < 0 || c >= mat->mCols)
         return 0;
 
-    int minVal = mat->mMat[0][c];
+    int minVal = INTNN_MAT_ROW(mat, 0)[c];
     for (int r = 1; r < mat->mRows; ++r) {
-        if (mat->mMat[r][c] < minVal) {
-            minVal = mat->mMat[r][c];
+        if (INTNN_MAT_ROW(mat, r)[c] < minVal) {
+            minVal = INTNN_MAT_ROW(mat, r)[c];
         }
     }
     return minVal;
@@ -286,10 +366,10 @@ int intnn_get_col_max(const intnn_mat* mat, int c) {
     if (c < 0 || c >= mat->mCols)
         return 0;
 
-    int maxVal = mat->mMat[0][c];
+    int maxVal = INTNN_MAT_ROW(mat, 0)[c];
     for (int r = 1; r < mat->mRows; ++r) {
-        if (mat->mMat[r][c] > maxVal) {
-            maxVal = mat->mMat[r][c];
+        if (INTNN_MAT_ROW(mat, r)[c] > maxVal) {
+            maxVal = INTNN_MAT_ROW(mat, r)[c];
         }
     }
     return maxVal;
@@ -302,7 +382,7 @@ int intnn_average(const intnn_mat* mat) {
     long long sum = 0;  // 用 long long 防止溢出
     for (int r = 0; r < mat->mRows; r++) {
         for (int c = 0; c < mat->mCols; c++) {
-            sum += mat->mMat[r][c];
+            sum += INTNN_MAT_ROW(mat, r)[c];
         }
     }
     return (int)(sum / (mat->mRows * mat->mCols));
@@ -315,7 +395,7 @@ int intnn_variance_with_avg(const intnn_mat* mat, int avg) {
     long long sum_var = 0;
     for (int r = 0; r < mat->mRows; r++) {
         for (int c = 0; c < mat->mCols; c++) {
-            int diff = mat->mMat[r][c] - avg;
+            int diff = INTNN_MAT_ROW(mat, r)[c] - avg;
             sum_var += (long long)diff * diff;
         }
     }
@@ -348,15 +428,31 @@ void intnn_average_colwise(intnn_mat* mat) {
     for (int c = 0; c < mat->mCols; c++) {
         long long sum = 0;
         for (int r = 0; r < mat->mRows; r++) {
-            sum += mat->mMat[r][c];
+            sum += INTNN_MAT_ROW(mat, r)[c];
         }
         int avg = (int)(sum / mat->mRows);
         for (int r = 0; r < mat->mRows; r++) {
-            mat->mMat[r][c] = avg;
+            INTNN_MAT_ROW(mat, r)[c] = avg;
         }
     }
 }
 
+// 按列求和，结果写入一行矩阵 out（在 uint32 上回绕累加，与 (1, N) 全 1 矩阵相乘结果一致）
+void intnn_sum_colwise_of(intnn_mat* out, const intnn_mat* in) {
+    if (!out || !in || in->mRows == 0 || in->mCols == 0)
+        assert(0);
+    intnn_resize(out, 1, in->mCols);
+    unsigned int* sum = (unsigned int*)INTNN_MAT_ROW(out, 0);
+    const int* row0 = INTNN_MAT_ROW(in, 0);
+    for (int c = 0; c < in->mCols; c++)
+        sum[c] = (unsigned int)row0[c];
+    for (int r = 1; r < in->mRows; r++) {
+        const int* row = INTNN_MAT_ROW(in, r);
+        for (int c = 0; c < in->mCols; c++)
+            sum[c] += (unsigned int)row[c];
+    }
+}
+
 // 标准化，将矩阵元素映射到 [low, high]，基于 numSigma 个标准差范围
 void intnn_standardize(intnn_mat* mat, int numSigma, int low, int high) {
     if (!mat || mat->mRows == 0 || mat->mCols == 0)
@@ -370,13 +466,13 @@ void intnn_standardize(intnn_mat* mat, int numSigma, int low, int high) {
 
     for (int r = 0; r < mat->mRows; r++) {
         for (int c = 0; c < mat->mCols; c++) {
-            int val = mat->mMat[r][c];
+            int val = INTNN_MAT_ROW(mat, r)[c];
             int standardized = ((val - avg) * scale) / range + low;
             if (standardized < low)
                 standardized = low;
             else if (standardized > high)
                 standardized = high;
-            mat->mMat[r][c] = standardized;
+            INTNN_MAT_ROW(mat, r)[c] = standardized;
         }
     }
 }
@@ -386,9 +482,9 @@ void intnn_normalize_rowwise(intnn_mat* mat, int newMin, int newMax) {
     if (!mat || mat->mRows == 0 || mat->mCols == 0)
         assert(0);
     for (int r = 0; r < mat->mRows; r++) {
-        int minVal = mat->mMat[r][0], maxVal = mat->mMat[r][0];
+        int minVal = INTNN_MAT_ROW(mat, r)[0], maxVal = INTNN_MAT_ROW(mat, r)[0];
         for (int c = 1; c < mat->mCols; c++) {
-            int val = mat->mMat[r][c];
+            int val = INTNN_MAT_ROW(mat, r)[c];
             if (val < minVal)
                 minVal = val;
             if (val > maxVal)
@@ -398,8 +494,8 @@ void intnn_normalize_rowwise(intnn_mat* mat, int newMin, int newMax) {
         if (diff == 0)
             diff = 1;  // 防止除零
         for (int c = 0; c < mat->mCols; c++) {
-            int val = mat->mMat[r][c];
-            mat->mMat[r][c] =
+            int val = INTNN_MAT_ROW(mat, r)[c];
+            INTNN_MAT_ROW(mat, r)[c] =
                 ((val - minVal) * (newMax - newMin)) / diff + newMin;
         }
     }
@@ -410,9 +506,9 @@ void intnn_normalize_colwise(intnn_mat* mat, int newMin, int newMax) {
     if (!mat || mat->mRows == 0 || mat->mCols == 0)
         assert(0);
     for (int c = 0; c < mat->mCols; c++) {
-        int minVal = mat->mMat[0][c], maxVal = mat->mMat[0][c];
+        int minVal = INTNN_MAT_ROW(mat, 0)[c], maxVal = INTNN_MAT_ROW(mat, 0)[c];
         for (int r = 1; r < mat->mRows; r++) {
-            int val = mat->mMat[r][c];
+            int val = INTNN_MAT_ROW(mat, r)[c];
             if (val < minVal)
                 minVal = val;
             if (val > maxVal)
@@ -422,8 +518,8 @@ void intnn_normalize_colwise(intnn_mat* mat, int newMin, int newMax) {
         if (diff == 0)
             diff = 1;  // 防止除零
         for (int r = 0; r < mat->mRows; r++) {
-            int val = mat->mMat[r][c];
-            mat->mMat[r][c] =
+            int val = INTNN_MAT_ROW(mat, r)[c];
+            INTNN_MAT_ROW(mat, r)[c] =
                 ((val - minVal) * (newMax - newMin)) / diff + newMin;
         }
     }
@@ -433,10 +529,10 @@ void intnn_normalize_colwise(intnn_mat* mat, int newMin, int newMax) {
 void intnn_normalize_minmax(intnn_mat* mat, int newMin, int newMax) {
     if (!mat || mat->mRows == 0 || mat->mCols == 0)
         assert(0);
-    int minVal = mat->mMat[0][0], maxVal = mat->mMat[0][0];
+    int minVal = INTNN_MAT_ROW(mat, 0)[0], maxVal = INTNN_MAT_ROW(mat, 0)[0];
     for (int r = 0; r < mat->mRows; r++) {
         for (int c = 0; c < mat->mCols; c++) {
-            int val = mat->mMat[r][c];
+            int val = INTNN_MAT_ROW(mat, r)[c];
             if (val < minVal)
                 minVal = val;
             if (val > maxVal)
@@ -448,28 +544,36 @@ void intnn_normalize_minmax(intnn_mat* mat, int newMin, int newMax) {
         diff = 1;
     for (int r = 0; r < mat->mRows; r++) {
         for (int c = 0; c < mat->mCols; c++) {
-            int val = mat->mMat[r][c];
-            mat->mMat[r][c] =
+            int val = INTNN_MAT_ROW(mat, r)[c];
+            INTNN_MAT_ROW(mat, r)[c] =
                 ((val - minVal) * (newMax - newMin)) / diff + newMin;
         }
     }
 }
 
+static void intnn_clamp_rows(void* ctx, int begin, int end, int tid) {
+    const intnn_elem_job* job = (const intnn_elem_job*)ctx;
+    (void)tid;
+    for (int r = begin; r < end; r++) {
+        int* row = INTNN_MAT_ROW(job->mOut, r);
+        for (int c = 0; c < job->mOut->mCols; c++) {
+            if (row[c] < job->mLow)
+                row[c] = job->mLow;
+            else if (row[c] > job->mHigh)
+                row[c] = job->mHigh;
+        }
+    }
+}
+
 // 限制矩阵元素在区间 [low, high]
 void intnn_clamp_mat(intnn_mat* mat, int low, int high) {
     if (!mat)
         assert(0);
-    for (int r = 0; r < mat->mRows; r++) {
-        for (int c = 0; c < mat->mCols; c++) {
-            if (mat->mMat[r][c] < low)
-                mat->mMat[r][c] = low;
-            else if (mat->mMat[r][c] > high)
-                mat->mMat[r][c] = high;
-        }
-    }
+    intnn_elem_job job = { mat, NULL, NULL, 0, low, high };
+    intnn_elem_for_rows(mat->mRows, mat->mCols, intnn_clamp_rows, &job);
 }
 
-// 矩阵乘法：out = a * b
+// 矩阵乘法：out = a * b（分块打包实现见 intnn_gemm.c）
 void intnn_mat_mul_mat(intnn_mat* out, const intnn_mat* a, const intnn_mat* b) {
     if (!out || !a || !b)
         assert(0);
@@ -483,50 +587,26 @@ void intnn_mat_mul_mat(intnn_mat* out, const intnn_mat* a, const intnn_mat* b) {
     if (out->mRows != a->mRows || out->mCols != b->mCols){
         assert(0);
     }
-    /*if (!(a->mRows < 11 || a->mCols < 11 || b->mRows < 11 || b->mCols < 11)) {
-        printf("A:\n");
-        for (int i = 0; i < 10; i++, printf("\n"))
-            for (int j = 0; j < 10; j++)
-                printf("%d ", a->mMat[i][j]);
-        printf("B:\n");
-        for (int i = 0; i < 10; i++, printf("\n"))
-            for (int j = 0; j < 10; j++)
-                printf("%d ", b->mMat[i][j]);
-        printf("OUT OF MULTI:\n");
-        for (int i = 0; i < 10; i++, printf("\n"))
-            for (int j = 0; j < 10; j++)
-                printf("%d ", out->mMat[i][j]);
-    }
-    printf("------------------\n");*/
-    int flag = 1;
-    for (int i = 0; i < a->mRows; i++)
-        for (int j = 0; j < a->mCols; j++)
-            if (a->mMat[i][j]) flag = 0;
+    intnn_gemm(out, a, b);
+}
 
-    for (int r = 0; r < a->mRows; r++) {
-        for (int c = 0; c < b->mCols; c++) {
-            long long sum = 0;
-            for (int k = 0; k < a->mCols; k++) {
-                sum += (long long)a->mMat[r][k] * b->mMat[k][c];
-                //if (sum) printf("%d %d %d\n", a->mMat[r][k], b->mMat[k][c], k);
-            }
-            out->mMat[r][c] = (int)sum;
-        }
+// 带转置标志的矩阵乘法：out = op(a) × op(b)，直接读原矩阵，不生成转置副本
+void intnn_mat_mul_mat_trans(intnn_mat* out, const intnn_mat* a, bool transA, const intnn_mat* b, bool transB) {
+    if (!out || !a || !b)
+        assert(0);
+    int aRows = transA ? a->mCols : a->mRows;
+    int aCols = transA ? a->mRows : a->mCols;
+    int bRows = transB ? b->mCols : b->mRows;
+    int bCols = transB ? b->mRows : b->mCols;
+    if (aCols != bRows) {
+        printf("op(a) size: (%d, %d)\n", aRows, aCols);
+        printf("op(b) size: (%d, %d)\n", bRows, bCols);
+        printf("Matrix multiplication dimension mismatch: op(a).cols != op(b).rows\n");
+        assert(0);
     }
-    /*if (!(a->mRows < 11 || a->mCols < 11 || b->mRows < 11 || b->mCols < 11)) {
-        printf("A:\n");
-        for (int i = 0; i < 10; i++, printf("\n"))
-            for (int j = 0; j < 10; j++)
-                printf("%d ", a->mMat[i][j]);
-        printf("B:\n");
-        for (int i = 0; i < 10; i++, printf("\n"))
-            for (int j = 0; j < 10; j++)
-                printf("%d ", b->mMat[i][j]);
-        printf("OUT OF MULTI:\n");
-        for (int i = 0; i < 10; i++, printf("\n"))
-            for (int j = 0; j < 10; j++)
-                printf("%d ", out->mMat[i][j]);
-    }*/
+    if (out->mRows != aRows || out->mCols != bCols)
+        assert(0);
+    intnn_gemm_trans(out, a, transA, b, transB);
 }
 
 // 矩阵加法：out = a + b
@@ -539,8 +619,11 @@ void intnn_mat_add_mat(intnn_mat* out, const intnn_mat* a, const intnn_mat* b) {
         assert(0);
 
     for (int r = 0; r < a->mRows; r++) {
+        int* rowOut = INTNN_MAT_ROW(out, r);
+        const int* rowA = INTNN_MAT_ROW(a, r);
+        const int* rowB = INTNN_MAT_ROW(b, r);
         for (int c = 0; c < a->mCols; c++) {
-            out->mMat[r][c] = a->mMat[r][c] + b->mMat[r][c];
+            rowOut[c] = rowA[c] + rowB[c];
         }
     }
 }
@@ -555,8 +638,27 @@ void intnn_mat_elem_mul_mat(intnn_mat* out,
 
     
     for (int r = 0; r < a->mRows; r++) {
+        int* rowOut = INTNN_MAT_ROW(out, r);
+        const int* rowA = INTNN_MAT_ROW(a, r);
+        const int* rowB = INTNN_MAT_ROW(b, r);
         for (int c = 0; c < a->mCols; c++) {
-            out->mMat[r][c] = a->mMat[r][c] * b->mMat[r][c];
+            rowOut[c] = rowA[c] * rowB[c];
+        }
+    }
+}
+
+static void intnn_elem_div_rows(void* ctx, int begin, int end, int tid) {
+    const intnn_elem_job* job = (const intnn_elem_job*)ctx;
+    (void)tid;
+    for (int r = begin; r < end; r++) {
+        int* rowOut = INTNN_MAT_ROW(job->mOut, r);
+        const int* rowA = INTNN_MAT_ROW(job->mA, r);
+        const int* rowB = INTNN_MAT_ROW(job->mB, r);
+        for (int c = 0; c < job->mA->mCols; c++) {
+            int denom = rowB[c];
+            if (denom == 0)
+                denom = 1;  // 防止除零
+            rowOut[c] = rowA[c] / denom;
         }
     }
 }
@@ -572,14 +674,8 @@ void intnn_mat_elem_div_mat(intnn_mat* out,
     if (out->mRows != a->mRows || out->mCols != a->mCols)
         assert(0);
 
-    for (int r = 0; r < a->mRows; r++) {
-        for (int c = 0; c < a->mCols; c++) {
-            int denom = b->mMat[r][c];
-            if (denom == 0)
-                denom = 1;  // 防止除零
-            out->mMat[r][c] = a->mMat[r][c] / denom;
-        }
-    }
+    intnn_elem_job job = { out, a, b, 0, 0, 0 };
+    intnn_elem_for_rows(a->mRows, a->mCols, intnn_elem_div_rows, &job);
 }
 
 // 矩阵加常数：out = a + val
@@ -590,8 +686,10 @@ void intnn_mat_add_const(intnn_mat* out, const intnn_mat* a, int val) {
         assert(0);
 
     for (int r = 0; r < a->mRows; r++) {
+        int* rowOut = INTNN_MAT_ROW(out, r);
+        const int* rowA = INTNN_MAT_ROW(a, r);
         for (int c = 0; c < a->mCols; c++) {
-            out->mMat[r][c] = a->mMat[r][c] + val;
+            rowOut[c] = rowA[c] + val;
         }
     }
 }
@@ -604,8 +702,10 @@ void intnn_mat_mul_const(intnn_mat* out, const intnn_mat* a, int val) {
         assert(0);
 
     for (int r = 0; r < a->mRows; r++) {
+        int* rowOut = INTNN_MAT_ROW(out, r);
+        const int* rowA = INTNN_MAT_ROW(a, r);
         for (int c = 0; c < a->mCols; c++) {
-            out->mMat[r][c] = a->mMat[r][c] * val;
+            rowOut[c] = rowA[c] * val;
         }
     }
 }
@@ -620,8 +720,10 @@ void intnn_mat_div_const(intnn_mat* out, const intnn_mat* a, int val) {
         assert(0);
 
     for (int r = 0; r < a->mRows; r++) {
+        int* rowOut = INTNN_MAT_ROW(out, r);
+        const int* rowA = INTNN_MAT_ROW(a, r);
         for (int c = 0; c < a->mCols; c++) {
-            out->mMat[r][c] = a->mMat[r][c] / val;
+            rowOut[c] = rowA[c] / val;
         }
     }
 }
@@ -632,32 +734,35 @@ static inline int dimsEqual(const intnn_mat* a, const intnn_mat* b) {
 }
 
 // 重置矩阵尺寸并清零
-void resetZero(intnn_mat* mat, int rows, int cols) {
-    if(mat) intnn_free_mat(mat);
-
-    // 更新维度
-    mat->mRows = rows;
-    mat->mCols = cols;
-
-    // 分配新内存
-    mat->mMat = (int**)malloc(rows * sizeof(int*));
-    for (int i = 0; i < rows; i++) {
-        mat->mMat[i] = (int*)calloc(cols, sizeof(int));
-    }
+static void resetZero(intnn_mat* mat, int rows, int cols) {
+    intnn_reset_zero(mat, rows, cols);
 }
 
 void intnn_self_add_const(intnn_mat* mat, int val) {
     for (int r = 0; r < mat->mRows; ++r) {
+        int* row = INTNN_MAT_ROW(mat, r);
         for (int c = 0; c < mat->mCols; ++c) {
-            mat->mMat[r][c] += val;
+            row[c] += val;
         }
     }
 }
 
 void intnn_self_mul_const(intnn_mat* mat, int val) {
     for (int r = 0; r < mat->mRows; ++r) {
+        int* row = INTNN_MAT_ROW(mat, r);
         for (int c = 0; c < mat->mCols; ++c) {
-            mat->mMat[r][c] *= val;
+            row[c] *= val;
+        }
+    }
+}
+
+static void intnn_self_div_const_rows(void* ctx, int begin, int end, int tid) {
+    const intnn_elem_job* job = (const intnn_elem_job*)ctx;
+    (void)tid;
+    for (int r = begin; r < end; ++r) {
+        int* row = INTNN_MAT_ROW(job->mOut, r);
+        for (int c = 0; c < job->mOut->mCols; ++c) {
+            row[c] /= job->mVal;
         }
     }
 }
@@ -667,111 +772,111 @@ void intnn_self_div_const(intnn_mat* mat, int val) {
         // 避免除零，报错或返回
         assert(0);
     }
-    for (int r = 0; r < mat->mRows; ++r) {
-        for (int c = 0; c < mat->mCols; ++c) {
-            mat->mMat[r][c] /= val;
-        }
-    }
+    intnn_elem_job job = { mat, NULL, NULL, val, 0, 0 };
+    intnn_elem_for_rows(mat->mRows, mat->mCols, intnn_self_div_const_rows, &job);
 }
 
 void intnn_self_elem_add_const(intnn_mat* mat, int r, int c, int val) {
     if (r >= 0 && r < mat->mRows && c >= 0 && c < mat->mCols) {
-        mat->mMat[r][c] += val;
+        INTNN_MAT_ROW(mat, r)[c] += val;
+    }
+}
+
+static void intnn_self_add_mat_rows(void* ctx, int begin, int end, int tid) {
+    const intnn_elem_job* job = (const intnn_elem_job*)ctx;
+    const bool broadcast = job->mOut->mRows != job->mB->mRows;
+    (void)tid;
+    for (int r = begin; r < end; ++r) {
+        int* row = INTNN_MAT_ROW(job->mOut, r);
+        const int* rowB = INTNN_MAT_ROW(job->mB, broadcast ? 0 : r);
+        for (int c = 0; c < job->mOut->mCols; ++c) {
+            row[c] += rowB[c];
+        }
     }
 }
 
 void intnn_self_add_mat(intnn_mat* mat, const intnn_mat* b) {
     if (mat->mCols != b->mCols)
         assert(0);
-    if (mat->mRows == b->mRows) {
-        for (int r = 0; r < mat->mRows; ++r) {
-            for (int c = 0; c < mat->mCols; ++c) {
-                mat->mMat[r][c] += b->mMat[r][c];
-            }
-        }
-    }
-    else { // broadcast
-        for (int r = 0; r < mat->mRows; ++r) {
-            for (int c = 0; c < mat->mCols; ++c) {
-                mat->mMat[r][c] += b->mMat[0][c];
-            }
-        }
-    }
+    // 行数不同时按 b 的第 0 行广播
+    intnn_elem_job job = { mat, NULL, b, 0, 0, 0 };
+    intnn_elem_for_rows(mat->mRows, mat->mCols, intnn_self_add_mat_rows, &job);
 }
 
 void intnn_self_sub_mat(intnn_mat* mat, const intnn_mat* b) {
     if (!dimsEqual(mat, b))
         assert(0);
     for (int r = 0; r < mat->mRows; ++r) {
+        int* row = INTNN_MAT_ROW(mat, r);
+        const int* rowB = INTNN_MAT_ROW(b, r);
         for (int c = 0; c < mat->mCols; ++c) {
-            mat->mMat[r][c] -= b->mMat[r][c];
+            row[c] -= rowB[c];
         }
     }
 }
 void intnn_self_mul_mat(intnn_mat* mat, const intnn_mat* b) {
     // 矩阵乘法： mat = mat * b
-    // 先保存 mat 的副本
     if (mat->mCols != b->mRows)
         assert(0);  // 维度不匹配
 
+    // 结果写入临时存储，再把存储所有权转移给 mat
     intnn_mat temp;
-    // 假设你有分配和释放矩阵的函数
-    // 这里简化，先分配 temp.mMat
-    resetZero(&temp, mat->mRows, b->mCols);
-
-    for (int r = 0; r < temp.mRows; ++r) {
-        for (int c = 0; c < temp.mCols; ++c) {
-            int sum = 0;
-            for (int k = 0; k < mat->mCols; ++k) {
-                sum += mat->mMat[r][k] * b->mMat[k][c];
-            }
-            temp.mMat[r][c] = sum;
-        }
-    }
+    temp.mName = NULL;
+    if (!intnn_alloc_storage(&temp, mat->mRows, b->mCols))
+        assert(0);
+    intnn_mat_mul_mat(&temp, mat, b);
 
-    // 释放 mat 原空间，复制 temp 到 mat
-    // 这里简单替换指针和尺寸
-    // 实际要避免内存泄漏
-    // 你可以用 deepCopyOf 函数实现
-    for (int r = 0; r < mat->mRows; ++r) {
-        free(mat->mMat[r]);
-    }
-    free(mat->mMat);
-    mat->mMat = temp.mMat;
+    intnn_release_storage(mat);
     mat->mRows = temp.mRows;
     mat->mCols = temp.mCols;
-    // temp.mMat 指针已经转移给 mat，别 free temp.mMat 了
+    mat->mStride = temp.mStride;
+    mat->mCapRows = temp.mCapRows;
+    mat->mData = temp.mData;
+    mat->mMat = temp.mMat;
+    mat->mDeleteOnDestruct = temp.mDeleteOnDestruct;
 }
 
 void intnn_self_elem_mul_mat(intnn_mat* mat, const intnn_mat* b) {
     if (!dimsEqual(mat, b))
         assert(0);
     for (int r = 0; r < mat->mRows; ++r) {
+        int* row = INTNN_MAT_ROW(mat, r);
+        const int* rowB = INTNN_MAT_ROW(b, r);
         for (int c = 0; c < mat->mCols; ++c) {
-            mat->mMat[r][c] *= b->mMat[r][c];
+            row[c] *= rowB[c];
         }
     }
 }
 
-void intnn_self_elem_div_mat(intnn_mat* mat, const intnn_mat* b) {
-    if (!dimsEqual(mat, b))
-        assert(0);
-    for (int r = 0; r < mat->mRows; ++r) {
-        for (int c = 0; c < mat->mCols; ++c) {
-            if (b->mMat[r][c] == 0) {
-                mat->mMat[r][c] = INT_MAX;  // 避免除零
+static void intnn_self_elem_div_rows(void* ctx, int begin, int end, int tid) {
+    const intnn_elem_job* job = (const intnn_elem_job*)ctx;
+    (void)tid;
+    for (int r = begin; r < end; ++r) {
+        int* row = INTNN_MAT_ROW(job->mOut, r);
+        const int* rowB = INTNN_MAT_ROW(job->mB, r);
+        for (int c = 0; c < job->mOut->mCols; ++c) {
+            if (rowB[c] == 0) {
+                row[c] = INT_MAX;  // 避免除零
             } else {
-                mat->mMat[r][c] /= b->mMat[r][c];
+                row[c] /= rowB[c];
             }
         }
     }
 }
 
+void intnn_self_elem_div_mat(intnn_mat* mat, const intnn_mat* b) {
+    if (!dimsEqual(mat, b))
+        assert(0);
+    intnn_elem_job job = { mat, NULL, b, 0, 0, 0 };
+    intnn_elem_for_rows(mat->mRows, mat->mCols, intnn_self_elem_div_rows, &job);
+}
+
 void intnn_transpose_of(intnn_mat* out, const intnn_mat* in) {
     resetZero(out, in->mCols, in->mRows);
     for (int r = 0; r < in->mRows; ++r) {
+        const int* rowIn = INTNN_MAT_ROW(in, r);
         for (int c = 0; c < in->mCols; ++c) {
-            out->mMat[c][r] = in->mMat[r][c];
+            INTNN_MAT_ROW(out, c)[r] = rowIn[c];
         }
     }
 }
@@ -780,7 +885,7 @@ void intnn_rotate180_of(intnn_mat* out, const intnn_mat* in) {
     resetZero(out, in->mRows, in->mCols);
     for (int r = 0; r < in->mRows; ++r) {
         for (int c = 0; c < in->mCols; ++c) {
-            out->mMat[in->mRows - 1 - r][in->mCols - 1 - c] = in->mMat[r][c];
+            INTNN_MAT_ROW(out, in->mRows - 1 - r)[in->mCols - 1 - c] = INTNN_MAT_ROW(in, r)[c];
         }
     }
 }
@@ -800,7 +905,7 @@ void intnn_square_root_of(intnn_mat* out, const intnn_mat* in) {
     resetZero(out, in->mRows, in->mCols);
     for (int r = 0; r < in->mRows; ++r) {
         for (int c = 0; c < in->mCols; ++c) {
-            out->mMat[r][c] = floorSqrt(in->mMat[r][c]);
+            INTNN_MAT_ROW(out, r)[c] = floorSqrt(INTNN_MAT_ROW(in, r)[c]);
         }
     }
 }
@@ -822,11 +927,9 @@ void intnn_slice_of(intnn_mat* out,
 
     int rows = rowEnd - rowStart + 1;
     int cols = colEnd - colStart + 1;
-    resetZero(out, rows, cols);
+    intnn_resize(out, rows, cols); // 每行都会被完整覆盖，无需清零
     for (int r = 0; r < rows; ++r) {
-        for (int c = 0; c < cols; ++c) {
-            out->mMat[r][c] = in->mMat[rowStart + r][colStart + c];
-        }
+        memcpy(INTNN_MAT_ROW(out, r), INTNN_MAT_ROW(in, rowStart + r) + colStart, sizeof(int) * cols);
     }
 }
 
@@ -838,17 +941,45 @@ void intnn_indexed_slice_of(intnn_mat* out,
     if (start < 0 || end > in->mRows || start >= end)
         assert(0);
     int size = end - start;
-    resetZero(out, size, in->mCols);
+    intnn_resize(out, size, in->mCols); // 预分配的 out 直接复用，每行都会被完整覆盖
     for (int r = 0; r < size; ++r) {
         int idx = indices[start + r];
         if (idx < 0 || idx >= in->mRows)
             assert(0);
-        for (int c = 0; c < in->mCols; ++c) {
-            out->mMat[r][c] = in->mMat[idx][c];
-        }
+        memcpy(INTNN_MAT_ROW(out, r), INTNN_MAT_ROW(in, idx), sizeof(int) * in->mCols);
     }
 }
 
+// 零拷贝视图：view 指向 in 的子区域，不拥有存储，释放 view 不影响 in
+// view 必须是零初始化的结构体、已释放的矩阵或另一个视图；in 的存储须在 view 使用期间保持有效
+void intnn_view_of(intnn_mat* view,
+                   const intnn_mat* in,
+                   int rowStart,
+                   int rowEnd,
+                   int colStart,
+                   int colEnd) {
+    if (!view || !in || view == in)
+        assert(0);
+    if (rowStart < 0 || colStart < 0 || rowEnd >= in->mRows ||
+        colEnd >= in->mCols) {
+        printf("[WARN] view_of: Index out of bounds\n");
+        assert(0);
+    }
+    if (rowEnd < rowStart || colEnd < colStart)
+        assert(0);
+
+    intnn_release_storage(view);
+    view->mRows = rowEnd - rowStart + 1;
+    view->mCols = colEnd - colStart + 1;
+    view->mStride = in->mStride;
+    view->mCapRows = 0;
+    view->mData = INTNN_MAT_ROW(in, rowStart) + colStart;
+    // 行指针兼容层只能在列不偏移时共享父矩阵的行指针
+    view->mMat = (colStart == 0 && in->mMat) ? in->mMat + rowStart : NULL;
+    view->mDeleteOnDestruct = false;
+    view->mName = in->mName;
+}
+
 void intnn_random_k_samples_of(intnn_mat* out, const intnn_mat* in, int k) {
     if (k > in->mRows)
         assert(0);
@@ -868,9 +999,7 @@ void intnn_random_k_samples_of(intnn_mat* out, const intnn_mat* in, int k) {
 
     resetZero(out, k, in->mCols);
     for (int r = 0; r < k; ++r) {
-        for (int c = 0; c < in->mCols; ++c) {
-            out->mMat[r][c] = in->mMat[indices[r]][c];
-        }
+        memcpy(INTNN_MAT_ROW(out, r), INTNN_MAT_ROW(in, indices[r]), sizeof(int) * in->mCols);
     }
 
     free(indices);
@@ -879,7 +1008,7 @@ void intnn_random_k_samples_of(intnn_mat* out, const intnn_mat* in, int k) {
 void intnn_print_mat(const intnn_mat* mat) {
     for (int r = 0; r < mat->mRows; ++r) {
         for (int c = 0; c < mat->mCols; ++c) {
-            printf("%d ", mat->mMat[r][c]);
+            printf("%d ", INTNN_MAT_ROW(mat, r)[c]);
         }
         printf("\n");
     }
@@ -896,10 +1025,20 @@ void intnn_mat_update_lr(intnn_mat* target,
         lr_inverse = 1;
     }
 
+    // lr_inverse 为 2 的幂时按向零取整右移，与整数除法逐位一致
+    const int shift = intnn_exact_log2(lr_inverse);
     for (int r = 0; r < target->mRows; ++r) {
+        int* rowT = INTNN_MAT_ROW(target, r);
+        const int* rowU = INTNN_MAT_ROW(update, r);
+        if (shift >= 0) {
+            const unsigned int bias = (1u << shift) - 1u;
+            for (int c = 0; c < target->mCols; ++c)
+                rowT[c] += (rowU[c] + (int)((unsigned int)(rowU[c] >> 31) & bias)) >> shift;
+            continue;
+        }
         for (int c = 0; c < target->mCols; ++c) {
             // 这里做整数除法，符合原函数
-            target->mMat[r][c] += update->mMat[r][c] / lr_inverse;
+            rowT[c] += rowU[c] / lr_inverse;
         }
     }
 }
@@ -914,14 +1053,16 @@ int intnn_count_max_match(const intnn_mat* predictions, const intnn_mat* targets
 
     int count = 0;
     for (int i = 0; i < predictions->mRows; ++i) {
+        const int* rowP = INTNN_MAT_ROW(predictions, i);
+        const int* rowT = INTNN_MAT_ROW(targets, i);
         int maxPredIdx = 0;
         int maxTargetIdx = 0;
 
         for (int j = 1; j < predictions->mCols; ++j) {
-            if (predictions->mMat[i][j] > predictions->mMat[i][maxPredIdx]) {
+            if (rowP[j] > rowP[maxPredIdx]) {
                 maxPredIdx = j;
             }
-            if (targets->mMat[i][j] > targets->mMat[i][maxTargetIdx]) {
+            if (rowT[j] > rowT[maxTargetIdx]) {
                 maxTargetIdx = j;
             }
         }
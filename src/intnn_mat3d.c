@@ -1,53 +1,76 @@
 #include "intnn_mat3d.h"
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
-intnn_mat3d* intnn_create_mat3d(int depth, int rows, int cols) {
-    intnn_mat3d* mat3d = (intnn_mat3d*)malloc(sizeof(intnn_mat3d));
-    if (!mat3d) return NULL;
-
+// 按 mDepth / mRows / mCols 调整连续存储与各层视图；clear 为真时清零。
+// 存储容量与视图数组都够用时不重新分配，失败时张量置空
+static void intnn_mat3d_reshape(intnn_mat3d* mat3d, int depth, int rows, int cols, bool clear) {
     mat3d->mDepth = (depth > 0) ? depth : 0;
     mat3d->mRows = (rows > 0) ? rows : 0;
     mat3d->mCols = (cols > 0) ? cols : 0;
-    mat3d->mDeleteOnDestruct = true;
-
     if (mat3d->mDepth == 0 || mat3d->mRows == 0 || mat3d->mCols == 0) {
-        mat3d->mMat3d = NULL;
-        return mat3d;
+        mat3d->mDepth = mat3d->mRows = mat3d->mCols = 0;
+        return;
     }
 
-    mat3d->mMat3d = (intnn_mat**)malloc(sizeof(intnn_mat*) * mat3d->mDepth);
-    if (!mat3d->mMat3d) {
-        free(mat3d);
-        return NULL;
+    const int flatRows = mat3d->mDepth * mat3d->mRows;
+    if (!mat3d->mFlat) {
+        mat3d->mFlat = intnn_create_mat(flatRows, mat3d->mCols);   // 新分配的存储已清零
+    } else if (clear) {
+        intnn_reset_zero(mat3d->mFlat, flatRows, mat3d->mCols);
+    } else {
+        intnn_resize(mat3d->mFlat, flatRows, mat3d->mCols);
+    }
+
+    if (mat3d->mFlat && mat3d->mDepth > mat3d->mCapDepth) {
+        intnn_mat** mats = (intnn_mat**)realloc(mat3d->mMat3d, sizeof(intnn_mat*) * mat3d->mDepth);
+        if (mats)
+            mat3d->mMat3d = mats;
+        intnn_mat* slices = mats ? (intnn_mat*)realloc(mat3d->mSlices, sizeof(intnn_mat) * mat3d->mDepth) : NULL;
+        if (slices) {
+            // 新增的视图结构体清零，使 intnn_view_of 不会误释放
+            memset(slices + mat3d->mCapDepth, 0, sizeof(intnn_mat) * (mat3d->mDepth - mat3d->mCapDepth));
+            mat3d->mSlices = slices;
+            mat3d->mCapDepth = mat3d->mDepth;
+        }
+    }
+    if (!mat3d->mFlat || mat3d->mDepth > mat3d->mCapDepth) {
+        mat3d->mDepth = mat3d->mRows = mat3d->mCols = 0; // 分配失败不做事
+        return;
     }
 
-    for (int i = 0; i < mat3d->mDepth; i++) {
-        mat3d->mMat3d[i] = intnn_create_mat(mat3d->mRows, mat3d->mCols);
-        if (!mat3d->mMat3d[i]) {
-            // 失败时释放已分配内存
-            for (int j = 0; j < i; j++) {
-                intnn_free_mat(mat3d->mMat3d[j]);
-            }
-            free(mat3d->mMat3d);
-            free(mat3d);
-            return NULL;
-        }
+    for (int d = 0; d < mat3d->mDepth; d++) {
+        intnn_view_of(&mat3d->mSlices[d], mat3d->mFlat, d * mat3d->mRows, (d + 1) * mat3d->mRows - 1, 0, mat3d->mCols - 1);
+        mat3d->mMat3d[d] = &mat3d->mSlices[d];
     }
+}
+
+intnn_mat3d* intnn_create_mat3d(int depth, int rows, int cols) {
+    intnn_mat3d* mat3d = (intnn_mat3d*)calloc(1, sizeof(intnn_mat3d));
+    if (!mat3d) return NULL;
 
+    mat3d->mDeleteOnDestruct = true;
+    intnn_mat3d_reshape(mat3d, depth, rows, cols, true);
+    if (depth > 0 && rows > 0 && cols > 0 && mat3d->mDepth == 0) {
+        // 失败时释放已分配内存
+        intnn_free_mat3d(mat3d);
+        return NULL;
+    }
     return mat3d;
 }
 
 void intnn_free_mat3d(intnn_mat3d* mat3d) {
     if (!mat3d) return;
-    if (mat3d->mDeleteOnDestruct && mat3d->mMat3d) {
-        for (int i = 0; i < mat3d->mDepth; i++) {
-            if (mat3d->mMat3d[i]) {
-                intnn_free_mat(mat3d->mMat3d[i]);
-                mat3d->mMat3d[i] = NULL;
-            }
+    if (mat3d->mDeleteOnDestruct) {
+        if (mat3d->mFlat) {
+            intnn_free_mat(mat3d->mFlat);
+            free(mat3d->mFlat);
         }
+        free(mat3d->mSlices);
         free(mat3d->mMat3d);
+        mat3d->mFlat = NULL;
+        mat3d->mSlices = NULL;
         mat3d->mMat3d = NULL;
     }
     free(mat3d);
@@ -55,44 +78,12 @@ void intnn_free_mat3d(intnn_mat3d* mat3d) {
 
 void intnn_reset_zero3d(intnn_mat3d* mat3d, int depth, int rows, int cols) {
     if (!mat3d) return;
+    intnn_mat3d_reshape(mat3d, depth, rows, cols, true);
+}
 
-    if (mat3d->mMat3d) {
-        // 先释放原来的矩阵数据
-        for (int i = 0; i < mat3d->mDepth; i++) {
-            if (mat3d->mMat3d[i]) {
-                intnn_free_mat(mat3d->mMat3d[i]);
-            }
-        }
-        free(mat3d->mMat3d);
-    }
-
-    mat3d->mDepth = (depth > 0) ? depth : 0;
-    mat3d->mRows = (rows > 0) ? rows : 0;
-    mat3d->mCols = (cols > 0) ? cols : 0;
-
-    if (mat3d->mDepth == 0 || mat3d->mRows == 0 || mat3d->mCols == 0) {
-        mat3d->mMat3d = NULL;
-        return;
-    }
-
-    mat3d->mMat3d = (intnn_mat**)malloc(sizeof(intnn_mat*) * mat3d->mDepth);
-    if (!mat3d->mMat3d) return; // 分配失败不做事
-
-    for (int i = 0; i < mat3d->mDepth; i++) {
-        mat3d->mMat3d[i] = intnn_create_mat(mat3d->mRows, mat3d->mCols);
-        if (!mat3d->mMat3d[i]) {
-            // 失败时释放已分配
-            for (int j = 0; j < i; j++) {
-                intnn_free_mat(mat3d->mMat3d[j]);
-            }
-            free(mat3d->mMat3d);
-            mat3d->mMat3d = NULL;
-            mat3d->mDepth = 0;
-            mat3d->mRows = 0;
-            mat3d->mCols = 0;
-            return;
-        }
-    }
+void intnn_resize3d(intnn_mat3d* mat3d, int depth, int rows, int cols) {
+    if (!mat3d) return;
+    intnn_mat3d_reshape(mat3d, depth, rows, cols, false);
 }
 
 int intnn_mat3d_rows(const intnn_mat3d* mat3d) {
@@ -132,6 +123,11 @@ intnn_mat* intnn_mat3d_get_mat_at_depth(intnn_mat3d* mat3d, int d) {
     return mat3d->mMat3d[d];
 }
 
+intnn_mat* intnn_mat3d_flat(const intnn_mat3d* mat3d) {
+    assert(mat3d);
+    return mat3d->mDepth > 0 ? mat3d->mFlat : NULL;
+}
+
 bool intnn_mat3d_dims_equal(const intnn_mat3d* m1, const intnn_mat3d* m2) {
     assert(m1 && m2);
     return (m1->mDepth == m2->mDepth) &&
@@ -163,9 +159,8 @@ void intnn_mat3d_add(intnn_mat3d* out, const intnn_mat3d* a, const intnn_mat3d*
         intnn_reset_zero3d(out, a->mDepth, a->mRows, a->mCols);
     }
 
-    for (int d = 0; d < out->mDepth; d++) {
-        intnn_mat_add_mat(out->mMat3d[d], a->mMat3d[d], b->mMat3d[d]);
-    }
+    if (out->mDepth > 0)
+        intnn_mat_add_mat(out->mFlat, a->mFlat, b->mFlat);
 }
 
 void intnn_mat3d_elem_div(intnn_mat3d* out, const intnn_mat3d* a, const intnn_mat3d* b) {
@@ -176,42 +171,43 @@ void intnn_mat3d_elem_div(intnn_mat3d* out, const intnn_mat3d* a, const intnn_ma
         intnn_reset_zero3d(out, a->mDepth, a->mRows, a->mCols);
     }
 
-    for (int d = 0; d < out->mDepth; d++) {
-        intnn_mat_elem_div_mat(out->mMat3d[d], a->mMat3d[d], b->mMat3d[d]);
-    }
+    if (out->mDepth > 0)
+        intnn_mat_elem_div_mat(out->mFlat, a->mFlat, b->mFlat);
 }
 
 void intnn_mat3d_self_add(intnn_mat3d* self, const intnn_mat3d* other) {
     if (!intnn_mat3d_dims_equal(self, other)) return;
 
-    for (int d = 0; d < self->mDepth; ++d) {
-        intnn_self_add_mat(self->mMat3d[d], other->mMat3d[d]);
-    }
+    if (self->mDepth > 0)
+        intnn_self_add_mat(self->mFlat, other->mFlat);
 }
 void intnn_mat3d_self_div_const(intnn_mat3d* self, int val) {
-    for (int d = 0; d < self->mDepth; ++d) {
-        intnn_self_div_const(self->mMat3d[d], val);
-    }
+    if (self->mDepth > 0)
+        intnn_self_div_const(self->mFlat, val);
 }
 void intnn_mat3d_self_elem_mul(intnn_mat3d* self, const intnn_mat3d* other) {
     if (!intnn_mat3d_dims_equal(self, other)) return;
 
-    for (int d = 0; d < self->mDepth; ++d) {
-        intnn_self_elem_mul_mat(self->mMat3d[d], other->mMat3d[d]);
-    }
+    if (self->mDepth > 0)
+        intnn_self_elem_mul_mat(self->mFlat, other->mFlat);
 }
 void intnn_mat3d_self_elem_div(intnn_mat3d* self, const intnn_mat3d* other) {
     if (!intnn_mat3d_dims_equal(self, other)) return;
 
-    for (int d = 0; d < self->mDepth; ++d) {
-        intnn_self_elem_div_mat(self->mMat3d[d], other->mMat3d[d]);
-    }
+    if (self->mDepth > 0)
+        intnn_self_elem_div_mat(self->mFlat, other->mFlat);
 }
 void intnn_mat3d_rotate180(intnn_mat3d* out, const intnn_mat3d* in) {
-    intnn_reset_zero3d(out, in->mDepth, in->mRows, in->mCols);
+    intnn_resize3d(out, in->mDepth, in->mRows, in->mCols);
 
+    // 各层是 mFlat 的视图，直接按行写入（intnn_rotate180_of 会给视图重新分配存储）
     for (int d = 0; d < in->mDepth; ++d) {
-        intnn_rotate180_of(out->mMat3d[d], in->mMat3d[d]);
+        for (int r = 0; r < in->mRows; ++r) {
+            const int* src = INTNN_MAT_ROW(in->mMat3d[d], r);
+            int* dst = INTNN_MAT_ROW(out->mMat3d[d], in->mRows - 1 - r);
+            for (int c = 0; c < in->mCols; ++c)
+                dst[in->mCols - 1 - c] = src[c];
+        }
     }
 }
 void intnn_mat3d_make_from_mat(intnn_mat3d* out, int depth, int rows, int cols, const intnn_mat* mat) {
@@ -230,12 +226,10 @@ void intnn_mat3d_make_from_mat(intnn_mat3d* out, int depth, int rows, int cols,
     }
 }
 void intnn_mat3d_deep_copy(intnn_mat3d* out, const intnn_mat3d* in) {
-    intnn_reset_zero3d(out, in->mDepth, in->mRows, in->mCols);
+    intnn_resize3d(out, in->mDepth, in->mRows, in->mCols);
 
-    for (int d = 0; d < in->mDepth; ++d) {
-        intnn_mat* copy = intnn_copy_mat(in->mMat3d[d]);
-        intnn_free_mat(out->mMat3d[d]);
-        out->mMat3d[d] = copy;
+    for (int r = 0; r < out->mDepth * out->mRows; ++r) {
+        memcpy(INTNN_MAT_ROW(out->mFlat, r), INTNN_MAT_ROW(in->mFlat, r), sizeof(int) * in->mCols);
     }
 }
 void intnn_mat3d_print(const intnn_mat3d* mat3d) {
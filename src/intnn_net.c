@@ -0,0 +1,480 @@
+#include "intnn_net.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "intnn_actv.h"
+#include "intnn_loss.h"
+#include "intnn_thread_pool.h"
+#include "intnn_tools.h"
+
+intnn_net* intnn_net_create(void) {
+    intnn_net* net = (intnn_net*)calloc(1, sizeof(intnn_net));
+    return net;
+}
+
+void intnn_net_free(intnn_net* net) {
+    if (!net)
+        return;
+    for (int k = 0; k < net->mNumLayers; ++k) {
+        intnn_fc_free(net->mLayers[k]);
+        free(net->mLayers[k]);
+    }
+    if (net->mPlan.mOwnsSlab)
+        intnn_aligned_free(net->mPlan.mSlab);
+    free(net->mLayers);
+    free(net);
+}
+
+void intnn_net_add(intnn_net* net, intnn_fc_layer* layer) {
+    assert(net != NULL && layer != NULL);
+    // 已规划的层矩阵绑定在 slab 中，新层无法纳入原规划
+    if (net->mPlan.mMemMode != INTNN_NET_MEM_NONE) {
+        printf("Cannot add a layer after intnn_net_plan_memory\n");
+        assert(0);
+    }
+    if (net->mNumLayers == net->mCapacity) {
+        int capacity = net->mCapacity > 0 ? net->mCapacity * 2 : 4;
+        intnn_fc_layer** layers = (intnn_fc_layer**)realloc(net->mLayers, sizeof(intnn_fc_layer*) * capacity);
+        if (!layers)
+            assert(0);
+        net->mLayers = layers;
+        net->mCapacity = capacity;
+    }
+    intnn_fc_layer* last = net->mNumLayers > 0 ? net->mLayers[net->mNumLayers - 1] : NULL;
+    if (last && last->mOutDim != layer->mInDim) {
+        printf("Layer dimension mismatch: previous outDim %d, new inDim %d\n", last->mOutDim, layer->mInDim);
+        assert(0);
+    }
+    layer->mPrev = last;
+    layer->mNext = NULL;
+    if (last)
+        last->mNext = layer;
+    net->mLayers[net->mNumLayers++] = layer;
+    net->mPlan.mReady = false;
+    net->mPlan.mDfaReady = false;
+}
+
+int intnn_net_num_layers(const intnn_net* net) {
+    return net ? net->mNumLayers : 0;
+}
+
+intnn_fc_layer* intnn_net_layer(const intnn_net* net, int index) {
+    assert(net != NULL);
+    if (index < 0)
+        index += net->mNumLayers;
+    if (index < 0 || index >= net->mNumLayers) {
+        printf("Layer index out of range: %d (%d layers)\n", index, net->mNumLayers);
+        assert(0);
+    }
+    return net->mLayers[index];
+}
+
+// 检查形状并确定反向调度，不分配缓冲
+static void intnn_net_plan_schedule(intnn_net* net, int maxBatch) {
+    assert(net != NULL && net->mNumLayers > 0 && maxBatch > 0);
+    intnn_net_plan_info* plan = &net->mPlan;
+    const int n = net->mNumLayers;
+
+    // 形状：相邻层维度以及权重/偏置尺寸只在这里检查一次
+    for (int k = 0; k < n; ++k) {
+        const intnn_fc_layer* layer = net->mLayers[k];
+        if (k > 0 && net->mLayers[k - 1]->mOutDim != layer->mInDim) {
+            printf("Layer dimension mismatch at layer %d: %d -> %d\n", k, net->mLayers[k - 1]->mOutDim, layer->mInDim);
+            assert(0);
+        }
+        if (layer->mWeight->mRows != layer->mInDim || layer->mWeight->mCols != layer->mOutDim ||
+            !intnn_dims_equal_size(layer->mBias, 1, layer->mOutDim)) {
+            printf("Layer %d weight/bias shape does not match (%d, %d)\n", k, layer->mInDim, layer->mOutDim);
+            assert(0);
+        }
+    }
+
+    // 反向调度：除最后一层外全是无批归一化的 DFA 层时，各层只依赖最后一层误差，可同时进行
+    bool dfaParallel = n > 1 && !net->mLayers[n - 1]->mUseBn;
+    for (int k = 0; k < n - 1 && dfaParallel; ++k)
+        dfaParallel = net->mLayers[k]->mUseDfa && !net->mLayers[k]->mUseBn;
+
+    plan->mMaxBatch = maxBatch;
+    plan->mInDim = net->mLayers[0]->mInDim;
+    plan->mOutDim = net->mLayers[n - 1]->mOutDim;
+    plan->mDfaParallel = dfaParallel;
+    plan->mReady = true;
+}
+
+void intnn_net_plan(intnn_net* net, int maxBatch) {
+    assert(net != NULL);
+    if (net->mPlan.mMemMode != INTNN_NET_MEM_NONE && maxBatch > net->mPlan.mMaxBatch) {
+        printf("Batch size %d exceeds the memory plan (max %d)\n", maxBatch, net->mPlan.mMaxBatch);
+        assert(0);
+    }
+    const int plannedBatch = net->mPlan.mMemMode != INTNN_NET_MEM_NONE ? net->mPlan.mMaxBatch : maxBatch;
+    intnn_net_plan_schedule(net, plannedBatch);
+
+    // 缓冲：按最大批一次预留，之后每步只调整逻辑行数（已做内存规划时容量已足够，不会重新分配）
+    for (int k = 0; k < net->mNumLayers; ++k)
+        intnn_fc_reserve(net->mLayers[k], plannedBatch);
+}
+
+// 一个中间矩阵的规划：存活区间以时刻计，时刻 k 为第 k 层前向，时刻 n（层数）为损失与反向
+typedef struct {
+    intnn_mat** mMat;   // 层内矩阵指针的位置，绑定时若为 NULL 则新建
+    intnn_tmat** mCode; // 或激活梯度移位编码（UINT8）指针的位置，二者只有一个非 NULL
+    int mRows;
+    int mCols;
+    int mFirst;         // 首次写入的时刻
+    int mLast;          // 最后一次读取的时刻
+    size_t mBytes;
+    size_t mOffset;     // 在 slab 中的偏移
+} intnn_net_buffer;
+
+#define INTNN_NET_BUFFERS_PER_LAYER 6
+
+static void intnn_net_add_buffer(intnn_net_buffer* bufs, int* count, intnn_mat** mat,
+                                 int rows, int cols, int first, int last) {
+    intnn_net_buffer* b = &bufs[(*count)++];
+    b->mMat = mat;
+    b->mCode = NULL;
+    b->mRows = rows;
+    b->mCols = cols;
+    b->mFirst = first;
+    b->mLast = last;
+    b->mBytes = intnn_storage_bytes(rows, cols);
+    b->mOffset = 0;
+}
+
+static void intnn_net_add_code_buffer(intnn_net_buffer* bufs, int* count, intnn_tmat** code,
+                                      int rows, int cols, int first, int last) {
+    intnn_net_add_buffer(bufs, count, NULL, rows, cols, first, last);
+    intnn_net_buffer* b = &bufs[*count - 1];
+    b->mCode = code;
+    b->mBytes = intnn_tmat_storage_bytes(rows, cols, INTNN_DTYPE_UINT8);
+}
+
+// 列出各中间矩阵及其存活区间，返回个数
+static int intnn_net_collect_buffers(const intnn_net* net, int maxBatch, intnn_net_mem_mode mode, intnn_net_buffer* bufs) {
+    const int n = net->mNumLayers;
+    int count = 0;
+    for (int k = 0; k < n; ++k) {
+        intnn_fc_layer* l = net->mLayers[k];
+        if (mode == INTNN_NET_MEM_INFERENCE) {
+            // 第 k 层输出由第 k+1 层读取（最后一层输出留给调用方，存活到时刻 n）；
+            // 推理前向对逐元素激活只写 mOutput，softmax 层才需要 mInter / mActvGradInv 作为本层临时量
+            if (!intnn_actv_is_elementwise(l->mActv)) {
+                intnn_net_add_buffer(bufs, &count, &l->mInter, maxBatch, l->mOutDim, k, k);
+                intnn_net_add_buffer(bufs, &count, &l->mActvGradInv, maxBatch, l->mOutDim, k, k);
+            }
+            intnn_net_add_buffer(bufs, &count, &l->mOutput, maxBatch, l->mOutDim, k, k + 1);
+        } else {
+            // 训练：输出（下一层更新的输入）与激活梯度保留到反向；误差和更新只在反向时刻存活
+            intnn_net_add_buffer(bufs, &count, &l->mInter, maxBatch, l->mOutDim, k, k);
+            if (intnn_actv_has_grad_code(l->mActv))
+                intnn_net_add_code_buffer(bufs, &count, &l->mActvGradCode, maxBatch, l->mOutDim, k, n);
+            else
+                intnn_net_add_buffer(bufs, &count, &l->mActvGradInv, maxBatch, l->mOutDim, k, n);
+            intnn_net_add_buffer(bufs, &count, &l->mOutput, maxBatch, l->mOutDim, k, n);
+            intnn_net_add_buffer(bufs, &count, &l->mDeltas, maxBatch, l->mOutDim, n, n);
+            intnn_net_add_buffer(bufs, &count, &l->mWeightUpdate, l->mInDim, l->mOutDim, n, n);
+            intnn_net_add_buffer(bufs, &count, &l->mBiasUpdate, 1, l->mOutDim, n, n);
+        }
+    }
+    return count;
+}
+
+// 按大小从大到小依次放到与之同时存活的矩阵都不冲突的最低偏移，返回峰值字节数
+static size_t intnn_net_assign_offsets(intnn_net_buffer* bufs, int count) {
+    int* order = (int*)malloc(sizeof(int) * count);
+    if (!order)
+        assert(0);
+    for (int i = 0; i < count; ++i) {
+        int j = i;
+        while (j > 0 && bufs[order[j - 1]].mBytes < bufs[i].mBytes) {
+            order[j] = order[j - 1];
+            --j;
+        }
+        order[j] = i;
+    }
+
+    size_t peak = 0;
+    for (int i = 0; i < count; ++i) {
+        intnn_net_buffer* b = &bufs[order[i]];
+        size_t offset = 0;
+        bool moved = true;
+        while (moved) {
+            moved = false;
+            for (int j = 0; j < i; ++j) {
+                const intnn_net_buffer* p = &bufs[order[j]];
+                const bool liveTogether = b->mFirst <= p->mLast && p->mFirst <= b->mLast;
+                if (liveTogether && offset < p->mOffset + p->mBytes && p->mOffset < offset + b->mBytes) {
+                    offset = p->mOffset + p->mBytes;
+                    moved = true;
+                }
+            }
+        }
+        b->mOffset = offset;
+        if (offset + b->mBytes > peak)
+            peak = offset + b->mBytes;
+    }
+    free(order);
+    return peak;
+}
+
+size_t intnn_net_memory_required(const intnn_net* net, int maxBatch, intnn_net_mem_mode mode) {
+    assert(net != NULL && net->mNumLayers > 0 && maxBatch > 0 && mode != INTNN_NET_MEM_NONE);
+    intnn_net_buffer* bufs = (intnn_net_buffer*)malloc(sizeof(intnn_net_buffer) * net->mNumLayers * INTNN_NET_BUFFERS_PER_LAYER);
+    if (!bufs)
+        assert(0);
+    const int count = intnn_net_collect_buffers(net, maxBatch, mode, bufs);
+    const size_t peak = intnn_net_assign_offsets(bufs, count);
+    free(bufs);
+    return peak;
+}
+
+size_t intnn_net_plan_memory(intnn_net* net, int maxBatch, intnn_net_mem_mode mode, void* slab, size_t slabBytes) {
+    assert(net != NULL && net->mNumLayers > 0 && maxBatch > 0 && mode != INTNN_NET_MEM_NONE);
+    intnn_net_plan_info* plan = &net->mPlan;
+    intnn_net_plan_schedule(net, maxBatch);
+
+    intnn_net_buffer* bufs = (intnn_net_buffer*)malloc(sizeof(intnn_net_buffer) * net->mNumLayers * INTNN_NET_BUFFERS_PER_LAYER);
+    if (!bufs)
+        assert(0);
+    const int count = intnn_net_collect_buffers(net, maxBatch, mode, bufs);
+    const size_t peak = intnn_net_assign_offsets(bufs, count);
+    size_t unaliased = 0;
+    for (int i = 0; i < count; ++i)
+        unaliased += bufs[i].mBytes;
+
+    char* base;
+    if (slab) {
+        // 与内存池相同：首地址向后对齐，可用容量相应减少
+        size_t pad = (INTNN_MAT_ALIGN - (size_t)slab % INTNN_MAT_ALIGN) % INTNN_MAT_ALIGN;
+        if (slabBytes < pad || slabBytes - pad < peak) {
+            printf("Memory plan needs %zu bytes, slab provides %zu\n", peak, slabBytes > pad ? slabBytes - pad : 0);
+            assert(0);
+        }
+        base = (char*)slab + pad;
+    } else {
+        base = (char*)intnn_aligned_alloc(peak);
+        if (!base)
+            assert(0);
+    }
+
+    // 先把各矩阵绑定到新 slab，再释放旧 slab（重新规划时）
+    for (int i = 0; i < count; ++i) {
+        intnn_net_buffer* b = &bufs[i];
+        if (b->mCode) {
+            if (!*b->mCode) {
+                *b->mCode = (intnn_tmat*)calloc(1, sizeof(intnn_tmat));
+                if (!*b->mCode)
+                    assert(0);
+            }
+            intnn_tmat_bind_storage(*b->mCode, base + b->mOffset, b->mRows, b->mCols, INTNN_DTYPE_UINT8);
+            continue;
+        }
+        if (!*b->mMat) {
+            *b->mMat = (intnn_mat*)calloc(1, sizeof(intnn_mat));
+            if (!*b->mMat)
+                assert(0);
+        }
+        intnn_bind_storage(*b->mMat, (int*)(base + b->mOffset), b->mRows, b->mCols);
+    }
+    free(bufs);
+
+    for (int k = 0; k < net->mNumLayers; ++k) {
+        intnn_fc_layer* l = net->mLayers[k];
+        const bool coded = intnn_actv_has_grad_code(l->mActv);
+        if (mode == INTNN_NET_MEM_INFERENCE) {
+            // 推理不需要反向用的矩阵与激活梯度编码；逐元素激活层也不需要 mInter / mActvGradInv
+            const bool elementwise = intnn_actv_is_elementwise(l->mActv);
+            intnn_mat* unused[] = { l->mDeltas, l->mDeltasTranspose, l->mDActvTranspose, l->mWeightUpdate, l->mBiasUpdate,
+                                    elementwise ? l->mInter : NULL, elementwise ? l->mActvGradInv : NULL };
+            for (size_t m = 0; m < sizeof(unused) / sizeof(unused[0]); ++m)
+                if (unused[m])
+                    intnn_free_mat(unused[m]);
+        } else if (coded && l->mActvGradInv) {
+            // 训练时可编码的激活只用移位编码，之前分配的 mActvGradInv 不再使用
+            intnn_free_mat(l->mActvGradInv);
+        }
+        if (l->mActvGradCode && (mode == INTNN_NET_MEM_INFERENCE || !coded)) {
+            intnn_free_tmat(l->mActvGradCode);
+            l->mActvGradCode = NULL;
+        }
+    }
+
+    if (plan->mOwnsSlab)
+        intnn_aligned_free(plan->mSlab);
+    plan->mSlab = base;
+    plan->mOwnsSlab = (slab == NULL);
+    plan->mMemMode = mode;
+    plan->mMaxBatch = maxBatch;
+    plan->mPeakBytes = peak;
+    plan->mUnaliasedBytes = unaliased;
+    return peak;
+}
+
+intnn_mat* intnn_net_forward(intnn_net* net, intnn_mat* x) {
+    assert(net != NULL && x != NULL);
+    if (!net->mPlan.mReady || x->mRows > net->mPlan.mMaxBatch)
+        intnn_net_plan(net, x->mRows);
+    if (x->mCols != net->mPlan.mInDim) {
+        printf("Network input dimension mismatch: x (%d, %d), expected %d columns\n", x->mRows, x->mCols, net->mPlan.mInDim);
+        assert(0);
+    }
+
+    // 按推理规划的内存没有为反向保留激活梯度，前向只能走推理路径
+    if (net->mPlan.mMemMode == INTNN_NET_MEM_INFERENCE)
+        return intnn_net_infer(net, x);
+
+    intnn_mat* in = x;
+    for (int k = 0; k < net->mNumLayers; ++k) {
+        intnn_fc_forward_layer(net->mLayers[k], in);
+        in = net->mLayers[k]->mOutput;
+    }
+    return in;
+}
+
+intnn_mat* intnn_net_infer(intnn_net* net, const intnn_mat* x) {
+    assert(net != NULL && x != NULL);
+    if (!net->mPlan.mReady || x->mRows > net->mPlan.mMaxBatch)
+        intnn_net_plan(net, x->mRows);
+    if (x->mCols != net->mPlan.mInDim) {
+        printf("Network input dimension mismatch: x (%d, %d), expected %d columns\n", x->mRows, x->mCols, net->mPlan.mInDim);
+        assert(0);
+    }
+
+    const intnn_mat* in = x;
+    for (int k = 0; k < net->mNumLayers; ++k) {
+        intnn_fc_infer_layer(net->mLayers[k], in);
+        in = net->mLayers[k]->mOutput;
+    }
+    return net->mLayers[net->mNumLayers - 1]->mOutput;
+}
+
+typedef struct {
+    intnn_fc_layer** mLayers;
+    intnn_mat* mLastDeltas;
+    int mLrInv;
+} intnn_net_backward_job;
+
+// 第 k 层的前向输入：上一层输出，第一层为 mInput
+static const intnn_mat* intnn_net_layer_input(intnn_fc_layer** layers, int k) {
+    return k > 0 ? layers[k - 1]->mOutput : layers[0]->mInput;
+}
+
+static void intnn_net_backward_task(void* ctx, int begin, int end, int tid) {
+    const intnn_net_backward_job* job = (const intnn_net_backward_job*)ctx;
+    (void)tid;
+    for (int k = begin; k < end; ++k)
+        intnn_fc_backward_layer(job->mLayers[k], intnn_net_layer_input(job->mLayers, k), job->mLastDeltas, job->mLrInv);
+}
+
+void intnn_net_backward(intnn_net* net, intnn_mat* lastDeltas, int lrInv) {
+    assert(net != NULL && lastDeltas != NULL && net->mPlan.mReady);
+    intnn_net_plan_info* plan = &net->mPlan;
+    if (plan->mMemMode == INTNN_NET_MEM_INFERENCE) {
+        printf("Network memory is planned for inference only; backward is not available\n");
+        assert(0);
+    }
+    const int n = net->mNumLayers;
+
+    if (plan->mDfaParallel) {
+        if (!plan->mDfaReady) {
+            // 与 intnn_fc_backward 相同，从后往前初始化 DFA 反馈矩阵，随机数序列与串行一致
+            for (int k = n - 2; k >= 0; --k)
+                intnn_fc_ensure_dfa_weight(net->mLayers[k], lastDeltas->mCols);
+            plan->mDfaReady = true;
+        }
+        intnn_net_backward_job job = { net->mLayers, lastDeltas, lrInv };
+        intnn_parallel_for(n, 1, intnn_net_backward_task, &job);
+        return;
+    }
+
+    for (int k = n - 1; k >= 0; --k)
+        intnn_fc_backward_layer(net->mLayers[k], intnn_net_layer_input(net->mLayers, k), lastDeltas, lrInv);
+}
+
+// 评估时每个线程的工作区：一块输入/目标、两份交替使用的层输出
+typedef struct {
+    intnn_mat mX;
+    intnn_mat mY;
+    intnn_mat mOut[2];
+    int mCorrect;
+    long long mLoss;
+} intnn_net_eval_worker;
+
+typedef struct {
+    const intnn_net* mNet;
+    int mNumSamples;
+    int mChunk;
+    intnn_eval_fill_fn mFill;
+    void* mCtx;
+    const int* mLabels;     // 非 NULL 时目标取自类别下标，回调不写 y
+    int mTarget;
+    intnn_net_eval_worker* mWorkers;
+} intnn_net_eval_job;
+
+static void intnn_net_evaluate_task(void* ctx, int begin, int end, int tid) {
+    const intnn_net_eval_job* job = (const intnn_net_eval_job*)ctx;
+    intnn_net_eval_worker* w = &job->mWorkers[tid];
+    for (int c = begin; c < end; ++c) {
+        const int start = c * job->mChunk;
+        const int stop = intnn_min(start + job->mChunk, job->mNumSamples);
+        job->mFill(job->mCtx, start, stop, &w->mX, job->mLabels ? NULL : &w->mY);
+
+        const intnn_mat* in = &w->mX;
+        for (int k = 0; k < job->mNet->mNumLayers; ++k) {
+            intnn_mat* out = &w->mOut[k & 1];
+            intnn_fc_infer_to(job->mNet->mLayers[k], in, out);
+            in = out;
+        }
+        const intnn_loss_result r = job->mLabels
+            ? intnn_batch_loss_fused_labels(NULL, in, job->mLabels + start, NULL, job->mTarget, INTNN_LOSS_L2)
+            : intnn_batch_loss_fused(NULL, &w->mY, in, INTNN_LOSS_L2);
+        w->mCorrect += r.mCorrect;
+        w->mLoss += r.mLoss;
+    }
+}
+
+static intnn_eval_result intnn_net_evaluate_impl(intnn_net* net, int numSamples, int chunk, intnn_eval_fill_fn fill,
+                                                 void* ctx, const int* labels, int target) {
+    assert(net != NULL && net->mNumLayers > 0 && chunk > 0 && fill != NULL);
+    intnn_eval_result result = { numSamples, 0, 0 };
+    if (numSamples <= 0)
+        return result;
+
+    const int numChunks = (numSamples + chunk - 1) / chunk;
+    const int parts = intnn_parallel_parts(numChunks, 1);
+    intnn_net_eval_worker* workers = (intnn_net_eval_worker*)calloc(parts, sizeof(intnn_net_eval_worker));
+    if (!workers)
+        assert(0);
+
+    // 线程池以块为单位切分；单线程时各块依次处理，块内 GEMM 仍可使用线程池
+    intnn_net_eval_job job = { net, numSamples, chunk, fill, ctx, labels, target, workers };
+    intnn_parallel_for_max(numChunks, 1, parts, intnn_net_evaluate_task, &job);
+
+    for (int t = 0; t < parts; ++t) {
+        intnn_net_eval_worker* w = &workers[t];
+        result.mCorrect += w->mCorrect;
+        result.mLoss += w->mLoss;
+        intnn_free_mat(&w->mX);
+        intnn_free_mat(&w->mY);
+        intnn_free_mat(&w->mOut[0]);
+        intnn_free_mat(&w->mOut[1]);
+    }
+    free(workers);
+    return result;
+}
+
+intnn_eval_result intnn_net_evaluate(intnn_net* net, int numSamples, int chunk, intnn_eval_fill_fn fill, void* ctx) {
+    return intnn_net_evaluate_impl(net, numSamples, chunk, fill, ctx, NULL, 0);
+}
+
+intnn_eval_result intnn_net_evaluate_labels(intnn_net* net, int numSamples, int chunk, intnn_eval_fill_fn fill, void* ctx,
+                                            const int* labels, int target) {
+    assert(labels != NULL);
+    return intnn_net_evaluate_impl(net, numSamples, chunk, fill, ctx, labels, target);
+}
+
+intnn_mat* intnn_net_output(const intnn_net* net) {
+    assert(net != NULL && net->mNumLayers > 0);
+    return net->mLayers[net->mNumLayers - 1]->mOutput;
+}
@@ -0,0 +1,277 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE  // pthread_setaffinity_np
+#endif
+#include "intnn_thread_pool.h"
+#include <assert.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Windows（MinGW）构建不链接 pthread，线程池退化为单线程
+#if !defined(_WIN32)
+#define INTNN_HAVE_PTHREADS 1
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#ifdef INTNN_HAVE_PTHREADS
+
+// 按 grain 切分后第 part 份的区间
+static void intnn_parallel_range(int n, int grain, int parts, int part, int* begin, int* end) {
+    int units = (n + grain - 1) / grain;
+    int ub = (int)((long long)units * part / parts);
+    int ue = (int)((long long)units * (part + 1) / parts);
+    *begin = ub * grain < n ? ub * grain : n;
+    *end = ue * grain < n ? ue * grain : n;
+}
+
+typedef struct {
+    pthread_t* mThreads;        // 工作线程（编号 1..mNumThreads-1）
+    int mNumThreads;            // 含调用线程
+    bool mPin;
+    bool mReady;
+    bool mStop;
+    pthread_mutex_t mLock;
+    pthread_cond_t mWake;
+    pthread_cond_t mDone;
+    unsigned mGeneration;       // 每派发一次任务加 1，工作线程据此发现新任务
+    unsigned mStartGeneration;  // 创建工作线程时的 mGeneration，线程晚于首个任务启动也不会漏掉它
+    int mPending;               // 尚未完成当前任务的工作线程数
+    // 当前任务
+    intnn_parallel_fn mFn;
+    void* mCtx;
+    int mN;
+    int mGrain;
+    int mParts;
+} intnn_thread_pool;
+
+static intnn_thread_pool gPool = {
+    NULL, 1, false, false, false,
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+    0, 0, 0, NULL, NULL, 0, 1, 1
+};
+
+// 同一时刻只派发一个并行任务；拿不到锁（嵌套或并发调用）时串行执行
+static pthread_mutex_t gDispatchLock = PTHREAD_MUTEX_INITIALIZER;
+
+static void intnn_pin_current_thread(int idx) {
+#if defined(__linux__)
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu <= 0)
+        return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET((int)(idx % ncpu), &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+        printf("[WARN] thread_pool: failed to pin thread %d\n", idx);
+#else
+    (void)idx;
+#endif
+}
+
+static void* intnn_thread_pool_worker(void* arg) {
+    const int tid = (int)(intptr_t)arg;
+    if (gPool.mPin)
+        intnn_pin_current_thread(tid);
+
+    pthread_mutex_lock(&gPool.mLock);
+    unsigned seen = gPool.mStartGeneration;
+    for (;;) {
+        while (!gPool.mStop && gPool.mGeneration == seen)
+            pthread_cond_wait(&gPool.mWake, &gPool.mLock);
+        if (gPool.mStop)
+            break;
+        seen = gPool.mGeneration;
+        intnn_parallel_fn fn = gPool.mFn;
+        void* ctx = gPool.mCtx;
+        int n = gPool.mN, grain = gPool.mGrain, parts = gPool.mParts;
+        pthread_mutex_unlock(&gPool.mLock);
+
+        if (tid < parts) {
+            int begin, end;
+            intnn_parallel_range(n, grain, parts, tid, &begin, &end);
+            if (begin < end)
+                fn(ctx, begin, end, tid);
+        }
+
+        pthread_mutex_lock(&gPool.mLock);
+        if (--gPool.mPending == 0)
+            pthread_cond_signal(&gPool.mDone);
+    }
+    pthread_mutex_unlock(&gPool.mLock);
+    return NULL;
+}
+
+static int intnn_thread_pool_default_size(void) {
+    const char* env = getenv("INTNN_NUM_THREADS");
+    if (env && atoi(env) > 0)
+        return atoi(env);
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    return ncpu > 0 ? (int)ncpu : 1;
+}
+
+// 调用方须持有 gDispatchLock
+static void intnn_thread_pool_stop_locked(void) {
+    if (!gPool.mReady)
+        return;
+    pthread_mutex_lock(&gPool.mLock);
+    gPool.mStop = true;
+    pthread_cond_broadcast(&gPool.mWake);
+    pthread_mutex_unlock(&gPool.mLock);
+    for (int i = 1; i < gPool.mNumThreads; ++i)
+        pthread_join(gPool.mThreads[i - 1], NULL);
+    free(gPool.mThreads);
+    gPool.mThreads = NULL;
+    gPool.mNumThreads = 1;
+    gPool.mStop = false;
+    gPool.mReady = false;
+}
+
+// 调用方须持有 gDispatchLock
+static void intnn_thread_pool_start_locked(int numThreads, bool pinCores) {
+    if (numThreads <= 0)
+        numThreads = intnn_thread_pool_default_size();
+    gPool.mPin = pinCores;
+    gPool.mStartGeneration = gPool.mGeneration;
+    gPool.mNumThreads = 1;
+    gPool.mThreads = NULL;
+    if (numThreads > 1) {
+        gPool.mThreads = (pthread_t*)malloc(sizeof(pthread_t) * (size_t)(numThreads - 1));
+        if (!gPool.mThreads)
+            assert(0);
+        for (int i = 1; i < numThreads; ++i) {
+            if (pthread_create(&gPool.mThreads[i - 1], NULL, intnn_thread_pool_worker, (void*)(intptr_t)i) != 0) {
+                printf("[WARN] thread_pool: created %d of %d threads\n", i, numThreads);
+                break;
+            }
+            gPool.mNumThreads = i + 1;
+        }
+    }
+    if (pinCores)
+        intnn_pin_current_thread(0);
+    gPool.mReady = true;
+}
+
+// 调用方须持有 gDispatchLock
+static void intnn_thread_pool_ensure_locked(void) {
+    if (!gPool.mReady) {
+        const char* pin = getenv("INTNN_PIN_THREADS");
+        intnn_thread_pool_start_locked(0, pin && atoi(pin) != 0);
+    }
+}
+
+void intnn_thread_pool_init(int numThreads, bool pinCores) {
+    pthread_mutex_lock(&gDispatchLock);
+    intnn_thread_pool_stop_locked();
+    intnn_thread_pool_start_locked(numThreads, pinCores);
+    pthread_mutex_unlock(&gDispatchLock);
+}
+
+void intnn_thread_pool_shutdown(void) {
+    pthread_mutex_lock(&gDispatchLock);
+    intnn_thread_pool_stop_locked();
+    pthread_mutex_unlock(&gDispatchLock);
+}
+
+int intnn_thread_pool_size(void) {
+    // 已初始化时不取派发锁：并行任务内部也会查询线程数
+    if (!gPool.mReady) {
+        pthread_mutex_lock(&gDispatchLock);
+        intnn_thread_pool_ensure_locked();
+        pthread_mutex_unlock(&gDispatchLock);
+    }
+    return gPool.mNumThreads;
+}
+
+int intnn_parallel_parts(int n, int grain) {
+    if (n <= 0)
+        return 1;
+    if (grain < 1)
+        grain = 1;
+    int units = (n + grain - 1) / grain;
+    int size = intnn_thread_pool_size();
+    return units < size ? units : size;
+}
+
+void intnn_parallel_for_max(int n, int grain, int maxParts, intnn_parallel_fn fn, void* ctx) {
+    if (n <= 0)
+        return;
+    if (grain < 1)
+        grain = 1;
+    if (pthread_mutex_trylock(&gDispatchLock) != 0) {
+        fn(ctx, 0, n, 0); // 嵌套或并发调用：串行
+        return;
+    }
+    intnn_thread_pool_ensure_locked();
+    int units = (n + grain - 1) / grain;
+    int parts = units < gPool.mNumThreads ? units : gPool.mNumThreads;
+    if (parts > maxParts)
+        parts = maxParts;
+    if (parts <= 1) {
+        pthread_mutex_unlock(&gDispatchLock);
+        fn(ctx, 0, n, 0);
+        return;
+    }
+
+    pthread_mutex_lock(&gPool.mLock);
+    gPool.mFn = fn;
+    gPool.mCtx = ctx;
+    gPool.mN = n;
+    gPool.mGrain = grain;
+    gPool.mParts = parts;
+    gPool.mPending = gPool.mNumThreads - 1;
+    gPool.mGeneration++;
+    pthread_cond_broadcast(&gPool.mWake);
+    pthread_mutex_unlock(&gPool.mLock);
+
+    int begin, end;
+    intnn_parallel_range(n, grain, parts, 0, &begin, &end);
+    fn(ctx, begin, end, 0);
+
+    pthread_mutex_lock(&gPool.mLock);
+    while (gPool.mPending > 0)
+        pthread_cond_wait(&gPool.mDone, &gPool.mLock);
+    pthread_mutex_unlock(&gPool.mLock);
+    pthread_mutex_unlock(&gDispatchLock);
+}
+
+void intnn_parallel_for(int n, int grain, intnn_parallel_fn fn, void* ctx) {
+    intnn_parallel_for_max(n, grain, INT_MAX, fn, ctx);
+}
+
+#else // !INTNN_HAVE_PTHREADS
+
+void intnn_thread_pool_init(int numThreads, bool pinCores) {
+    (void)numThreads;
+    (void)pinCores;
+}
+
+void intnn_thread_pool_shutdown(void) {
+}
+
+int intnn_thread_pool_size(void) {
+    return 1;
+}
+
+int intnn_parallel_parts(int n, int grain) {
+    (void)n;
+    (void)grain;
+    return 1;
+}
+
+void intnn_parallel_for_max(int n, int grain, int maxParts, intnn_parallel_fn fn, void* ctx) {
+    (void)grain;
+    (void)maxParts;
+    if (n > 0)
+        fn(ctx, 0, n, 0);
+}
+
+void intnn_parallel_for(int n, int grain, intnn_parallel_fn fn, void* ctx) {
+    intnn_parallel_for_max(n, grain, INT_MAX, fn, ctx);
+}
+
+#endif // INTNN_HAVE_PTHREADS
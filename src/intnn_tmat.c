@@ -0,0 +1,359 @@
+#include "intnn_tmat.h"
+#include "intnn_gemm.h"
+#include "intnn_tools.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 元素字节数
+int intnn_dtype_size(intnn_dtype type) {
+    switch (type) {
+        case INTNN_DTYPE_INT8:
+        case INTNN_DTYPE_UINT8:
+            return 1;
+        case INTNN_DTYPE_INT16:
+            return 2;
+        default:
+            return 4;
+    }
+}
+
+// 类型可表示的最小值
+int intnn_dtype_min(intnn_dtype type) {
+    switch (type) {
+        case INTNN_DTYPE_INT8:
+            return INT8_MIN;
+        case INTNN_DTYPE_UINT8:
+            return 0;
+        case INTNN_DTYPE_INT16:
+            return INT16_MIN;
+        default:
+            return INT32_MIN;
+    }
+}
+
+// 类型可表示的最大值
+int intnn_dtype_max(intnn_dtype type) {
+    switch (type) {
+        case INTNN_DTYPE_INT8:
+            return INT8_MAX;
+        case INTNN_DTYPE_UINT8:
+            return UINT8_MAX;
+        case INTNN_DTYPE_INT16:
+            return INT16_MAX;
+        default:
+            return INT32_MAX;
+    }
+}
+
+// 饱和到类型范围
+static int intnn_dtype_saturate(intnn_dtype type, int val) {
+    return intnn_min(intnn_max(val, intnn_dtype_min(type)), intnn_dtype_max(type));
+}
+
+// 计算行跨度：每行字节数向上取整到 INTNN_MAT_ALIGN
+static int intnn_tmat_aligned_stride(int cols, intnn_dtype type) {
+    const int unit = INTNN_MAT_ALIGN / intnn_dtype_size(type);
+    return (cols + unit - 1) / unit * unit;
+}
+
+// 分配对齐存储并清零
+static bool intnn_tmat_alloc_storage(intnn_tmat* tmat, int rows, int cols, intnn_dtype type) {
+    int stride = intnn_tmat_aligned_stride(cols, type);
+    size_t bytes = (size_t)rows * stride * intnn_dtype_size(type);
+    void* data = intnn_aligned_alloc(bytes);
+    if (!data)
+        return false;
+    memset(data, 0, bytes);
+
+    tmat->mRows = rows;
+    tmat->mCols = cols;
+    tmat->mStride = stride;
+    tmat->mCapRows = rows;
+    tmat->mType = type;
+    tmat->mData = data;
+    tmat->mDeleteOnDestruct = true;
+    return true;
+}
+
+// 释放存储（仅当拥有该存储时）
+static void intnn_tmat_release_storage(intnn_tmat* tmat) {
+    if (tmat->mDeleteOnDestruct && tmat->mData)
+        intnn_aligned_free(tmat->mData);
+    tmat->mData = NULL;
+    tmat->mCapRows = 0;
+}
+
+// 第 r 行起始地址
+static void* intnn_tmat_row(const intnn_tmat* tmat, int r) {
+    return (char*)tmat->mData + (size_t)r * tmat->mStride * intnn_dtype_size(tmat->mType);
+}
+
+// 把第 r 行拓宽写入 int 数组
+static void intnn_tmat_widen_row(int* dst, const intnn_tmat* tmat, int r) {
+    const void* src = intnn_tmat_row(tmat, r);
+    const int cols = tmat->mCols;
+    switch (tmat->mType) {
+        case INTNN_DTYPE_INT8:
+            for (int c = 0; c < cols; ++c)
+                dst[c] = ((const int8_t*)src)[c];
+            break;
+        case INTNN_DTYPE_UINT8:
+            for (int c = 0; c < cols; ++c)
+                dst[c] = ((const uint8_t*)src)[c];
+            break;
+        case INTNN_DTYPE_INT16:
+            for (int c = 0; c < cols; ++c)
+                dst[c] = ((const int16_t*)src)[c];
+            break;
+        default:
+            memcpy(dst, src, sizeof(int) * cols);
+            break;
+    }
+}
+
+// 创建矩阵，所有元素初始化为0
+intnn_tmat* intnn_create_tmat(int rows, int cols, intnn_dtype type) {
+    if (rows <= 0 || cols <= 0)
+        return NULL;
+
+    intnn_tmat* tmat = (intnn_tmat*)malloc(sizeof(intnn_tmat));
+    if (!tmat)
+        return NULL;
+
+    if (!intnn_tmat_alloc_storage(tmat, rows, cols, type)) {
+        free(tmat);
+        return NULL;
+    }
+    return tmat;
+}
+
+// 释放矩阵（连同结构体）
+void intnn_free_tmat(intnn_tmat* tmat) {
+    if (!tmat)
+        assert(0);
+    intnn_tmat_release_storage(tmat);
+    free(tmat);
+}
+
+// 重新设置尺寸与类型并清零（尺寸、类型不变时复用原存储，否则释放旧数据）
+void intnn_tmat_reset_zero(intnn_tmat* tmat, int rows, int cols, intnn_dtype type) {
+    if (!tmat || rows <= 0 || cols <= 0)
+        assert(0);
+    if (tmat->mData && tmat->mDeleteOnDestruct && tmat->mRows == rows &&
+        tmat->mCols == cols && tmat->mType == type) {
+        memset(tmat->mData, 0, (size_t)rows * tmat->mStride * intnn_dtype_size(type));
+        return;
+    }
+    intnn_tmat_release_storage(tmat);
+    if (!intnn_tmat_alloc_storage(tmat, rows, cols, type))
+        assert(0);
+}
+
+// 以 INT32 类型借用 intnn_mat 的存储，不拷贝数据
+void intnn_tmat_view_of_mat(intnn_tmat* view, const intnn_mat* mat) {
+    if (!view || !mat)
+        assert(0);
+    view->mRows = mat->mRows;
+    view->mCols = mat->mCols;
+    view->mStride = mat->mStride;
+    view->mCapRows = 0;
+    view->mType = INTNN_DTYPE_INT32;
+    view->mData = mat->mData;
+    view->mDeleteOnDestruct = false;
+}
+
+// 调整尺寸，不清零：类型不变且行数不超过 mCapRows、列数不超过 mStride 时复用原存储
+void intnn_tmat_resize(intnn_tmat* tmat, int rows, int cols, intnn_dtype type) {
+    if (!tmat || rows <= 0 || cols <= 0)
+        assert(0);
+    if (tmat->mData && tmat->mType == type && rows <= tmat->mCapRows && cols <= tmat->mStride) {
+        tmat->mRows = rows;
+        tmat->mCols = cols;
+        return;
+    }
+    intnn_tmat_release_storage(tmat);
+    if (!intnn_tmat_alloc_storage(tmat, rows, cols, type))
+        assert(0);
+}
+
+size_t intnn_tmat_storage_bytes(int rows, int cols, intnn_dtype type) {
+    return (size_t)rows * intnn_tmat_aligned_stride(cols, type) * intnn_dtype_size(type);
+}
+
+// 绑定外部对齐存储：不拥有、不清零，容量内调整尺寸原地复用
+void intnn_tmat_bind_storage(intnn_tmat* tmat, void* data, int capRows, int cols, intnn_dtype type) {
+    if (!tmat || !data || capRows <= 0 || cols <= 0)
+        assert(0);
+    if ((size_t)data % INTNN_MAT_ALIGN != 0) {
+        printf("[WARN] tmat_bind_storage: data is not %d-byte aligned\n", INTNN_MAT_ALIGN);
+        assert(0);
+    }
+    intnn_tmat_release_storage(tmat);
+    tmat->mRows = capRows;
+    tmat->mCols = cols;
+    tmat->mStride = intnn_tmat_aligned_stride(cols, type);
+    tmat->mCapRows = capRows;
+    tmat->mType = type;
+    tmat->mData = data;
+    tmat->mDeleteOnDestruct = false;
+}
+
+// 获取单个元素
+int intnn_tmat_get_elem(const intnn_tmat* tmat, int r, int c) {
+    if (!tmat || r < 0 || r >= tmat->mRows || c < 0 || c >= tmat->mCols)
+        assert(0);
+    const void* row = intnn_tmat_row(tmat, r);
+    switch (tmat->mType) {
+        case INTNN_DTYPE_INT8:
+            return ((const int8_t*)row)[c];
+        case INTNN_DTYPE_UINT8:
+            return ((const uint8_t*)row)[c];
+        case INTNN_DTYPE_INT16:
+            return ((const int16_t*)row)[c];
+        default:
+            return ((const int32_t*)row)[c];
+    }
+}
+
+// 设置单个元素，超出类型范围时饱和
+void intnn_tmat_set_elem(intnn_tmat* tmat, int r, int c, int val) {
+    if (!tmat || r < 0 || r >= tmat->mRows || c < 0 || c >= tmat->mCols)
+        assert(0);
+    void* row = intnn_tmat_row(tmat, r);
+    val = intnn_dtype_saturate(tmat->mType, val);
+    switch (tmat->mType) {
+        case INTNN_DTYPE_INT8:
+            ((int8_t*)row)[c] = (int8_t)val;
+            break;
+        case INTNN_DTYPE_UINT8:
+            ((uint8_t*)row)[c] = (uint8_t)val;
+            break;
+        case INTNN_DTYPE_INT16:
+            ((int16_t*)row)[c] = (int16_t)val;
+            break;
+        default:
+            ((int32_t*)row)[c] = val;
+            break;
+    }
+}
+
+// 有效数据占用的字节数（不含行尾填充）
+size_t intnn_tmat_num_bytes(const intnn_tmat* tmat) {
+    if (!tmat)
+        assert(0);
+    return (size_t)tmat->mRows * tmat->mCols * intnn_dtype_size(tmat->mType);
+}
+
+void intnn_tmat_set_all_constant(intnn_tmat* tmat, int val) {
+    if (!tmat)
+        assert(0);
+    for (int r = 0; r < tmat->mRows; ++r)
+        for (int c = 0; c < tmat->mCols; ++c)
+            intnn_tmat_set_elem(tmat, r, c, val);
+}
+
+// 逐行逐列调用 rand()，与同尺寸 intnn_mat 的 intnn_set_random 取值相同（超出类型范围时饱和）
+void intnn_tmat_set_random(intnn_tmat* tmat, bool allowZero, int minVal, int maxVal) {
+    if (!tmat || minVal > maxVal)
+        assert(0);
+    for (int r = 0; r < tmat->mRows; ++r) {
+        for (int c = 0; c < tmat->mCols; ++c) {
+            int val;
+            do {
+                val = minVal + rand() % (maxVal - minVal + 1);
+            } while (!allowZero && val == 0);
+            intnn_tmat_set_elem(tmat, r, c, val);
+        }
+    }
+}
+
+// 深拷贝（类型与尺寸相同，存储自有）
+intnn_tmat* intnn_copy_tmat(const intnn_tmat* tmat) {
+    if (!tmat)
+        assert(0);
+    intnn_tmat* copy = intnn_create_tmat(tmat->mRows, tmat->mCols, tmat->mType);
+    if (!copy)
+        assert(0);
+    const size_t rowBytes = (size_t)tmat->mCols * intnn_dtype_size(tmat->mType);
+    for (int r = 0; r < tmat->mRows; ++r)
+        memcpy(intnn_tmat_row(copy, r), intnn_tmat_row(tmat, r), rowBytes);
+    return copy;
+}
+
+void intnn_print_tmat(const intnn_tmat* tmat) {
+    for (int r = 0; r < tmat->mRows; ++r) {
+        for (int c = 0; c < tmat->mCols; ++c) {
+            printf("%d ", intnn_tmat_get_elem(tmat, r, c));
+        }
+        printf("\n");
+    }
+}
+
+// 由 int 矩阵收窄（饱和）到 out 的元素类型，尺寸不符时重新分配
+void intnn_tmat_from_mat(intnn_tmat* out, const intnn_mat* in) {
+    if (!out || !in)
+        assert(0);
+    if (out->mRows != in->mRows || out->mCols != in->mCols || !out->mData)
+        intnn_tmat_reset_zero(out, in->mRows, in->mCols, out->mType);
+    for (int r = 0; r < in->mRows; ++r) {
+        const int* src = INTNN_MAT_ROW(in, r);
+        for (int c = 0; c < in->mCols; ++c)
+            intnn_tmat_set_elem(out, r, c, src[c]);
+    }
+}
+
+// 拓宽到 int 矩阵
+void intnn_tmat_to_mat(intnn_mat* out, const intnn_tmat* in) {
+    if (!out || !in)
+        assert(0);
+    intnn_reset_zero(out, in->mRows, in->mCols);
+    for (int r = 0; r < in->mRows; ++r)
+        intnn_tmat_widen_row(INTNN_MAT_ROW(out, r), in, r);
+}
+
+// 按索引表 indices[start, end) 取行并拓宽到 int 矩阵
+void intnn_tmat_indexed_slice_to_mat(intnn_mat* out,
+                                     const intnn_tmat* in,
+                                     int* indices,
+                                     int start,
+                                     int end) {
+    if (!out || !in || start < 0 || end > in->mRows || start >= end)
+        assert(0);
+    int size = end - start;
+    intnn_resize(out, size, in->mCols); // 预分配的 out 直接复用，每行都会被完整覆盖
+    for (int r = 0; r < size; ++r) {
+        int idx = indices[start + r];
+        if (idx < 0 || idx >= in->mRows)
+            assert(0);
+        intnn_tmat_widen_row(INTNN_MAT_ROW(out, r), in, idx);
+    }
+}
+
+// 取连续行 [start, end) 并拓宽到 int 矩阵
+void intnn_tmat_rows_to_mat(intnn_mat* out, const intnn_tmat* in, int start, int end) {
+    if (!out || !in || start < 0 || end > in->mRows || start >= end)
+        assert(0);
+    int size = end - start;
+    intnn_resize(out, size, in->mCols);
+    for (int r = 0; r < size; ++r)
+        intnn_tmat_widen_row(INTNN_MAT_ROW(out, r), in, start + r);
+}
+
+// 混合位宽矩阵乘法：窄类型在 GEMM 打包阶段拓宽，int32 累加
+void intnn_tmat_mul_tmat(intnn_mat* out, const intnn_tmat* a, const intnn_tmat* b) {
+    if (!out || !a || !b)
+        assert(0);
+    if (a->mCols != b->mRows) {
+        printf("[ERROR] tmat_mul_tmat: dimension mismatch (%d x %d) * (%d x %d)\n",
+               a->mRows, a->mCols, b->mRows, b->mCols);
+        assert(0);
+    }
+    if (out->mRows != a->mRows || out->mCols != b->mCols || !out->mData)
+        intnn_reset_zero(out, a->mRows, b->mCols);
+
+    intnn_gemm_operand opA = { a->mData, a->mStride, a->mType, false };
+    intnn_gemm_operand opB = { b->mData, b->mStride, b->mType, false };
+    intnn_gemm_ex(out, &opA, &opB, a->mCols, NULL);
+}
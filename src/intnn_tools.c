@@ -1,4 +1,9 @@
 #include "intnn_tools.h"
+#include <time.h>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
 
 int intnn_max(int a, int b) {
     return a > b ? a : b;
@@ -73,6 +78,15 @@ int intnn_round_to_unit(int n, int unit) {
     return (n - a > b - n) ? b : a;
 }
 
+int intnn_exact_log2(int x) {
+    if (x <= 0 || (x & (x - 1)) != 0)
+        return -1;
+    int shift = 0;
+    while ((1 << shift) != x)
+        ++shift;
+    return shift;
+}
+
 void intnn_tools_shuffle_indices(int* indices, int size) {
     for (int i = size - 1; i > 0; --i) {
         int j = intnn_random_range(0, i);
@@ -81,3 +95,36 @@ void intnn_tools_shuffle_indices(int* indices, int size) {
         indices[j] = temp;
     }
 }
+
+void* intnn_aligned_alloc(size_t bytes) {
+    if (bytes == 0)
+        bytes = INTNN_MAT_ALIGN;
+#ifdef _WIN32
+    return _aligned_malloc(bytes, INTNN_MAT_ALIGN);
+#else
+    void* ptr = NULL;
+    if (posix_memalign(&ptr, INTNN_MAT_ALIGN, bytes) != 0)
+        return NULL;
+    return ptr;
+#endif
+}
+
+void intnn_aligned_free(void* ptr) {
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+double intnn_wall_seconds(void) {
+#ifdef _WIN32
+    // Windows 的 clock() 即为墙钟时间
+    return (double)clock() / CLOCKS_PER_SEC;
+#else
+    // clock() 统计全部线程的 CPU 时间，多线程时不能反映耗时
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
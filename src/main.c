@@ -1,6 +1,10 @@
+#include <string.h>
 #include "intnn_examples.h"
 
-int main(){
+int main(int argc, char** argv){
+    // ./main bench-actv：只运行激活微基准
+    if (argc > 1 && strcmp(argv[1], "bench-actv") == 0)
+        return example_intnn_bench_actv();
     example_intnn_fc_dfa_mnist();
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,101 @@
+#ifndef INTNN_TEST_TOY_H
+#define INTNN_TEST_TOY_H
+
+// 流水线与 Hogwild 测试共用的小网络与数据：3 层 DFA 全连接 10 -> 8 -> 6 -> 4，NUM_BATCHES 批随机样本
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "intnn_fc_layer.h"
+#include "intnn_loss.h"
+#include "intnn_mat.h"
+
+#define NUM_BATCHES 12
+#define BATCH 5
+
+typedef struct {
+    intnn_mat* mX[NUM_BATCHES];
+    intnn_mat* mY[NUM_BATCHES];
+} toy_batches;
+
+static void toy_batches_init(toy_batches* b) {
+    srand(99);
+    for (int i = 0; i < NUM_BATCHES; i++) {
+        b->mX[i] = intnn_create_mat(BATCH, 10);
+        b->mY[i] = intnn_create_mat(BATCH, 4);
+        intnn_set_random(b->mX[i], true, 0, 255);
+        intnn_set_random(b->mY[i], true, -127, 127);
+    }
+}
+
+static void toy_batches_free(toy_batches* b) {
+    for (int i = 0; i < NUM_BATCHES; i++) {
+        intnn_free_mat(b->mX[i]); intnn_free_mat(b->mY[i]);
+        free(b->mX[i]); free(b->mY[i]);
+    }
+}
+
+// 第 batch 批输入复制到 x
+static void toy_copy_input(const toy_batches* b, int batch, intnn_mat* x) {
+    intnn_resize(x, b->mX[batch]->mRows, b->mX[batch]->mCols);
+    for (int r = 0; r < x->mRows; r++)
+        memcpy(INTNN_MAT_ROW(x, r), INTNN_MAT_ROW(b->mX[batch], r), sizeof(int) * x->mCols);
+}
+
+static void build_net(intnn_fc_layer* fc[3]) {
+    srand(7);
+    fc[0] = intnn_fc_create(10, 8);
+    fc[1] = intnn_fc_create(8, 6);
+    fc[2] = intnn_fc_create(6, 4);
+    for (int i = 0; i < 3; i++) {
+        intnn_fc_use_dfa(fc[i], true);
+        intnn_tmat_set_random(fc[i]->mWeight, true, -500, 500);
+        if (i > 0) {
+            fc[i - 1]->mNext = fc[i];
+            fc[i]->mPrev = fc[i - 1];
+        }
+    }
+    // 两个网络的 DFA 反馈矩阵在相同的随机数状态下生成
+    intnn_fc_ensure_dfa_weight(fc[1], 4);
+    intnn_fc_ensure_dfa_weight(fc[0], 4);
+}
+
+static void free_net(intnn_fc_layer* fc[3]) {
+    for (int i = 0; i < 3; i++) {
+        intnn_fc_free(fc[i]);
+        free(fc[i]);
+    }
+}
+
+static bool nets_equal(intnn_fc_layer* a[3], intnn_fc_layer* b[3]) {
+    for (int i = 0; i < 3; i++) {
+        const intnn_tmat* wa = a[i]->mWeight;
+        const intnn_tmat* wb = b[i]->mWeight;
+        if (wa->mRows != wb->mRows || wa->mCols != wb->mCols || wa->mType != wb->mType)
+            return false;
+        const size_t rowBytes = (size_t)wa->mCols * intnn_dtype_size(wa->mType);
+        for (int r = 0; r < wa->mRows; r++)
+            if (memcmp((const char*)wa->mData + (size_t)r * wa->mStride * intnn_dtype_size(wa->mType),
+                       (const char*)wb->mData + (size_t)r * wb->mStride * intnn_dtype_size(wb->mType), rowBytes) != 0)
+                return false;
+        if (!intnn_dims_equal(a[i]->mBias, b[i]->mBias) ||
+            memcmp(INTNN_MAT_ROW(a[i]->mBias, 0), INTNN_MAT_ROW(b[i]->mBias, 0), sizeof(int) * a[i]->mBias->mCols) != 0)
+            return false;
+    }
+    return true;
+}
+
+// 参照：逐批串行训练（intnn_fc_forward + intnn_fc_backward），学习率倒数 50
+static void train_sequential(intnn_fc_layer* fc[3], const toy_batches* b) {
+    intnn_mat* delta = intnn_create_mat(BATCH, 4);
+    for (int i = 0; i < NUM_BATCHES; i++) {
+        intnn_fc_forward(fc[0], b->mX[i]);
+        intnn_batch_l2_loss_delta(delta, b->mY[i], intnn_fc_get_output(fc[2]));
+        intnn_fc_backward(fc[2], delta, 50);
+    }
+    intnn_free_mat(delta);
+    free(delta);
+}
+
+#endif // INTNN_TEST_TOY_H
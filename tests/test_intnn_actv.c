@@ -2,6 +2,8 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <limits.h>
+#include <stdbool.h>
+#include <string.h>
 #include "intnn_mat.h"
 #include "intnn_mat3d.h"
 #include "intnn_actv.h"
@@ -500,11 +502,139 @@ void test_activate_3d() {
     printf("3D General Activation: PASSED\n\n");
 }
 
+// 查表前的分段定义：sigmoid / tanh 的逐分支计算
+static int pwl_branch(bool isTanh, int x, int* grad) {
+    static const int joints[] = { -127, -74, -31, 32, 75, 128 };
+    static const int slopesInv[] = { 127, 8, 2, 1, 2, 8, 127 };
+    int seg = 0;
+    while (seg < 6 && x >= joints[seg])
+        seg++;
+    *grad = slopesInv[seg];
+    if (seg == 0)
+        return isTanh ? -127 : 1;
+    if (seg == 6)
+        return 127;
+    int y;
+    if (isTanh) {
+        switch (seg) {
+            case 1: y = x / 4 - 88; break;
+            case 2: y = x - 32; break;
+            case 3: y = 2 * x; break;
+            case 4: y = x + 32; break;
+            default: y = x / 4 + 88; break;
+        }
+        return y < -127 ? -127 : (y > 127 ? 127 : y);
+    }
+    switch (seg) {
+        case 1: y = x / 8 + 20; break;
+        case 2: y = x / 2 + 48; break;
+        case 3: y = x + 64; break;
+        case 4: y = x / 2 + 80; break;
+        default: y = x / 8 + 108; break;
+    }
+    return y < 1 ? 1 : (y > 127 ? 127 : y);
+}
+
+// 查找表激活须与逐分支计算逐位一致（含饱和区与极端输入）
+void test_pwl_lut_matches_branches() {
+    print_test_header("PWL Table vs Branches");
+    enum { N = 1003 };
+    static int in[N], out[N], grad[N], outCoded[N];
+    static uint8_t code[N];
+    for (int i = 0; i < N - 2; i++)
+        in[i] = i - 500;
+    in[N - 2] = INT_MIN + 1;
+    in[N - 1] = INT_MAX;
+    for (int t = 0; t < 2; t++) {
+        const bool isTanh = t == 1;
+        const intnn_actv_type actv = isTanh ? INTNN_ACTV_TANH : INTNN_ACTV_SIGMOID;
+        intnn_activate_row(out, grad, in, N, actv, 0, 1); // k = 0、numItems = 1：缩放后的输入即 in
+        intnn_activate_row_code(outCoded, code, in, N, actv, 0, 1);
+        bool same = true;
+        for (int i = 0; i < N; i++) {
+            int g;
+            const int y = pwl_branch(isTanh, in[i], &g);
+            same = same && out[i] == y && grad[i] == g && outCoded[i] == y && intnn_grad_code_inv(code[i]) == g;
+        }
+        assert(same);
+        printf("%s table matches branches\n", isTanh ? "Tanh" : "Sigmoid");
+    }
+
+    printf("PWL Table vs Branches: PASSED\n\n");
+}
+
+// SIMD 激活须与标量实现逐位一致：各模式的输出、梯度倒数与移位编码（含不足一个向量的尾部）
+void test_actv_kernels_match_scalar() {
+    print_test_header("SIMD Kernels vs Scalar");
+    const char* original = intnn_actv_kernel_name();
+    if (!intnn_actv_set_kernel("avx2")) {
+        printf("AVX2 activations unsupported, skipped\n");
+        return;
+    }
+    const intnn_actv_type types[] = {
+        INTNN_ACTV_SIGMOID, INTNN_ACTV_TANH, INTNN_ACTV_RESCALE,
+        INTNN_ACTV_RELU8BIT, INTNN_ACTV_LEAKYRELU, INTNN_ACTV_PLU, INTNN_ACTV_AS_IS
+    };
+    enum { N = 1003 };
+    static int in[N], out[2][N], grad[2][N], outNg[2][N], outCd[2][N];
+    static uint8_t code[2][N];
+    for (int i = 0; i < N; i++) {
+        const int range = i % 3 == 0 ? 300 : (i % 3 == 1 ? 70000 : 1 << 30);
+        in[i] = (int)(((long long)rand() * RAND_MAX + rand()) % (2LL * range + 1) - range);
+    }
+    in[0] = SHRT_MIN; in[1] = SHRT_MIN - 1; in[2] = SHRT_MAX; in[3] = SHRT_MAX - 1; in[4] = 0; in[5] = -1;
+    in[6] = INT_MAX - 1; in[7] = INT_MIN + 2; // plu 计算 x ± 1，留出余量避免溢出
+    for (int t = 0; t < (int)(sizeof(types) / sizeof(types[0])); t++) {
+        const bool coded = intnn_actv_has_grad_code(types[t]);
+        for (int v = 0; v < 2; v++) {
+            intnn_actv_set_kernel(v == 0 ? "scalar" : "avx2");
+            intnn_activate_row(out[v], grad[v], in, N, types[t], INTNN_K_BIT, 300);
+            intnn_activate_row_nograd(outNg[v], in, N, types[t], INTNN_K_BIT, 300);
+            if (coded)
+                intnn_activate_row_code(outCd[v], code[v], in, N, types[t], INTNN_K_BIT, 300);
+        }
+        bool same = memcmp(out[0], out[1], sizeof(out[0])) == 0 && memcmp(grad[0], grad[1], sizeof(grad[0])) == 0 &&
+                    memcmp(outNg[0], outNg[1], sizeof(outNg[0])) == 0 && memcmp(outNg[1], out[1], sizeof(out[1])) == 0;
+        if (coded)
+            same = same && memcmp(outCd[0], outCd[1], sizeof(outCd[0])) == 0 && memcmp(code[0], code[1], sizeof(code[0])) == 0;
+        printf("AVX2 activation %d matches scalar: %s\n", (int)types[t], same ? "yes" : "NO");
+        assert(same);
+    }
+
+    intnn_mat* x = intnn_create_mat(5, 37);
+    intnn_mat* y[2] = { intnn_create_mat(5, 37), intnn_create_mat(5, 37) };
+    intnn_mat* g[2] = { intnn_create_mat(5, 37), intnn_create_mat(5, 37) };
+    intnn_set_random(x, true, -40, 40);
+    for (int v = 0; v < 2; v++) {
+        intnn_actv_set_kernel(v == 0 ? "scalar" : "avx2");
+        intnn_activate(y[v], x, g[v], INTNN_ACTV_SOFTMAX, INTNN_K_BIT, 37);
+    }
+    bool same = true;
+    for (int r = 0; r < 5; r++)
+        for (int c = 0; c < 37; c++)
+            same = same && intnn_get_elem(y[0], r, c) == intnn_get_elem(y[1], r, c)
+                        && intnn_get_elem(g[0], r, c) == intnn_get_elem(g[1], r, c);
+    assert(same);
+    intnn_actv_set_kernel(original);
+
+    intnn_free_mat(x); free(x);
+    for (int v = 0; v < 2; v++) {
+        intnn_free_mat(y[v]); intnn_free_mat(g[v]);
+        free(y[v]); free(g[v]);
+    }
+
+    printf("SIMD Kernels vs Scalar: PASSED\n\n");
+}
+
 // ====================== Ժ ======================
 
 int main() {
     printf("=== Starting Integer Neural Network Activation Tests ===\n\n");
     
+    // 查找表与 SIMD 实现（放在最前，不受后面基线用例的影响）
+    test_pwl_lut_matches_branches();
+    test_actv_kernels_match_scalar();
+    
     // 2D
     test_sigmoid_2d();
     test_tanh_2d();
@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "intnn_arena.h"
+#include "intnn_mat.h"
+#include "intnn_fc_layer.h"
+
+#define TEST_ASSERT(cond, msg)        \
+    if (!(cond)) {                    \
+        printf("[FAILED] %s\n", msg); \
+        exit(1);                      \
+    } else {                          \
+        printf("[PASSED] %s\n", msg); \
+    }
+
+void test_arena_alloc_reset() {
+    intnn_arena* arena = intnn_create_arena(4096);
+    TEST_ASSERT(arena != NULL && arena->mCapacity >= 4096, "Create arena");
+
+    char* a = (char*)intnn_arena_alloc(arena, 10);
+    char* b = (char*)intnn_arena_alloc(arena, 100);
+    TEST_ASSERT(((uintptr_t)a % INTNN_MAT_ALIGN) == 0 && ((uintptr_t)b % INTNN_MAT_ALIGN) == 0, "Allocations aligned");
+    TEST_ASSERT(b >= a + 10, "Allocations do not overlap");
+    size_t used = intnn_arena_used(arena);
+
+    size_t mark = intnn_arena_mark(arena);
+    intnn_arena_alloc(arena, 1000);
+    intnn_arena_rewind(arena, mark);
+    TEST_ASSERT(intnn_arena_used(arena) == used, "Rewind returns to mark");
+    TEST_ASSERT(intnn_arena_high_water(arena) >= used + 1000, "High water keeps peak");
+
+    intnn_arena_reset(arena);
+    TEST_ASSERT(intnn_arena_used(arena) == 0, "Reset empties arena");
+    TEST_ASSERT(intnn_arena_alloc(arena, 10) == a, "Reset reuses from start");
+
+    intnn_free_arena(arena);
+}
+
+void test_arena_user_buffer() {
+    static char buffer[1000];
+    intnn_arena arena;
+    intnn_arena_init(&arena, buffer + 1, sizeof(buffer) - 1);
+    TEST_ASSERT(((uintptr_t)arena.mBase % INTNN_MAT_ALIGN) == 0, "User buffer base aligned");
+    TEST_ASSERT(arena.mBase >= buffer + 1 && arena.mBase + arena.mCapacity <= buffer + sizeof(buffer),
+                "User buffer capacity stays inside buffer");
+    void* p = intnn_arena_alloc(&arena, 64);
+    TEST_ASSERT(p == arena.mBase, "User buffer allocation");
+}
+
+void test_arena_bound_mats() {
+    intnn_mat* heapMat = intnn_create_mat(2, 2);
+    TEST_ASSERT(heapMat->mDeleteOnDestruct, "Unbound create uses heap");
+
+    intnn_arena* arena = intnn_create_arena(1 << 16);
+    TEST_ASSERT(intnn_arena_bind(arena) == NULL && intnn_arena_active() == arena, "Bind arena");
+
+    intnn_mat* tmp = intnn_create_mat(3, 5);
+    TEST_ASSERT(!tmp->mDeleteOnDestruct, "Bound create does not own storage");
+    TEST_ASSERT((char*)tmp->mData >= arena->mBase && (char*)tmp->mData < arena->mBase + arena->mCapacity,
+                "Bound create draws from arena");
+    TEST_ASSERT(intnn_get_elem(tmp, 2, 4) == 0, "Arena matrix zeroed");
+
+    // GEMM 打包缓冲从池中取并在返回前回退
+    intnn_mat* a = intnn_create_mat(4, 6);
+    intnn_mat* b = intnn_create_mat(6, 3);
+    intnn_mat* out = intnn_create_mat(4, 3);
+    intnn_set_all_constant(a, 2);
+    intnn_set_all_constant(b, 3);
+    size_t before = intnn_arena_used(arena);
+    size_t peakBefore = intnn_arena_high_water(arena);
+    intnn_mat_mul_mat(out, a, b);
+    TEST_ASSERT(intnn_get_elem(out, 3, 2) == 36, "GEMM correct with arena bound");
+    TEST_ASSERT(intnn_arena_used(arena) == before, "GEMM rewinds its pack buffers");
+    TEST_ASSERT(intnn_arena_high_water(arena) > peakBefore, "GEMM pack buffers counted in high water");
+
+    // 层的工作矩阵不进入内存池
+    intnn_fc_layer* fc = intnn_fc_create(6, 3);
+    intnn_fc_forward(fc, a);
+    TEST_ASSERT(fc->mOutput->mDeleteOnDestruct && fc->mInter->mDeleteOnDestruct, "Layer workspaces stay on heap");
+
+    intnn_arena_reset(arena);
+    TEST_ASSERT(intnn_arena_bind(NULL) == arena, "Unbind returns previous arena");
+    TEST_ASSERT(intnn_get_elem(fc->mOutput, 0, 0) == intnn_get_elem(fc->mOutput, 3, 0), "Layer output survives reset");
+
+    intnn_fc_free(fc);
+    free(fc);
+    intnn_free_mat(tmp); intnn_free_mat(a); intnn_free_mat(b); intnn_free_mat(out); intnn_free_mat(heapMat);
+    free(tmp); free(a); free(b); free(out); free(heapMat);
+    intnn_free_arena(arena);
+}
+
+int main() {
+    test_arena_alloc_reset();
+    test_arena_user_buffer();
+    test_arena_bound_mats();
+    printf("All tests passed!\n");
+    return 0;
+}
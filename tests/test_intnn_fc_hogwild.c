@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "intnn_fc_layer.h"
+#include "intnn_fc_hogwild.h"
+#include "intnn_loss.h"
+#include "intnn_mat.h"
+#include "intnn_test_toy.h"
+
+#define TEST_ASSERT(cond, msg)        \
+    if (!(cond)) {                    \
+        printf("[FAILED] %s\n", msg); \
+        exit(1);                      \
+    } else {                          \
+        printf("[PASSED] %s\n", msg); \
+    }
+
+typedef struct {
+    toy_batches mBatches;
+    int mSeen[NUM_BATCHES];     // 每批被处理的次数，工作线程并发递增
+    int mMaxWorker;
+} toy_data;
+
+static void toy_input(void* ctx, int worker, int batch, intnn_mat* x) {
+    (void)worker;
+    toy_copy_input(&((toy_data*)ctx)->mBatches, batch, x);
+}
+
+static void toy_loss(void* ctx, int worker, int batch, const intnn_mat* output, intnn_mat* delta) {
+    toy_data* d = (toy_data*)ctx;
+    __atomic_fetch_add(&d->mSeen[batch], 1, __ATOMIC_RELAXED);
+    int seen = __atomic_load_n(&d->mMaxWorker, __ATOMIC_RELAXED);
+    while (worker > seen && !__atomic_compare_exchange_n(&d->mMaxWorker, &seen, worker, true,
+                                                         __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+    intnn_batch_l2_loss_delta(delta, d->mBatches.mY[batch], (intnn_mat*)output);
+}
+
+static void toy_data_init(toy_data* d) {
+    toy_batches_init(&d->mBatches);
+    for (int i = 0; i < NUM_BATCHES; i++)
+        d->mSeen[i] = 0;
+    d->mMaxWorker = 0;
+}
+
+static void toy_data_free(toy_data* d) {
+    toy_batches_free(&d->mBatches);
+}
+
+static bool each_batch_once(const toy_data* d) {
+    for (int i = 0; i < NUM_BATCHES; i++)
+        if (d->mSeen[i] != 1)
+            return false;
+    return true;
+}
+
+static bool weights_in_range(intnn_fc_layer* fc[3]) {
+    for (int i = 0; i < 3; i++) {
+        for (int c = 0; c < fc[i]->mOutDim; c++) {
+            for (int r = 0; r < fc[i]->mInDim; r++)
+                if (intnn_tmat_get_elem(fc[i]->mWeight, r, c) < -32767)
+                    return false;
+            if (intnn_get_col_min(fc[i]->mBias, c) < -32767 || intnn_get_col_max(fc[i]->mBias, c) > 32767)
+                return false;
+        }
+    }
+    return true;
+}
+
+void test_hogwild_single_worker_matches_sequential() {
+    toy_data d;
+    toy_data_init(&d);
+    intnn_fc_layer* seq[3];
+    intnn_fc_layer* hog[3];
+    build_net(seq);
+    build_net(hog);
+
+    train_sequential(seq, &d.mBatches);
+
+    intnn_fc_hogwild* h = intnn_fc_hogwild_create(hog[0], 1, BATCH);
+    TEST_ASSERT(intnn_fc_hogwild_num_workers(h) == 1, "One worker reported");
+    intnn_fc_hogwild_run(h, NUM_BATCHES, 50, toy_input, toy_loss, &d);
+    intnn_fc_hogwild_free(h);
+    TEST_ASSERT(each_batch_once(&d), "Every batch processed once");
+    TEST_ASSERT(nets_equal(seq, hog), "Single worker matches sequential training");
+
+    intnn_fc_forward(hog[0], d.mBatches.mX[0]);
+    TEST_ASSERT(intnn_rows(intnn_fc_get_output(hog[2])) == BATCH, "Shared weights usable after free");
+
+    free_net(seq);
+    free_net(hog);
+    toy_data_free(&d);
+}
+
+void test_hogwild_multi_worker() {
+    toy_data d;
+    toy_data_init(&d);
+    intnn_fc_layer* fc[3];
+    intnn_fc_layer* ref[3];
+    build_net(fc);
+    build_net(ref);
+
+    intnn_fc_hogwild* h = intnn_fc_hogwild_create(fc[0], 3, BATCH);
+#if defined(_WIN32)
+    TEST_ASSERT(intnn_fc_hogwild_num_workers(h) == 1, "Falls back to one worker without threads");
+#else
+    TEST_ASSERT(intnn_fc_hogwild_num_workers(h) == 3, "Three workers reported");
+#endif
+    intnn_fc_hogwild_run(h, NUM_BATCHES, 50, toy_input, toy_loss, &d);
+    TEST_ASSERT(each_batch_once(&d), "Every batch processed exactly once across workers");
+    TEST_ASSERT(d.mMaxWorker < intnn_fc_hogwild_num_workers(h), "Worker ids in range");
+    TEST_ASSERT(!nets_equal(fc, ref), "Shared weights updated in place");
+    TEST_ASSERT(weights_in_range(fc), "Weights and biases stay clamped");
+
+    // 第二次 run 重新从第 0 批领取
+    for (int i = 0; i < NUM_BATCHES; i++)
+        d.mSeen[i] = 0;
+    intnn_fc_hogwild_run(h, NUM_BATCHES, 50, toy_input, toy_loss, &d);
+    TEST_ASSERT(each_batch_once(&d), "Trainer reusable across runs");
+    intnn_fc_hogwild_free(h);
+
+    free_net(fc);
+    free_net(ref);
+    toy_data_free(&d);
+}
+
+void test_hogwild_rejects_non_dfa() {
+    intnn_fc_layer* fc[3];
+    build_net(fc);
+    intnn_fc_use_dfa(fc[1], false);
+    TEST_ASSERT(intnn_fc_hogwild_create(fc[0], 2, BATCH) == NULL, "Non-DFA chain rejected");
+    free_net(fc);
+}
+
+int main() {
+    test_hogwild_single_worker_matches_sequential();
+    test_hogwild_multi_worker();
+    test_hogwild_rejects_non_dfa();
+    printf("All tests passed!\n");
+    return 0;
+}
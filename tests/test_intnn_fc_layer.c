@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include <string.h>
 #include "intnn_fc_layer.h"
+#include "intnn_thread_pool.h"
 #include "intnn_mat.h"
 #include "intnn_actv.h"
 
@@ -40,6 +41,8 @@ void test_create_and_free() {
     TEST_ASSERT(layer != NULL, "Layer created");
     TEST_ASSERT(layer->mInDim == 3 && layer->mOutDim == 4, "Dimensions correct");
     TEST_ASSERT(layer->mWeight != NULL && layer->mBias != NULL, "Weight and Bias allocated");
+    TEST_ASSERT(layer->mWeight->mType == INTNN_DTYPE_INT16 && layer->mWeight->mRows == 3 && layer->mWeight->mCols == 4,
+                "Weights stored as int16");
     intnn_fc_free(layer);
     free(layer);
 }
@@ -62,7 +65,7 @@ void test_random_and_he_initialization() {
     int nonzero = 0;
     for (int i = 0; i < 5; i++) {
         for (int j = 0; j < 5; j++) {
-            if (intnn_get_elem(layer->mWeight, i, j) != 0) nonzero++;
+            if (intnn_tmat_get_elem(layer->mWeight, i, j) != 0) nonzero++;
         }
     }
     TEST_ASSERT(nonzero > 0, "Random weight produced nonzero entries");
@@ -98,11 +101,11 @@ void test_forward_as_is_activation() {
 
 
     // weight = [[1,2],[3,4]]
-    intnn_mat* W = layer->mWeight;
-    intnn_set_elem(W, 0, 0, 1);
-    intnn_set_elem(W, 0, 1, 2);
-    intnn_set_elem(W, 1, 0, 3);
-    intnn_set_elem(W, 1, 1, 4);
+    intnn_tmat* W = layer->mWeight;
+    intnn_tmat_set_elem(W, 0, 0, 1);
+    intnn_tmat_set_elem(W, 0, 1, 2);
+    intnn_tmat_set_elem(W, 1, 0, 3);
+    intnn_tmat_set_elem(W, 1, 1, 4);
 
     
 
@@ -133,9 +136,9 @@ void test_backward_as_is_activation() {
     intnn_fc_layer* layer = intnn_fc_create(2, 2);
 
     // 将 weight, bias 置零
-    intnn_mat* W = layer->mWeight;
+    intnn_tmat* W = layer->mWeight;
     intnn_mat* B = layer->mBias;
-    intnn_reset_zero(W, 2, 2);
+    intnn_tmat_reset_zero(W, 2, 2, INTNN_DTYPE_INT16);
     intnn_reset_zero(B, 1, 2);
 
 
@@ -156,18 +159,21 @@ void test_backward_as_is_activation() {
 
     // 期望 weight 更新 = -1 * ([[1],[1]]·[1,1]) = [[-1,-1],[-1,-1]]
     int expectedW[] = {-1, -1, -1, -1};
-    check_mat_equal(layer->mWeight, expectedW, 4, "Backward weight updated to [[-1,-1],[-1,-1]]");
+    intnn_mat* weight = intnn_create_mat(2, 2);
+    intnn_tmat_to_mat(weight, layer->mWeight);
+    check_mat_equal(weight, expectedW, 4, "Backward weight updated to [[-1,-1],[-1,-1]]");
 
     // 期望 bias 更新 = -1 * sum([1,1]) = [-1,-1]
     int expectedB[] = {-1, -1};
     check_mat_equal(layer->mBias, expectedB, 2, "Backward bias updated to [-1,-1]");
 
     // 检查 mDeltasTranspose shape = (2,1)
-    intnn_mat* dT = layer->mDeltasTranspose;
+    intnn_mat* dT = intnn_fc_get_deltas_transpose(layer);
     TEST_ASSERT(intnn_rows(dT) == 2 && intnn_cols(dT) == 1, "DeltasTranspose shape correct (2x1)");
 
     intnn_free_mat(x);
     intnn_free_mat(lastDeltas);
+    intnn_free_mat(weight);
     intnn_fc_free(layer);
     free(layer);
 }
@@ -195,10 +201,10 @@ void test_print_functions() {
     intnn_fc_layer* layer = intnn_fc_create(2, 2);
 
     // 手动设定 weight=[[1,2],[3,4]], bias=[5,6]
-    intnn_set_elem(layer->mWeight, 0, 0, 1);
-    intnn_set_elem(layer->mWeight, 0, 1, 2);
-    intnn_set_elem(layer->mWeight, 1, 0, 3);
-    intnn_set_elem(layer->mWeight, 1, 1, 4);
+    intnn_tmat_set_elem(layer->mWeight, 0, 0, 1);
+    intnn_tmat_set_elem(layer->mWeight, 0, 1, 2);
+    intnn_tmat_set_elem(layer->mWeight, 1, 0, 3);
+    intnn_tmat_set_elem(layer->mWeight, 1, 1, 4);
     intnn_set_elem(layer->mBias, 0, 0, 5);
     intnn_set_elem(layer->mBias, 0, 1, 6);
 
@@ -224,12 +230,311 @@ void test_print_functions() {
     free(layer);
 }
 
+// 融合前向（GEMM 写回时加偏置并激活）须与分步计算逐位一致
+void test_forward_fused_matches_unfused() {
+    printf("=== test_forward_fused_matches_unfused ===\n");
+    const intnn_actv_type types[] = {
+        INTNN_ACTV_SIGMOID, INTNN_ACTV_TANH, INTNN_ACTV_RESCALE, INTNN_ACTV_SOFTMAX,
+        INTNN_ACTV_RELU8BIT, INTNN_ACTV_LEAKYRELU, INTNN_ACTV_PLU, INTNN_ACTV_AS_IS
+    };
+    char msg[96];
+    for (int t = 0; t < (int)(sizeof(types) / sizeof(types[0])); t++) {
+        intnn_fc_layer* layer = intnn_fc_create(300, 37);
+        intnn_fc_set_actv(layer, types[t]);
+        intnn_tmat_set_random(layer->mWeight, true, -2000, 2000);
+        intnn_set_random(layer->mBias, true, -30000, 30000);
+        intnn_mat* x = intnn_create_mat(7, 300);
+        intnn_set_random(x, true, -127, 127);
+
+        intnn_fc_forward(layer, x);
+
+        intnn_mat* inter = intnn_create_mat(7, 37);
+        intnn_mat* out = intnn_create_mat(7, 37);
+        intnn_mat* grad = intnn_create_mat(7, 37);
+        intnn_mat* weight = intnn_create_mat(300, 37);
+        intnn_tmat_to_mat(weight, layer->mWeight);
+        intnn_mat_mul_mat(inter, x, weight);
+        intnn_self_add_mat(inter, layer->mBias);
+        intnn_activate(out, inter, grad, types[t], INTNN_K_BIT, layer->mInDim);
+
+        bool same = true;
+        for (int r = 0; r < 7; r++)
+            for (int c = 0; c < 37; c++)
+                same = same && intnn_get_elem(inter, r, c) == intnn_get_elem(layer->mInter, r, c)
+                            && intnn_get_elem(out, r, c) == intnn_get_elem(layer->mOutput, r, c)
+                            && intnn_get_elem(grad, r, c) == (intnn_actv_has_grad_code(types[t])
+                                   ? intnn_grad_code_inv((uint8_t)intnn_tmat_get_elem(layer->mActvGradCode, r, c))
+                                   : intnn_get_elem(layer->mActvGradInv, r, c));
+        snprintf(msg, sizeof(msg), "Fused forward matches unfused (activation %d)", (int)types[t]);
+        TEST_ASSERT(same, msg);
+
+        intnn_free_mat(x); intnn_free_mat(inter); intnn_free_mat(out); intnn_free_mat(grad); intnn_free_mat(weight);
+        free(x); free(inter); free(out); free(grad); free(weight);
+        intnn_fc_free(layer);
+        free(layer);
+    }
+}
+
+// 移位编码：输出与 intnn_activate_row 相同，编码还原出相同的梯度倒数，按编码移位与整数除法逐位一致
+void test_grad_code_matches_division() {
+    printf("=== test_grad_code_matches_division ===\n");
+    const intnn_actv_type types[] = {
+        INTNN_ACTV_SIGMOID, INTNN_ACTV_TANH, INTNN_ACTV_RESCALE,
+        INTNN_ACTV_RELU8BIT, INTNN_ACTV_LEAKYRELU, INTNN_ACTV_AS_IS
+    };
+    enum { N = 4096 };
+    static int in[N], out[N], outCoded[N], grad[N], deltas[N], shifted[N];
+    static uint8_t code[N];
+    char msg[96];
+    for (int t = 0; t < (int)(sizeof(types) / sizeof(types[0])); t++) {
+        TEST_ASSERT(intnn_actv_has_grad_code(types[t]), "Activation has a gradient code");
+        for (int i = 0; i < N; i++) {
+            in[i] = (rand() % 2000001 - 1000000) * (i % 3 == 0 ? 64 : 1);
+            deltas[i] = rand() % 200001 - 100000;
+        }
+        deltas[0] = INT_MIN + 1;
+        deltas[1] = INT_MAX;
+        intnn_activate_row(out, grad, in, N, types[t], INTNN_K_BIT, 300);
+        intnn_activate_row_code(outCoded, code, in, N, types[t], INTNN_K_BIT, 300);
+        intnn_apply_grad_code_row(shifted, deltas, code, N);
+        bool same = true;
+        for (int i = 0; i < N; i++)
+            same = same && out[i] == outCoded[i] && intnn_grad_code_inv(code[i]) == grad[i]
+                        && shifted[i] == deltas[i] / grad[i];
+        snprintf(msg, sizeof(msg), "Shift codes match division (activation %d)", (int)types[t]);
+        TEST_ASSERT(same, msg);
+    }
+    TEST_ASSERT(!intnn_actv_has_grad_code(INTNN_ACTV_PLU) && !intnn_actv_has_grad_code(INTNN_ACTV_SOFTMAX),
+                "PLU and softmax keep integer gradient inverses");
+}
+
+// 融合权重更新（GEMM 写回时缩放、累加、限幅）须与分步计算逐位一致；lrInv 为 2 的幂时走移位路径
+void test_fused_update_matches_unfused() {
+    printf("=== test_fused_update_matches_unfused ===\n");
+    const int lrInvs[] = { 1, 64, 1000, 4096 };
+    char msg[96];
+    for (int t = 0; t < (int)(sizeof(lrInvs) / sizeof(lrInvs[0])); t++) {
+        intnn_fc_layer* layer = intnn_fc_create(70, 33);
+        intnn_fc_set_actv(layer, INTNN_ACTV_LEAKYRELU);
+        intnn_tmat_set_random(layer->mWeight, true, -32000, 32000);
+        intnn_set_random(layer->mBias, true, -32000, 32000);
+        intnn_mat* x = intnn_create_mat(9, 70);
+        intnn_mat* delta = intnn_create_mat(9, 33);
+        intnn_set_random(x, true, -127, 127);
+        intnn_set_random(delta, true, -3000, 3000);
+        intnn_mat* weight = intnn_create_mat(70, 33);
+        intnn_tmat_to_mat(weight, layer->mWeight);
+        intnn_mat* bias = intnn_copy_mat(layer->mBias);
+
+        intnn_fc_forward(layer, x);
+        intnn_fc_backward(layer, delta, lrInvs[t]);
+
+        intnn_mat* upd = intnn_create_mat(70, 33);
+        intnn_mat* updB = intnn_create_mat(1, 33);
+        intnn_mat_mul_mat_trans(upd, x, true, layer->mDeltas, false);
+        intnn_self_div_const(upd, -lrInvs[t]);
+        intnn_self_add_mat(weight, upd);
+        intnn_clamp_mat(weight, -32767, 32767);
+        intnn_sum_colwise_of(updB, layer->mDeltas);
+        intnn_self_div_const(updB, -lrInvs[t]);
+        intnn_self_add_mat(bias, updB);
+        intnn_clamp_mat(bias, -32767, 32767);
+
+        bool same = true;
+        for (int r = 0; r < 70; r++)
+            for (int c = 0; c < 33; c++)
+                same = same && intnn_get_elem(weight, r, c) == intnn_tmat_get_elem(layer->mWeight, r, c)
+                            && intnn_get_elem(upd, r, c) == intnn_get_elem(layer->mWeightUpdate, r, c);
+        for (int c = 0; c < 33; c++)
+            same = same && intnn_get_elem(bias, 0, c) == intnn_get_elem(layer->mBias, 0, c)
+                        && intnn_get_elem(updB, 0, c) == intnn_get_elem(layer->mBiasUpdate, 0, c);
+        snprintf(msg, sizeof(msg), "Fused update matches unfused (lrInv %d)", lrInvs[t]);
+        TEST_ASSERT(same, msg);
+
+        intnn_free_mat(x); intnn_free_mat(delta); intnn_free_mat(weight); intnn_free_mat(bias);
+        intnn_free_mat(upd); intnn_free_mat(updB);
+        free(x); free(delta); free(weight); free(bias); free(upd); free(updB);
+        intnn_fc_free(layer);
+        free(layer);
+    }
+}
+
+// 推理前向只写 mOutput，输出与训练前向相同
+void test_infer_matches_forward() {
+    printf("=== test_infer_matches_forward ===\n");
+    const intnn_actv_type types[] = {
+        INTNN_ACTV_SIGMOID, INTNN_ACTV_TANH, INTNN_ACTV_RESCALE, INTNN_ACTV_SOFTMAX,
+        INTNN_ACTV_RELU8BIT, INTNN_ACTV_LEAKYRELU, INTNN_ACTV_PLU, INTNN_ACTV_AS_IS
+    };
+    char msg[96];
+    for (int t = 0; t < (int)(sizeof(types) / sizeof(types[0])); t++) {
+        intnn_fc_layer* layer = intnn_fc_create(300, 37);
+        intnn_fc_set_actv(layer, types[t]);
+        intnn_tmat_set_random(layer->mWeight, true, -2000, 2000);
+        intnn_set_random(layer->mBias, true, -30000, 30000);
+        intnn_mat* x = intnn_create_mat(7, 300);
+        intnn_set_random(x, true, -127, 127);
+
+        intnn_fc_forward(layer, x);
+        intnn_mat* expect = intnn_copy_mat(layer->mOutput);
+        intnn_set_all_constant(layer->mOutput, 0);
+        layer->mInput = NULL;
+
+        intnn_fc_infer(layer, x);
+        bool same = true;
+        for (int r = 0; r < 7; r++)
+            for (int c = 0; c < 37; c++)
+                same = same && intnn_get_elem(expect, r, c) == intnn_get_elem(layer->mOutput, r, c);
+        snprintf(msg, sizeof(msg), "Infer matches forward output (activation %d)", (int)types[t]);
+        TEST_ASSERT(same && layer->mInput == NULL, msg);
+
+        intnn_free_mat(x); intnn_free_mat(expect);
+        free(x); free(expect);
+        intnn_fc_free(layer);
+        free(layer);
+    }
+
+    // 新层只推理时不分配激活梯度与中间结果
+    intnn_fc_layer* fresh = intnn_fc_create(5, 3);
+    intnn_mat* x = intnn_create_mat(2, 5);
+    intnn_fc_infer(fresh, x);
+    TEST_ASSERT(fresh->mActvGradInv == NULL && fresh->mInter == NULL && intnn_rows(fresh->mOutput) == 2,
+                "Infer allocates only the output");
+    intnn_free_mat(x);
+    free(x);
+    intnn_fc_free(fresh);
+    free(fresh);
+}
+
+// 预留后批大小不超过上限时，前向/反向不再重新分配工作矩阵
+void test_reserve_reuses_buffers() {
+    printf("=== test_reserve_reuses_buffers ===\n");
+    intnn_fc_layer* fc1 = intnn_fc_create(6, 5);
+    intnn_fc_layer* fc2 = intnn_fc_create(5, 3);
+    fc1->mNext = fc2;
+    fc2->mPrev = fc1;
+    intnn_fc_use_dfa(fc1, true);
+    intnn_fc_use_dfa(fc2, true);
+    intnn_fc_reserve(fc1, 8);
+    intnn_fc_reserve(fc2, 8);
+
+    int* inter = fc1->mInter->mData;
+    int* output = fc2->mOutput->mData;
+    int* deltas = fc1->mDeltas->mData;
+    int* weightUpdate = fc1->mWeightUpdate->mData;
+    int* biasUpdate = fc2->mBiasUpdate->mData;
+
+    for (int batch = 8; batch >= 2; batch -= 3) {
+        intnn_mat* x = intnn_create_mat(batch, 6);
+        intnn_mat* d = intnn_create_mat(batch, 3);
+        intnn_set_random(x, true, -127, 127);
+        intnn_set_random(d, true, -50, 50);
+        intnn_fc_forward(fc1, x);
+        intnn_fc_backward(fc2, d, 1000);
+        TEST_ASSERT(intnn_rows(intnn_fc_get_output(fc2)) == batch, "Output rows follow batch size");
+        TEST_ASSERT(intnn_rows(fc1->mDeltas) == batch, "Deltas rows follow batch size");
+        intnn_free_mat(x); intnn_free_mat(d);
+        free(x); free(d);
+    }
+    TEST_ASSERT(fc1->mInter->mData == inter && fc2->mOutput->mData == output &&
+                fc1->mDeltas->mData == deltas && fc1->mWeightUpdate->mData == weightUpdate &&
+                fc2->mBiasUpdate->mData == biasUpdate, "Reserved buffers reused across batches");
+
+    intnn_fc_free(fc1); intnn_fc_free(fc2);
+    free(fc1); free(fc2);
+}
+
+// 默认前向只引用输入；开启复制后改写输入不影响层内 mInput
+void test_input_binding() {
+    printf("=== test_input_binding ===\n");
+    intnn_fc_layer* fc = intnn_fc_create(4, 3);
+    intnn_mat* x = intnn_create_mat(2, 4);
+    intnn_set_random(x, true, -127, 127);
+
+    intnn_fc_forward(fc, x);
+    TEST_ASSERT(fc->mInput == x, "Forward binds input without copying");
+
+    intnn_fc_set_copy_input(fc, true);
+    intnn_fc_forward(fc, x);
+    TEST_ASSERT(fc->mInput != x && fc->mInput->mData != x->mData, "Opt-in copy owns its input");
+    int before = intnn_get_elem(fc->mInput, 1, 2);
+    intnn_set_elem(x, 1, 2, before + 1);
+    TEST_ASSERT(intnn_get_elem(fc->mInput, 1, 2) == before, "Copied input unaffected by caller writes");
+
+    intnn_fc_set_copy_input(fc, false);
+    intnn_fc_forward(fc, x);
+    TEST_ASSERT(fc->mInput == x, "Copy can be turned off again");
+
+    intnn_free_mat(x);
+    free(x);
+    intnn_fc_free(fc);
+    free(fc);
+}
+
+// 三层 DFA 网络训练若干步后复制各层权重，用于比较串行与分层并行反向
+static void train_dfa_net(int numThreads, intnn_mat** weightsOut) {
+    intnn_thread_pool_init(numThreads, false);
+    srand(1234);
+    intnn_fc_layer* fc[3] = { intnn_fc_create(12, 9), intnn_fc_create(9, 7), intnn_fc_create(7, 4) };
+    for (int i = 0; i < 3; i++) {
+        intnn_fc_use_dfa(fc[i], true);
+        intnn_tmat_set_random(fc[i]->mWeight, true, -300, 300);
+        if (i > 0) {
+            fc[i - 1]->mNext = fc[i];
+            fc[i]->mPrev = fc[i - 1];
+        }
+    }
+    intnn_fc_set_actv(fc[2], INTNN_ACTV_AS_IS);
+    intnn_mat* x = intnn_create_mat(6, 12);
+    intnn_mat* d = intnn_create_mat(6, 4);
+    for (int step = 0; step < 5; step++) {
+        intnn_set_random(x, true, -127, 127);
+        intnn_set_random(d, true, -5000, 5000);
+        intnn_fc_forward(fc[0], x);
+        intnn_fc_backward(fc[2], d, 100);
+    }
+    for (int i = 0; i < 3; i++) {
+        weightsOut[i] = intnn_create_mat(fc[i]->mInDim, fc[i]->mOutDim);
+        intnn_tmat_to_mat(weightsOut[i], fc[i]->mWeight);
+        intnn_fc_free(fc[i]);
+        free(fc[i]);
+    }
+    intnn_free_mat(x); intnn_free_mat(d);
+    free(x); free(d);
+}
+
+void test_dfa_backward_layer_parallel() {
+    printf("=== test_dfa_backward_layer_parallel ===\n");
+    intnn_mat* serial[3];
+    intnn_mat* parallel[3];
+    train_dfa_net(1, serial);
+    train_dfa_net(3, parallel);
+    intnn_thread_pool_init(1, false);
+    bool same = true;
+    for (int i = 0; i < 3; i++) {
+        same = same && intnn_dims_equal(serial[i], parallel[i]);
+        for (int r = 0; same && r < serial[i]->mRows; r++)
+            for (int c = 0; c < serial[i]->mCols; c++)
+                same = same && intnn_get_elem(serial[i], r, c) == intnn_get_elem(parallel[i], r, c);
+        intnn_free_mat(serial[i]); intnn_free_mat(parallel[i]);
+        free(serial[i]); free(parallel[i]);
+    }
+    TEST_ASSERT(same, "Layer-parallel DFA backward matches serial");
+}
+
 int main() {
     test_create_and_free();
     // test_set_and_get_name();
     test_random_and_he_initialization();
     test_forward_as_is_activation();
     test_backward_as_is_activation();
+    test_forward_fused_matches_unfused();
+    test_grad_code_matches_division();
+    test_fused_update_matches_unfused();
+    test_infer_matches_forward();
+    test_reserve_reuses_buffers();
+    test_input_binding();
+    test_dfa_backward_layer_parallel();
     test_use_batch_and_dfa_flags();
     test_print_functions();
 
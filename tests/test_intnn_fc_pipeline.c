@@ -0,0 +1,220 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "intnn_fc_layer.h"
+#include "intnn_fc_pipeline.h"
+#include "intnn_loss.h"
+#include "intnn_mat.h"
+#include "intnn_net.h"
+#include "intnn_test_toy.h"
+
+#define TEST_ASSERT(cond, msg)        \
+    if (!(cond)) {                    \
+        printf("[FAILED] %s\n", msg); \
+        exit(1);                      \
+    } else {                          \
+        printf("[PASSED] %s\n", msg); \
+    }
+
+typedef struct {
+    toy_batches mBatches;
+    int mLossCalls;
+    int mLastBatch;
+    bool mInOrder;
+} toy_data;
+
+static void toy_input(void* ctx, int batch, intnn_mat* x) {
+    toy_copy_input(&((toy_data*)ctx)->mBatches, batch, x);
+}
+
+static void toy_loss(void* ctx, int batch, const intnn_mat* output, intnn_mat* delta) {
+    toy_data* d = (toy_data*)ctx;
+    if (batch != d->mLastBatch + 1)
+        d->mInOrder = false;
+    d->mLastBatch = batch;
+    d->mLossCalls++;
+    intnn_batch_l2_loss_delta(delta, d->mBatches.mY[batch], (intnn_mat*)output);
+}
+
+static void toy_data_init(toy_data* d) {
+    toy_batches_init(&d->mBatches);
+    d->mLossCalls = 0;
+    d->mLastBatch = -1;
+    d->mInOrder = true;
+}
+
+static void toy_data_free(toy_data* d) {
+    toy_batches_free(&d->mBatches);
+}
+
+static void train_pipelined(intnn_fc_layer* fc[3], toy_data* d, int staleness, int* used) {
+    intnn_fc_pipeline* p = intnn_fc_pipeline_create(fc[0], BATCH, staleness);
+    *used = intnn_fc_pipeline_staleness(p);
+    intnn_fc_pipeline_run(p, NUM_BATCHES, 50, toy_input, toy_loss, d);
+    intnn_fc_pipeline_free(p);
+}
+
+void test_pipeline_staleness_zero_matches_sequential() {
+    toy_data d;
+    toy_data_init(&d);
+    intnn_fc_layer* seq[3];
+    intnn_fc_layer* pipe[3];
+    build_net(seq);
+    build_net(pipe);
+
+    train_sequential(seq, &d.mBatches);
+
+    int used = -1;
+    train_pipelined(pipe, &d, 0, &used);
+    TEST_ASSERT(used == 0, "Staleness 0 reported");
+    TEST_ASSERT(d.mLossCalls == NUM_BATCHES && d.mInOrder, "Loss called once per batch in order");
+    TEST_ASSERT(nets_equal(seq, pipe), "Staleness 0 pipeline matches sequential training");
+
+    intnn_fc_forward(pipe[0], d.mBatches.mX[0]);
+    TEST_ASSERT(intnn_fc_get_output(pipe[2]) != NULL && intnn_rows(intnn_fc_get_output(pipe[2])) == BATCH,
+                "Layers usable after pipeline run");
+
+    free_net(seq);
+    free_net(pipe);
+    toy_data_free(&d);
+}
+
+void test_pipeline_stale_deterministic() {
+    toy_data d;
+    toy_data_init(&d);
+    intnn_fc_layer* a[3];
+    intnn_fc_layer* b[3];
+    build_net(a);
+    build_net(b);
+
+    int usedA = -1, usedB = -1;
+    train_pipelined(a, &d, 2, &usedA);
+    d.mLastBatch = -1;
+    train_pipelined(b, &d, 2, &usedB);
+#if defined(_WIN32)
+    TEST_ASSERT(usedA == 0, "Staleness falls back to 0 without threads");
+#else
+    TEST_ASSERT(usedA == 2 && usedB == 2, "Staleness 2 reported");
+#endif
+    TEST_ASSERT(d.mInOrder, "Loss order with staleness");
+    TEST_ASSERT(nets_equal(a, b), "Stale pipeline is deterministic");
+
+    free_net(a);
+    free_net(b);
+    toy_data_free(&d);
+}
+
+// 把 build_net 的层链交给网络并按训练做静态内存规划；层随网络释放
+static intnn_net* plan_net(intnn_fc_layer* fc[3]) {
+    intnn_net* net = intnn_net_create();
+    for (int i = 0; i < 3; i++)
+        intnn_net_add(net, fc[i]);
+    intnn_net_plan_memory(net, BATCH, INTNN_NET_MEM_TRAINING, NULL, 0);
+    return net;
+}
+
+void test_pipeline_keeps_slab_bindings() {
+    toy_data d;
+    toy_data_init(&d);
+    intnn_fc_layer* fc[3];
+    build_net(fc);
+    intnn_net* net = plan_net(fc);
+
+    int* data[3][4];
+    for (int i = 0; i < 3; i++) {
+        const intnn_mat* bound[4] = { fc[i]->mInter, fc[i]->mOutput, fc[i]->mDeltas, fc[i]->mWeightUpdate };
+        for (int m = 0; m < 4; m++)
+            data[i][m] = bound[m]->mData;
+    }
+
+    int used = -1;
+    train_pipelined(fc, &d, 1, &used);
+    bool same = true;
+    for (int i = 0; i < 3; i++) {
+        const intnn_mat* bound[4] = { fc[i]->mInter, fc[i]->mOutput, fc[i]->mDeltas, fc[i]->mWeightUpdate };
+        for (int m = 0; m < 4; m++)
+            same = same && bound[m]->mData == data[i][m] && !bound[m]->mDeleteOnDestruct;
+    }
+    TEST_ASSERT(same, "Pipeline leaves slab-bound layer matrices in place");
+
+    intnn_net_forward(net, d.mBatches.mX[0]);
+    TEST_ASSERT(intnn_rows(intnn_fc_get_output(fc[2])) == BATCH, "Planned net usable after pipeline run");
+
+    intnn_net_free(net);
+    toy_data_free(&d);
+}
+
+// 运行期间在损失回调里检查：不同层正在使用的工作矩阵不得共用内存（toy_data 放在首位，可直接传给 toy_input）
+typedef struct {
+    toy_data mToy;
+    intnn_fc_layer** mLayers;
+    bool mShared;
+} overlap_ctx;
+
+static bool mats_overlap(const intnn_mat* a, const intnn_mat* b) {
+    const char* pa = (const char*)a->mData;
+    const char* pb = (const char*)b->mData;
+    return pa < pb + (size_t)b->mCapRows * b->mStride * sizeof(int) &&
+           pb < pa + (size_t)a->mCapRows * a->mStride * sizeof(int);
+}
+
+static void overlap_loss(void* ctx, int batch, const intnn_mat* output, intnn_mat* delta) {
+    overlap_ctx* c = (overlap_ctx*)ctx;
+    for (int i = 0; i < 3; i++)
+        for (int j = i + 1; j < 3; j++) {
+            intnn_fc_layer* a = c->mLayers[i];
+            intnn_fc_layer* b = c->mLayers[j];
+            const intnn_mat* ma[3] = { a->mInter, a->mDeltas, a->mWeightUpdate };
+            const intnn_mat* mb[3] = { b->mInter, b->mDeltas, b->mWeightUpdate };
+            for (int x = 0; x < 3; x++)
+                for (int y = 0; y < 3; y++)
+                    if (mats_overlap(ma[x], mb[y]))
+                        c->mShared = true;
+        }
+    toy_loss(&c->mToy, batch, output, delta);
+}
+
+void test_pipeline_stale_planned_matches_unplanned() {
+    overlap_ctx c;
+    toy_data_init(&c.mToy);
+    intnn_fc_layer* plain[3];
+    intnn_fc_layer* planned[3];
+    build_net(plain);
+    build_net(planned);
+    intnn_net* net = plan_net(planned);
+    c.mLayers = planned;
+    c.mShared = false;
+
+    // 训练规划让不同层的 mInter / mDeltas 共用 slab 偏移，并发的流水级须换用各自的工作矩阵
+    int used = -1;
+    train_pipelined(plain, &c.mToy, 2, &used);
+    c.mToy.mLastBatch = -1;
+    intnn_fc_pipeline* p = intnn_fc_pipeline_create(planned[0], BATCH, 2);
+    intnn_fc_pipeline_run(p, NUM_BATCHES, 50, toy_input, overlap_loss, &c);
+    intnn_fc_pipeline_free(p);
+    TEST_ASSERT(!c.mShared, "Concurrent stages of a training-planned net use disjoint scratch");
+    TEST_ASSERT(nets_equal(plain, planned), "Stale pipeline on a training-planned net matches unplanned");
+
+    free_net(plain);
+    intnn_net_free(net);
+    toy_data_free(&c.mToy);
+}
+
+void test_pipeline_rejects_non_dfa() {
+    intnn_fc_layer* fc[3];
+    build_net(fc);
+    intnn_fc_use_dfa(fc[1], false);
+    TEST_ASSERT(intnn_fc_pipeline_create(fc[0], BATCH, 1) == NULL, "Non-DFA chain rejected");
+    free_net(fc);
+}
+
+int main() {
+    test_pipeline_staleness_zero_matches_sequential();
+    test_pipeline_stale_deterministic();
+    test_pipeline_keeps_slab_bindings();
+    test_pipeline_stale_planned_matches_unplanned();
+    test_pipeline_rejects_non_dfa();
+    printf("All tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include "intnn_mat.h"
+#include "intnn_gemm.h"
+
+#define TEST_ASSERT(cond, msg)        \
+    if (!(cond)) {                    \
+        printf("[FAILED] %s\n", msg); \
+        exit(1);                      \
+    } else {                          \
+        printf("[PASSED] %s\n", msg); \
+    }
+
+// 朴素参考实现：long long 累加后截断为 int
+static void reference_mul(intnn_mat* out, const intnn_mat* a, const intnn_mat* b) {
+    for (int r = 0; r < a->mRows; r++) {
+        for (int c = 0; c < b->mCols; c++) {
+            long long sum = 0;
+            for (int k = 0; k < a->mCols; k++)
+                sum += (long long)intnn_get_elem(a, r, k) * intnn_get_elem(b, k, c);
+            intnn_set_elem(out, r, c, (int)sum);
+        }
+    }
+}
+
+static int mats_equal(const intnn_mat* x, const intnn_mat* y) {
+    if (!intnn_dims_equal(x, y))
+        return 0;
+    for (int r = 0; r < x->mRows; r++)
+        for (int c = 0; c < x->mCols; c++)
+            if (intnn_get_elem(x, r, c) != intnn_get_elem(y, r, c))
+                return 0;
+    return 1;
+}
+
+static void check_ranges(int m, int k, int n, int loA, int hiA, int loB, int hiB, const char* msg) {
+    intnn_mat* a = intnn_create_mat(m, k);
+    intnn_mat* b = intnn_create_mat(k, n);
+    intnn_mat* out = intnn_create_mat(m, n);
+    intnn_mat* ref = intnn_create_mat(m, n);
+    intnn_set_random(a, true, loA, hiA);
+    intnn_set_random(b, true, loB, hiB);
+
+    intnn_gemm(out, a, b);
+    reference_mul(ref, a, b);
+    TEST_ASSERT(mats_equal(out, ref), msg);
+
+    intnn_free_mat(a);
+    intnn_free_mat(b);
+    intnn_free_mat(out);
+    intnn_free_mat(ref);
+    free(a); free(b); free(out); free(ref);
+}
+
+static void check_shape(int m, int k, int n, int lo, int hi, const char* msg) {
+    check_ranges(m, k, n, lo, hi, lo, hi, msg);
+}
+
+void test_gemm_shapes() {
+    check_shape(1, 1, 1, -9, 9, "GEMM 1x1x1");
+    check_shape(3, 5, 7, -127, 127, "GEMM edge tiles 3x5x7");
+    check_shape(20, 784, 100, 0, 255, "GEMM MNIST batch 20x784x100");
+    check_shape(67, 300, 1030, -127, 127, "GEMM crosses MC/KC/NC blocks");
+    check_shape(1, 20, 50, -32767, 32767, "GEMM row vector");
+}
+
+void test_gemm_wraparound() {
+    // 大数值使 int32 溢出，结果必须与 long long 截断一致
+    check_shape(9, 513, 17, -RAND_MAX / 2, RAND_MAX / 2, "GEMM wraps like truncated long long");
+}
+
+// 每种微块实现都必须与朴素参考逐位一致；窄范围操作数会走 int16 / uint8 x int8 面板
+void test_gemm_kernels() {
+    const char* names[] = { "scalar", "avx2", "avx512vnni" };
+    char msg[128];
+    for (int i = 0; i < 3; ++i) {
+        if (!intnn_gemm_set_kernel(names[i])) {
+            printf("[SKIPPED] kernel %s not supported on this CPU\n", names[i]);
+            continue;
+        }
+        TEST_ASSERT(strcmp(intnn_gemm_kernel_name(), names[i]) == 0, "Kernel selection reported");
+
+        snprintf(msg, sizeof(msg), "[%s] int16 operands, odd k", names[i]);
+        check_ranges(13, 301, 45, -32768, 32767, -32768, 32767, msg);
+        snprintf(msg, sizeof(msg), "[%s] uint8 x int8 operands, k %% 4 != 0", names[i]);
+        check_ranges(21, 787, 100, 0, 255, -128, 127, msg);
+        snprintf(msg, sizeof(msg), "[%s] int32 operands", names[i]);
+        check_ranges(6, 70, 33, -1000000, 1000000, -70000, 70000, msg);
+        snprintf(msg, sizeof(msg), "[%s] wraparound", names[i]);
+        check_shape(9, 513, 17, -RAND_MAX / 2, RAND_MAX / 2, msg);
+    }
+    TEST_ASSERT(!intnn_gemm_set_kernel("no-such-kernel"), "Unknown kernel rejected");
+}
+
+// 转置标志：结果须与先显式转置再相乘一致
+static void check_trans(int m, int k, int n, bool transA, bool transB, int lo, int hi, const char* msg) {
+    intnn_mat* a = transA ? intnn_create_mat(k, m) : intnn_create_mat(m, k);
+    intnn_mat* b = transB ? intnn_create_mat(n, k) : intnn_create_mat(k, n);
+    intnn_mat* out = intnn_create_mat(m, n);
+    intnn_mat* ref = intnn_create_mat(m, n);
+    intnn_mat aT = {0};
+    intnn_mat bT = {0};
+    intnn_set_random(a, true, lo, hi);
+    intnn_set_random(b, true, lo, hi);
+    if (transA) intnn_transpose_of(&aT, a);
+    if (transB) intnn_transpose_of(&bT, b);
+
+    intnn_mat_mul_mat_trans(out, a, transA, b, transB);
+    reference_mul(ref, transA ? &aT : a, transB ? &bT : b);
+    TEST_ASSERT(mats_equal(out, ref), msg);
+
+    intnn_free_mat(&aT);
+    intnn_free_mat(&bT);
+    intnn_free_mat(a);
+    intnn_free_mat(b);
+    intnn_free_mat(out);
+    intnn_free_mat(ref);
+    free(a); free(b); free(out); free(ref);
+}
+
+void test_gemm_trans() {
+    check_trans(784, 20, 100, true, false, 0, 255, "GEMM Aᵀ·B (weight update shape)");
+    check_trans(20, 100, 50, false, true, -127, 127, "GEMM A·Bᵀ");
+    check_trans(17, 300, 33, true, true, -32767, 32767, "GEMM Aᵀ·Bᵀ");
+    check_trans(9, 513, 17, true, false, -RAND_MAX / 2, RAND_MAX / 2, "GEMM Aᵀ·B wraparound");
+}
+
+int main() {
+    srand(1234);
+    test_gemm_shapes();
+    test_gemm_wraparound();
+    test_gemm_trans();
+    test_gemm_kernels();
+
+    printf("All tests passed!\n");
+    return 0;
+}
@@ -128,6 +128,116 @@ void test_batch_cross_entropy_loss_and_delta() {
     intnn_free_mat(delta);
 }
 
+// 融合版本与分步调用损失、误差、intnn_count_max_match 的结果逐位相同，误差写入预分配的缓冲
+void test_batch_loss_fused_matches_separate() {
+    const int rows = 37, cols = 10;
+    intnn_mat* y = intnn_create_mat(rows, cols);
+    intnn_mat* y_hat = intnn_create_mat(rows, cols);
+    intnn_mat* loss = intnn_create_mat(rows, 1);
+    intnn_mat* ref_delta = intnn_create_mat(rows, cols);
+    intnn_mat* delta = intnn_create_mat(rows, cols);
+    const int* delta_data = delta->mData;
+
+    srand(5);
+    intnn_set_random(y_hat, true, 0, 127);   // 非负，口袋交叉熵的 INT_MAX - yHat 不溢出
+    for (int r = 0; r < rows; ++r) {
+        intnn_set_elem(y_hat, r, r % cols, 127);            // 部分行出现并列最大值
+        intnn_set_elem(y_hat, r, (r * 7) % cols, 127);
+    }
+
+    const intnn_loss_type types[] = { INTNN_LOSS_L2, INTNN_LOSS_POCKET_CROSS, INTNN_LOSS_CROSS_ENTROPY };
+    const int hot[] = { 127, INT_MAX, 1 };
+    for (int t = 0; t < 3; ++t) {
+        intnn_set_all_constant(y, 0);
+        for (int r = 0; r < rows; ++r)
+            intnn_set_elem(y, r, (r * 3) % cols, hot[t]);
+
+        int ref_loss = 0;
+        if (types[t] == INTNN_LOSS_L2) {
+            ref_loss = intnn_batch_l2_loss(loss, y, y_hat);
+            intnn_batch_l2_loss_delta(ref_delta, y, y_hat);
+        } else if (types[t] == INTNN_LOSS_POCKET_CROSS) {
+            ref_loss = intnn_batch_pocket_cross_loss(loss, y, y_hat);
+            intnn_batch_pocket_cross_loss_delta(ref_delta, y, y_hat);
+        } else {
+            ref_loss = intnn_batch_cross_entropy_loss(loss, y, y_hat);
+            intnn_batch_cross_entropy_loss_delta(ref_delta, y, y_hat);
+        }
+        const int ref_correct = intnn_count_max_match(y_hat, y);
+
+        intnn_set_all_constant(delta, 12345);   // 旧内容必须被完全覆盖
+        intnn_loss_result res = intnn_batch_loss_fused(delta, y, y_hat, types[t]);
+        TEST_ASSERT(res.mLoss == ref_loss, "fused loss matches");
+        TEST_ASSERT(res.mCorrect == ref_correct, "fused correct count matches");
+        TEST_ASSERT(delta->mData == delta_data, "fused delta reuses the preallocated buffer");
+        bool same = true;
+        for (int r = 0; r < rows; ++r)
+            for (int c = 0; c < cols; ++c)
+                same = same && intnn_get_elem(delta, r, c) == intnn_get_elem(ref_delta, r, c);
+        TEST_ASSERT(same, "fused delta matches");
+
+        intnn_loss_result no_delta = intnn_batch_loss_fused(NULL, y, y_hat, types[t]);
+        TEST_ASSERT(no_delta.mLoss == ref_loss && no_delta.mCorrect == ref_correct, "fused without delta");
+    }
+
+    intnn_free_mat(y);
+    intnn_free_mat(y_hat);
+    intnn_free_mat(loss);
+    intnn_free_mat(ref_delta);
+    intnn_free_mat(delta);
+}
+
+// 类别下标形式的目标与对应 one-hot 目标的融合结果逐位相同，indices 可直接使用打乱后的下标
+void test_batch_loss_fused_labels_matches_one_hot() {
+    const int rows = 23, cols = 7, total = 50;
+    int labels[50];
+    int indices[23];
+    intnn_mat* y = intnn_create_mat(rows, cols);
+    intnn_mat* y_hat = intnn_create_mat(rows, cols);
+    intnn_mat* ref_delta = intnn_create_mat(rows, cols);
+    intnn_mat* delta = intnn_create_mat(rows, cols);
+
+    srand(6);
+    for (int i = 0; i < total; ++i)
+        labels[i] = rand() % cols;
+    for (int r = 0; r < rows; ++r)
+        indices[r] = (r * 13 + 5) % total;
+    intnn_set_random(y_hat, true, 0, 127);
+    for (int r = 0; r < rows; r += 3)
+        intnn_set_elem(y_hat, r, labels[indices[r]], intnn_get_elem(y_hat, r, 0));  // 与首列并列
+
+    const intnn_loss_type types[] = { INTNN_LOSS_L2, INTNN_LOSS_POCKET_CROSS, INTNN_LOSS_CROSS_ENTROPY };
+    const int hot[] = { 15, INT_MAX, 1 };
+    for (int t = 0; t < 3; ++t) {
+        intnn_set_all_constant(y, 0);
+        for (int r = 0; r < rows; ++r)
+            intnn_set_elem(y, r, labels[indices[r]], hot[t]);
+        const intnn_loss_result ref = intnn_batch_loss_fused(ref_delta, y, y_hat, types[t]);
+
+        intnn_set_all_constant(delta, 12345);
+        const intnn_loss_result res = intnn_batch_loss_fused_labels(delta, y_hat, labels, indices, 15, types[t]);
+        TEST_ASSERT(res.mLoss == ref.mLoss && res.mCorrect == ref.mCorrect, "label loss / correct match one-hot");
+        bool same = true;
+        for (int r = 0; r < rows; ++r)
+            for (int c = 0; c < cols; ++c)
+                same = same && intnn_get_elem(delta, r, c) == intnn_get_elem(ref_delta, r, c);
+        TEST_ASSERT(same, "label delta matches one-hot");
+    }
+
+    // indices 为 NULL 时第 r 行使用 labels[r]
+    int gathered[23];
+    for (int r = 0; r < rows; ++r)
+        gathered[r] = labels[indices[r]];
+    const intnn_loss_result a = intnn_batch_loss_fused_labels(NULL, y_hat, gathered, NULL, 15, INTNN_LOSS_L2);
+    const intnn_loss_result b = intnn_batch_loss_fused_labels(NULL, y_hat, labels, indices, 15, INTNN_LOSS_L2);
+    TEST_ASSERT(a.mLoss == b.mLoss && a.mCorrect == b.mCorrect, "labels without indices");
+
+    intnn_free_mat(y);
+    intnn_free_mat(y_hat);
+    intnn_free_mat(ref_delta);
+    intnn_free_mat(delta);
+}
+
 int main() {
     printf("Running intnn_loss tests...\n");
 
@@ -136,6 +246,8 @@ int main() {
     test_vector_pocket_cross_loss();
     test_batch_pocket_cross_loss_and_delta();
     test_batch_cross_entropy_loss_and_delta();
+    test_batch_loss_fused_matches_separate();
+    test_batch_loss_fused_labels_matches_one_hot();
 
     printf("All tests passed!\n");
     return 0;
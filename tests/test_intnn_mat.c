@@ -1,6 +1,7 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include "intnn_mat.h"
 
@@ -132,6 +133,23 @@ void test_inplace_operations() {
     intnn_free_mat(m);
 }
 
+// 学习率更新：lr_inverse 为 2 的幂时按移位计算，负数同样向零取整
+void test_update_lr() {
+    intnn_mat* target = intnn_create_mat(1, 4);
+    intnn_mat* update = intnn_create_mat(1, 4);
+    const int vals[4] = { 17, -17, -16, -1 };
+    for (int c = 0; c < 4; c++)
+        intnn_set_elem(update, 0, c, vals[c]);
+    intnn_mat_update_lr(target, update, 8);
+    TEST_ASSERT(intnn_get_elem(target, 0, 0) == 2 && intnn_get_elem(target, 0, 1) == -2 &&
+                intnn_get_elem(target, 0, 2) == -2 && intnn_get_elem(target, 0, 3) == 0, "Update lr with power-of-two inverse");
+    intnn_mat_update_lr(target, update, 5);
+    TEST_ASSERT(intnn_get_elem(target, 0, 0) == 5 && intnn_get_elem(target, 0, 1) == -5 &&
+                intnn_get_elem(target, 0, 2) == -5 && intnn_get_elem(target, 0, 3) == 0, "Update lr with general inverse");
+    intnn_free_mat(target);
+    intnn_free_mat(update);
+}
+
 void test_out_of_place_mat_operations() {
     intnn_mat* a = intnn_create_mat(2, 2);
     intnn_mat* b = intnn_create_mat(2, 2);
@@ -198,6 +216,127 @@ void test_transforms() {
     intnn_free_mat(slice);
 }
 
+void test_contiguous_storage() {
+    intnn_mat* m = intnn_create_mat(3, 5);
+    TEST_ASSERT(((uintptr_t)m->mData % INTNN_MAT_ALIGN) == 0, "Storage aligned");
+    TEST_ASSERT(m->mStride >= 5 && (m->mStride * sizeof(int)) % INTNN_MAT_ALIGN == 0,
+                "Stride padded to alignment");
+    for (int r = 0; r < 3; r++) {
+        TEST_ASSERT(m->mMat[r] == m->mData + r * m->mStride, "Row shim points into buffer");
+    }
+    intnn_set_elem(m, 2, 4, 9);
+    TEST_ASSERT(m->mData[2 * m->mStride + 4] == 9, "Set elem writes contiguous buffer");
+
+    intnn_reset_zero(m, 4, 2);
+    TEST_ASSERT(intnn_dims_equal_size(m, 4, 2), "Reset zero resizes");
+    check_all_equal(m, 0, "Reset zero clears");
+    intnn_free_mat(m);
+    free(m);
+}
+
+void test_capacity_reuse() {
+    intnn_mat* m = intnn_create_mat(8, 10);
+    int* storage = m->mData;
+
+    intnn_set_all_constant(m, 7);
+    intnn_resize(m, 3, 10);
+    TEST_ASSERT(intnn_dims_equal_size(m, 3, 10) && m->mData == storage, "Resize within capacity keeps storage");
+    TEST_ASSERT(intnn_get_elem(m, 2, 9) == 7, "Resize keeps contents");
+
+    intnn_reset_zero(m, 8, 4);
+    TEST_ASSERT(intnn_dims_equal_size(m, 8, 4) && m->mData == storage, "Reset zero within capacity keeps storage");
+    check_all_equal(m, 0, "Reset zero within capacity clears");
+
+    intnn_resize(m, 9, 4);
+    TEST_ASSERT(intnn_dims_equal_size(m, 9, 4) && m->mCapRows >= 9, "Resize beyond capacity grows");
+    for (int r = 0; r < 9; r++) {
+        TEST_ASSERT(m->mMat[r] == m->mData + r * m->mStride, "Row shim valid after growth");
+    }
+
+    intnn_mat* in = intnn_create_mat(3, 4);
+    int vals[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, INT_MAX};
+    for (int i = 0; i < 12; i++)
+        intnn_set_elem(in, i / 4, i % 4, vals[i]);
+    intnn_sum_colwise_of(m, in);
+    TEST_ASSERT(intnn_dims_equal_size(m, 1, 4), "Column sum shape");
+    TEST_ASSERT(intnn_get_elem(m, 0, 0) == 15 && intnn_get_elem(m, 0, 2) == 21, "Column sum values");
+    TEST_ASSERT(intnn_get_elem(m, 0, 3) == (int)(4u + 8u + (unsigned)INT_MAX), "Column sum wraps like GEMM");
+
+    intnn_free_mat(in);
+    intnn_free_mat(m);
+    free(in);
+    free(m);
+}
+
+void test_view_of() {
+    intnn_mat* m = intnn_create_mat(5, 7);
+    intnn_set_random(m, true, -100, 100);
+
+    intnn_mat view = {0};
+    intnn_view_of(&view, m, 1, 3, 2, 5);
+    TEST_ASSERT(intnn_dims_equal_size(&view, 3, 4) && view.mStride == m->mStride, "View shape and stride");
+    TEST_ASSERT(view.mData == INTNN_MAT_ROW(m, 1) + 2 && !view.mDeleteOnDestruct, "View shares parent storage");
+    TEST_ASSERT(view.mMat == NULL, "Column-offset view has no row pointer shim");
+
+    intnn_mat* copy = intnn_create_mat(1, 1);
+    intnn_slice_of(copy, m, 1, 3, 2, 5);
+    bool same = true;
+    for (int r = 0; r < 3; r++)
+        for (int c = 0; c < 4; c++)
+            same = same && intnn_get_elem(&view, r, c) == intnn_get_elem(copy, r, c);
+    TEST_ASSERT(same, "View matches slice copy");
+
+    intnn_mat* b = intnn_create_mat(4, 3);
+    intnn_mat* viaView = intnn_create_mat(3, 3);
+    intnn_mat* viaCopy = intnn_create_mat(3, 3);
+    intnn_set_random(b, true, -10, 10);
+    intnn_mat_mul_mat(viaView, &view, b);
+    intnn_mat_mul_mat(viaCopy, copy, b);
+    same = true;
+    for (int r = 0; r < 3; r++)
+        for (int c = 0; c < 3; c++)
+            same = same && intnn_get_elem(viaView, r, c) == intnn_get_elem(viaCopy, r, c);
+    TEST_ASSERT(same, "GEMM on strided view matches copy");
+
+    intnn_set_elem(&view, 0, 0, 12345);
+    TEST_ASSERT(intnn_get_elem(m, 1, 2) == 12345, "Writes through view reach parent");
+
+    intnn_view_of(&view, m, 2, 4, 0, 6);
+    TEST_ASSERT(view.mMat == m->mMat + 2 && view.mMat[0] == view.mData, "Full-width view shares row pointers");
+    intnn_free_mat(&view);
+    TEST_ASSERT(m->mData != NULL && intnn_get_elem(m, 1, 2) == 12345, "Freeing view leaves parent intact");
+
+    // 预分配输出的按行收集不重新分配
+    intnn_mat* gathered = intnn_create_mat(4, 7);
+    int* storage = gathered->mData;
+    int indices[] = {4, 1, 3};
+    intnn_indexed_slice_of(gathered, m, indices, 0, 3);
+    TEST_ASSERT(gathered->mData == storage && intnn_dims_equal_size(gathered, 3, 7), "Indexed gather reuses buffer");
+    TEST_ASSERT(intnn_get_elem(gathered, 1, 2) == 12345 && intnn_get_elem(gathered, 0, 6) == intnn_get_elem(m, 4, 6),
+                "Indexed gather values");
+
+    intnn_free_mat(gathered); intnn_free_mat(b); intnn_free_mat(viaView); intnn_free_mat(viaCopy);
+    intnn_free_mat(copy); intnn_free_mat(m);
+    free(gathered); free(b); free(viaView); free(viaCopy); free(copy); free(m);
+}
+
+void test_bind_storage() {
+    // 外部对齐存储：容量内调整尺寸原地复用，释放矩阵不归还存储
+    static int storage[4 * 16] __attribute__((aligned(INTNN_MAT_ALIGN)));
+    TEST_ASSERT(intnn_storage_bytes(4, 5) <= sizeof(storage) && intnn_storage_bytes(4, 5) % INTNN_MAT_ALIGN == 0,
+                "Storage bytes padded to alignment");
+    intnn_mat m = {0};
+    intnn_bind_storage(&m, storage, 4, 5);
+    TEST_ASSERT(intnn_dims_equal_size(&m, 4, 5) && m.mData == storage && !m.mDeleteOnDestruct, "Bound storage used");
+    intnn_set_elem(&m, 3, 4, 77);
+    intnn_resize(&m, 2, 3);
+    TEST_ASSERT(m.mData == storage && intnn_dims_equal_size(&m, 2, 3), "Resize within bound capacity reuses storage");
+    intnn_resize(&m, 4, 5);
+    TEST_ASSERT(intnn_get_elem(&m, 3, 4) == 77, "Contents kept across resize");
+    intnn_free_mat(&m);
+    TEST_ASSERT(m.mData == NULL && storage[3 * m.mStride + 4] == 77, "Free leaves external storage alone");
+}
+
 int main() {
     test_create_and_free();
     test_set_and_get_elem();
@@ -208,8 +347,13 @@ int main() {
     test_get_max_index_and_min_max();
     test_average_variance_stdev();
     test_inplace_operations();
+    test_update_lr();
     test_out_of_place_mat_operations();
     test_transforms();
+    test_contiguous_storage();
+    test_capacity_reuse();
+    test_view_of();
+    test_bind_storage();
 
     printf("All tests passed!\n");
     return 0;
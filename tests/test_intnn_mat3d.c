@@ -3,6 +3,7 @@
 #include <limits.h>
 #include "intnn_mat.h"
 #include "intnn_mat3d.h"
+#include "intnn_actv.h"
 
 #define TEST_ASSERT(cond, msg)        \
     if (!(cond)) {                    \
@@ -119,6 +120,76 @@ void test_deep_copy() {
     intnn_free_mat3d(b);
 }
 
+void test_contiguous_layout() {
+    intnn_mat3d* m3d = intnn_create_mat3d(3, 2, 5);
+    intnn_mat* flat = intnn_mat3d_flat(m3d);
+    TEST_ASSERT(flat != NULL && intnn_rows(flat) == 6 && intnn_cols(flat) == 5, "flat shape");
+    for (int d = 0; d < 3; ++d) {
+        intnn_mat* slice = intnn_mat3d_get_mat_at_depth(m3d, d);
+        TEST_ASSERT(slice->mData == INTNN_MAT_ROW(flat, d * 2), "slice is a view into flat storage");
+    }
+
+    intnn_mat3d_set_elem(m3d, 2, 1, 4, 9);
+    TEST_ASSERT(intnn_get_elem(flat, 5, 4) == 9, "set elem writes flat storage");
+
+    int* data = flat->mData;
+    intnn_reset_zero3d(m3d, 3, 2, 5);
+    TEST_ASSERT(intnn_mat3d_flat(m3d)->mData == data, "reset with same shape reuses storage");
+    TEST_ASSERT(intnn_mat3d_get_elem(m3d, 2, 1, 4) == 0, "reset clears");
+    intnn_reset_zero3d(m3d, 2, 3, 5);
+    TEST_ASSERT(intnn_mat3d_flat(m3d)->mData == data, "reshape within capacity reuses storage");
+    TEST_ASSERT(intnn_mat3d_get_mat_at_depth(m3d, 1)->mData == INTNN_MAT_ROW(intnn_mat3d_flat(m3d), 3),
+                "slices follow new shape");
+
+    intnn_free_mat3d(m3d);
+}
+
+// 3D 激活与逐层调用 2D 激活结果一致（含 softmax 等原先不支持的类型），形状一致时不重新分配
+void test_activate3d_all_types() {
+    const intnn_actv_type types[] = {
+        INTNN_ACTV_SIGMOID, INTNN_ACTV_TANH, INTNN_ACTV_RESCALE, INTNN_ACTV_SOFTMAX,
+        INTNN_ACTV_RELU8BIT, INTNN_ACTV_LEAKYRELU, INTNN_ACTV_PLU, INTNN_ACTV_AS_IS
+    };
+    const int depth = 3, rows = 4, cols = 11;
+    intnn_mat3d* in = intnn_create_mat3d(depth, rows, cols);
+    intnn_mat3d* out = intnn_create_mat3d(1, 1, 1);
+    intnn_mat3d* grad = intnn_create_mat3d(1, 1, 1);
+    srand(3);
+    for (int d = 0; d < depth; ++d)
+        for (int r = 0; r < rows; ++r)
+            for (int c = 0; c < cols; ++c)
+                intnn_mat3d_set_elem(in, d, r, c, rand() % 4001 - 2000);
+
+    intnn_mat* refOut = intnn_create_mat(rows, cols);
+    intnn_mat* refGrad = intnn_create_mat(rows, cols);
+    for (int t = 0; t < (int)(sizeof(types) / sizeof(types[0])); ++t) {
+        intnn_activate3d(out, in, grad, types[t], INTNN_K_BIT, 300);
+        const int* outData = intnn_mat3d_flat(out)->mData;
+        const int* gradData = intnn_mat3d_flat(grad)->mData;
+        intnn_activate3d(out, in, grad, types[t], INTNN_K_BIT, 300);
+        TEST_ASSERT(intnn_mat3d_flat(out)->mData == outData && intnn_mat3d_flat(grad)->mData == gradData,
+                    "activate3d reuses out / grad storage");
+
+        bool same = true;
+        for (int d = 0; d < depth; ++d) {
+            intnn_activate(refOut, intnn_mat3d_get_mat_at_depth(in, d), refGrad, types[t], INTNN_K_BIT, 300);
+            for (int r = 0; r < rows; ++r)
+                for (int c = 0; c < cols; ++c)
+                    same = same && intnn_mat3d_get_elem(out, d, r, c) == intnn_get_elem(refOut, r, c) &&
+                           intnn_mat3d_get_elem(grad, d, r, c) == intnn_get_elem(refGrad, r, c);
+        }
+        TEST_ASSERT(same, "activate3d matches per-slice activate");
+    }
+
+    intnn_free_mat(refOut);
+    intnn_free_mat(refGrad);
+    free(refOut);
+    free(refGrad);
+    intnn_free_mat3d(in);
+    intnn_free_mat3d(out);
+    intnn_free_mat3d(grad);
+}
+
 int main() {
     test_create_and_set_get();
     test_reset_and_dims_equal();
@@ -126,6 +197,8 @@ int main() {
     test_rotate180();
     test_make_from_mat();
     test_deep_copy();
+    test_contiguous_layout();
+    test_activate3d_all_types();
     printf("All mat3d tests passed.\n");
     return 0;
 }
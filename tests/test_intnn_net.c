@@ -0,0 +1,373 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "intnn_fc_layer.h"
+#include "intnn_loss.h"
+#include "intnn_net.h"
+#include "intnn_thread_pool.h"
+#include "intnn_mat.h"
+
+#define TEST_ASSERT(cond, msg)        \
+    if (!(cond)) {                    \
+        printf("[FAILED] %s\n", msg); \
+        exit(1);                      \
+    } else {                          \
+        printf("[PASSED] %s\n", msg); \
+    }
+
+static const int kDims[4] = { 10, 8, 6, 4 };
+
+// 两种方式构造同一网络：相同随机种子，DFA 反馈矩阵在第一次反向时按相同顺序生成
+static void build_layers(intnn_fc_layer* fc[3]) {
+    srand(7);
+    for (int i = 0; i < 3; i++) {
+        fc[i] = intnn_fc_create(kDims[i], kDims[i + 1]);
+        intnn_fc_use_dfa(fc[i], true);
+        intnn_tmat_set_random(fc[i]->mWeight, true, -500, 500);
+        intnn_set_random(fc[i]->mBias, true, -50, 50);
+    }
+}
+
+static bool mats_equal(const intnn_mat* a, const intnn_mat* b) {
+    if (!intnn_dims_equal(a, b))
+        return false;
+    for (int r = 0; r < a->mRows; r++)
+        if (memcmp(INTNN_MAT_ROW(a, r), INTNN_MAT_ROW(b, r), sizeof(int) * a->mCols) != 0)
+            return false;
+    return true;
+}
+
+static bool tmats_equal(const intnn_tmat* a, const intnn_tmat* b) {
+    if (a->mRows != b->mRows || a->mCols != b->mCols || a->mType != b->mType)
+        return false;
+    for (int r = 0; r < a->mRows; r++)
+        for (int c = 0; c < a->mCols; c++)
+            if (intnn_tmat_get_elem(a, r, c) != intnn_tmat_get_elem(b, r, c))
+                return false;
+    return true;
+}
+
+void test_net_add_links_layers() {
+    intnn_fc_layer* fc[3];
+    build_layers(fc);
+    intnn_net* net = intnn_net_create();
+    for (int i = 0; i < 3; i++)
+        intnn_net_add(net, fc[i]);
+
+    TEST_ASSERT(intnn_net_num_layers(net) == 3, "Layer count");
+    TEST_ASSERT(intnn_net_layer(net, 0) == fc[0] && intnn_net_layer(net, -1) == fc[2], "Layer lookup");
+    TEST_ASSERT(fc[0]->mPrev == NULL && fc[0]->mNext == fc[1] && fc[1]->mNext == fc[2] &&
+                fc[2]->mPrev == fc[1] && fc[2]->mNext == NULL, "Layers linked in order");
+
+    intnn_net_plan(net, 16);
+    TEST_ASSERT(net->mPlan.mReady && net->mPlan.mMaxBatch == 16, "Plan built");
+    TEST_ASSERT(net->mPlan.mInDim == 10 && net->mPlan.mOutDim == 4, "Plan shapes");
+    TEST_ASSERT(net->mPlan.mDfaParallel, "DFA chain planned for parallel backward");
+    TEST_ASSERT(fc[1]->mOutput->mCapRows >= 16 && fc[1]->mDeltas->mCapRows >= 16, "Plan reserves buffers");
+
+    intnn_net_free(net);
+}
+
+void test_net_matches_recursive() {
+    intnn_fc_layer* ref[3];
+    intnn_fc_layer* fc[3];
+    build_layers(ref);
+    build_layers(fc);
+    for (int i = 1; i < 3; i++) {
+        ref[i - 1]->mNext = ref[i];
+        ref[i]->mPrev = ref[i - 1];
+    }
+    intnn_net* net = intnn_net_create();
+    for (int i = 0; i < 3; i++)
+        intnn_net_add(net, fc[i]);
+
+    srand(99);
+    intnn_mat* x = intnn_create_mat(5, 10);
+    intnn_mat* y = intnn_create_mat(5, 4);
+    intnn_mat* deltaRef = intnn_create_mat(5, 4);
+    intnn_mat* delta = intnn_create_mat(5, 4);
+    bool outputsEqual = true;
+    for (int step = 0; step < 6; step++) {
+        intnn_set_random(x, true, 0, 255);
+        intnn_set_random(y, true, -127, 127);
+        const unsigned int seed = (unsigned int)rand();
+
+        intnn_fc_forward(ref[0], x);
+        intnn_batch_l2_loss_delta(deltaRef, y, intnn_fc_get_output(ref[2]));
+        srand(seed);
+        intnn_fc_backward(ref[2], deltaRef, 50);
+
+        intnn_mat* out = intnn_net_forward(net, x);
+        outputsEqual = outputsEqual && mats_equal(out, intnn_fc_get_output(ref[2])) && out == intnn_net_output(net);
+        intnn_batch_l2_loss_delta(delta, y, out);
+        srand(seed);
+        intnn_net_backward(net, delta, 50);
+    }
+    TEST_ASSERT(outputsEqual, "Iterative forward matches recursive forward");
+    bool paramsEqual = true;
+    for (int i = 0; i < 3; i++)
+        paramsEqual = paramsEqual && tmats_equal(ref[i]->mWeight, fc[i]->mWeight) && mats_equal(ref[i]->mBias, fc[i]->mBias);
+    TEST_ASSERT(paramsEqual, "Iterative backward matches recursive backward");
+    TEST_ASSERT(net->mPlan.mDfaReady && mats_equal(ref[0]->mDfaWeight, fc[0]->mDfaWeight), "DFA weights initialized in the same order");
+
+    intnn_free_mat(x); intnn_free_mat(y);
+    intnn_free_mat(deltaRef); intnn_free_mat(delta);
+    free(x); free(y); free(deltaRef); free(delta);
+    for (int i = 0; i < 3; i++) {
+        intnn_fc_free(ref[i]);
+        free(ref[i]);
+    }
+    intnn_net_free(net);
+}
+
+void test_net_replans_for_larger_batch() {
+    intnn_fc_layer* fc[3];
+    build_layers(fc);
+    intnn_net* net = intnn_net_create();
+    for (int i = 0; i < 3; i++)
+        intnn_net_add(net, fc[i]);
+
+    intnn_mat* x = intnn_create_mat(3, 10);
+    intnn_net_forward(net, x);
+    TEST_ASSERT(net->mPlan.mReady && net->mPlan.mMaxBatch == 3, "First forward builds plan");
+    intnn_mat* big = intnn_create_mat(8, 10);
+    TEST_ASSERT(intnn_rows(intnn_net_forward(net, big)) == 8 && net->mPlan.mMaxBatch == 8, "Larger batch grows plan");
+    TEST_ASSERT(intnn_rows(intnn_net_forward(net, x)) == 3 && net->mPlan.mMaxBatch == 8, "Smaller batch reuses plan");
+
+    intnn_free_mat(x); intnn_free_mat(big);
+    free(x); free(big);
+    intnn_net_free(net);
+}
+
+static intnn_net* build_net(void) {
+    intnn_fc_layer* fc[3];
+    build_layers(fc);
+    intnn_net* net = intnn_net_create();
+    for (int i = 0; i < 3; i++)
+        intnn_net_add(net, fc[i]);
+    return net;
+}
+
+static bool released(const intnn_mat* m) {
+    return m == NULL || m->mData == NULL;
+}
+
+static bool in_slab(const intnn_net* net, const intnn_mat* m) {
+    const char* p = (const char*)m->mData;
+    return p >= net->mPlan.mSlab && p + intnn_storage_bytes(m->mCapRows, m->mCols) <= net->mPlan.mSlab + net->mPlan.mPeakBytes;
+}
+
+void test_memory_plan_inference() {
+    intnn_net* ref = build_net();
+    intnn_net* net = build_net();
+    const size_t required = intnn_net_memory_required(net, 5, INTNN_NET_MEM_INFERENCE);
+    const size_t peak = intnn_net_plan_memory(net, 5, INTNN_NET_MEM_INFERENCE, NULL, 0);
+    const size_t one = intnn_storage_bytes(5, 8); // 各层宽度都不超过一个对齐单位，缓冲大小相同
+
+    TEST_ASSERT(peak == required && peak == net->mPlan.mPeakBytes, "Reported peak matches required bytes");
+    TEST_ASSERT(net->mPlan.mUnaliasedBytes == 3 * one, "Unaliased bytes: only outputs are needed");
+    TEST_ASSERT(peak == 2 * one, "Inference peak: output and previous output");
+    TEST_ASSERT(net->mLayers[0]->mOutput->mData == net->mLayers[2]->mOutput->mData, "Outputs ping-pong between two buffers");
+    TEST_ASSERT(released(net->mLayers[0]->mWeightUpdate) && released(net->mLayers[1]->mInter) &&
+                released(net->mLayers[2]->mActvGradInv), "Training-only buffers released for inference");
+    bool bound = true;
+    for (int i = 0; i < 3; i++)
+        bound = bound && in_slab(net, net->mLayers[i]->mOutput);
+    TEST_ASSERT(bound, "Intermediates live in the slab");
+
+    srand(5);
+    intnn_mat* x = intnn_create_mat(5, 10);
+    bool same = true;
+    for (int step = 0; step < 3; step++) {
+        intnn_set_random(x, true, 0, 255);
+        intnn_mat* expect = intnn_net_forward(ref, x);
+        intnn_mat* got = intnn_net_forward(net, x);
+        same = same && mats_equal(expect, got);
+    }
+    intnn_resize(x, 2, 10);
+    same = same && mats_equal(intnn_net_forward(ref, x), intnn_net_forward(net, x));
+    TEST_ASSERT(same, "Planned inference matches unplanned forward");
+    TEST_ASSERT(released(net->mLayers[1]->mInter) && net->mLayers[0]->mInput == NULL,
+                "Inference forward keeps no gradient state or input");
+
+    intnn_free_mat(x);
+    free(x);
+    intnn_net_free(ref);
+    intnn_net_free(net);
+}
+
+void test_memory_plan_training() {
+    intnn_net* ref = build_net();
+    intnn_net* net = build_net();
+    intnn_net_plan(ref, 5);
+    const size_t peak = intnn_net_plan_memory(net, 5, INTNN_NET_MEM_TRAINING, NULL, 0);
+    TEST_ASSERT(peak < net->mPlan.mUnaliasedBytes, "Training plan aliases some buffers");
+    TEST_ASSERT(in_slab(net, net->mLayers[1]->mDeltas) && in_slab(net, net->mLayers[1]->mWeightUpdate),
+                "Backward buffers live in the slab");
+    const char* code = (const char*)net->mLayers[1]->mActvGradCode->mData;
+    TEST_ASSERT(code >= net->mPlan.mSlab && code < net->mPlan.mSlab + peak && released(net->mLayers[1]->mActvGradInv),
+                "Activation gradient codes live in the slab instead of integer inverses");
+
+    srand(11);
+    intnn_mat* x = intnn_create_mat(5, 10);
+    intnn_mat* y = intnn_create_mat(5, 4);
+    intnn_mat* delta = intnn_create_mat(5, 4);
+    for (int step = 0; step < 6; step++) {
+        intnn_set_random(x, true, 0, 255);
+        intnn_set_random(y, true, -127, 127);
+        const unsigned int seed = (unsigned int)rand();
+        intnn_net* nets[2] = { ref, net };
+        for (int i = 0; i < 2; i++) {
+            intnn_batch_l2_loss_delta(delta, y, intnn_net_forward(nets[i], x));
+            srand(seed);
+            intnn_net_backward(nets[i], delta, 50);
+        }
+    }
+    bool paramsEqual = true;
+    for (int i = 0; i < 3; i++)
+        paramsEqual = paramsEqual && tmats_equal(ref->mLayers[i]->mWeight, net->mLayers[i]->mWeight) &&
+                      mats_equal(ref->mLayers[i]->mBias, net->mLayers[i]->mBias);
+    TEST_ASSERT(paramsEqual, "Planned training matches unplanned training");
+
+    intnn_free_mat(x); intnn_free_mat(y); intnn_free_mat(delta);
+    free(x); free(y); free(delta);
+    intnn_net_free(ref);
+    intnn_net_free(net);
+}
+
+void test_memory_plan_static_slab() {
+    static char slab[16384];
+    intnn_net* net = build_net();
+    const size_t required = intnn_net_memory_required(net, 5, INTNN_NET_MEM_INFERENCE);
+    TEST_ASSERT(required + INTNN_MAT_ALIGN <= sizeof(slab), "Static slab large enough");
+    intnn_net_plan_memory(net, 5, INTNN_NET_MEM_INFERENCE, slab + 1, sizeof(slab) - 1);
+    TEST_ASSERT(!net->mPlan.mOwnsSlab && net->mPlan.mSlab > slab && net->mPlan.mSlab < slab + 1 + INTNN_MAT_ALIGN &&
+                (size_t)net->mPlan.mSlab % INTNN_MAT_ALIGN == 0, "Caller slab aligned and used");
+
+    intnn_mat* x = intnn_create_mat(5, 10);
+    TEST_ASSERT(in_slab(net, intnn_net_forward(net, x)), "Output written into caller slab");
+
+    // 重新规划为训练：改用堆上 slab
+    intnn_net_plan_memory(net, 5, INTNN_NET_MEM_TRAINING, NULL, 0);
+    TEST_ASSERT(net->mPlan.mOwnsSlab && net->mPlan.mMemMode == INTNN_NET_MEM_TRAINING, "Replanned for training");
+    TEST_ASSERT(in_slab(net, net->mLayers[0]->mWeightUpdate), "Update buffers restored in the new slab");
+
+    intnn_free_mat(x);
+    free(x);
+    intnn_net_free(net);
+}
+
+void test_net_infer_matches_forward() {
+    intnn_net* net = build_net();
+    srand(3);
+    intnn_mat* x = intnn_create_mat(6, 10);
+    intnn_set_random(x, true, 0, 255);
+
+    intnn_mat* out = intnn_net_forward(net, x);
+    intnn_mat* expect = intnn_copy_mat(out);
+    intnn_mat* grad = intnn_create_mat(6, 6);
+    intnn_mat* grad2 = intnn_create_mat(6, 6);
+    intnn_mat* grad3 = intnn_create_mat(6, 6);
+    intnn_tmat_to_mat(grad, net->mLayers[1]->mActvGradCode);
+    intnn_set_random(x, true, 0, 255);
+    intnn_net_forward(net, x); // 推理不应改写这次前向留下的激活梯度
+    intnn_tmat_to_mat(grad2, net->mLayers[1]->mActvGradCode);
+    srand(3);
+    intnn_set_random(x, true, 0, 255);
+    TEST_ASSERT(mats_equal(intnn_net_infer(net, x), expect), "Infer output matches forward output");
+    intnn_tmat_to_mat(grad3, net->mLayers[1]->mActvGradCode);
+    TEST_ASSERT(mats_equal(grad3, grad2) && !mats_equal(grad, grad2),
+                "Infer leaves activation gradients untouched");
+
+    intnn_free_mat(x); intnn_free_mat(expect); intnn_free_mat(grad); intnn_free_mat(grad2); intnn_free_mat(grad3);
+    free(x); free(expect); free(grad); free(grad2); free(grad3);
+    intnn_net_free(net);
+}
+
+typedef struct {
+    const intnn_mat* mX;
+    const intnn_mat* mY;
+} eval_data;
+
+static void eval_fill(void* ctx, int start, int end, intnn_mat* x, intnn_mat* y) {
+    const eval_data* d = (const eval_data*)ctx;
+    intnn_slice_of(x, d->mX, start, end - 1, 0, d->mX->mCols - 1);
+    if (y)
+        intnn_view_of(y, d->mY, start, end - 1, 0, d->mY->mCols - 1);
+}
+
+void test_net_evaluate_chunked() {
+    intnn_net* net = build_net();
+    srand(21);
+    intnn_mat* x = intnn_create_mat(103, 10);
+    intnn_mat* y = intnn_create_mat(103, 4);
+    intnn_set_random(x, true, 0, 255);
+    intnn_set_random(y, true, -127, 127);
+
+    intnn_mat* out = intnn_net_infer(net, x);
+    const int correct = intnn_count_max_match(out, y);
+    intnn_mat* rowLoss = intnn_create_mat(1, 1);
+    const long long loss = intnn_batch_l2_loss(rowLoss, y, out);
+
+    eval_data d = { x, y };
+    const int threads[] = { 1, 3 };
+    const int chunks[] = { 10, 64, 200 };
+    bool same = true;
+    for (int t = 0; t < 2; t++) {
+        intnn_thread_pool_init(threads[t], false);
+        for (int c = 0; c < 3; c++) {
+            intnn_eval_result r = intnn_net_evaluate(net, 103, chunks[c], eval_fill, &d);
+            same = same && r.mNumSamples == 103 && r.mCorrect == correct && r.mLoss == loss;
+        }
+    }
+    intnn_thread_pool_init(0, false);
+    TEST_ASSERT(same, "Chunked evaluation matches whole-set inference for any chunk size and thread count");
+    TEST_ASSERT(intnn_net_output(net) == out && intnn_rows(out) == 103, "Evaluation leaves layer outputs untouched");
+
+    intnn_free_mat(x); intnn_free_mat(y); intnn_free_mat(rowLoss);
+    free(x); free(y); free(rowLoss);
+    intnn_net_free(net);
+}
+
+void test_net_evaluate_labels() {
+    intnn_net* net = build_net();
+    srand(22);
+    intnn_mat* x = intnn_create_mat(103, 10);
+    intnn_mat* y = intnn_create_mat(103, 4);
+    int labels[103];
+    intnn_set_random(x, true, 0, 255);
+    for (int i = 0; i < 103; i++) {
+        labels[i] = rand() % 4;
+        intnn_set_elem(y, i, labels[i], 15);
+    }
+
+    eval_data d = { x, y };
+    const intnn_eval_result dense = intnn_net_evaluate(net, 103, 64, eval_fill, &d);
+    bool same = true;
+    for (int t = 1; t <= 3; t += 2) {
+        intnn_thread_pool_init(t, false);
+        intnn_eval_result r = intnn_net_evaluate_labels(net, 103, 10, eval_fill, &d, labels, 15);
+        same = same && r.mNumSamples == 103 && r.mCorrect == dense.mCorrect && r.mLoss == dense.mLoss;
+    }
+    intnn_thread_pool_init(0, false);
+    TEST_ASSERT(same, "Label-index evaluation matches one-hot targets");
+
+    intnn_free_mat(x); intnn_free_mat(y);
+    free(x); free(y);
+    intnn_net_free(net);
+}
+
+int main() {
+    test_net_add_links_layers();
+    test_net_matches_recursive();
+    test_net_replans_for_larger_batch();
+    test_net_infer_matches_forward();
+    test_net_evaluate_chunked();
+    test_net_evaluate_labels();
+    test_memory_plan_inference();
+    test_memory_plan_training();
+    test_memory_plan_static_slab();
+    printf("All tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intnn_thread_pool.h"
+#include "intnn_gemm.h"
+#include "intnn_mat.h"
+
+#define TEST_ASSERT(cond, msg)        \
+    if (!(cond)) {                    \
+        printf("[FAILED] %s\n", msg); \
+        exit(1);                      \
+    } else {                          \
+        printf("[PASSED] %s\n", msg); \
+    }
+
+static int mats_equal(const intnn_mat* x, const intnn_mat* y) {
+    if (!intnn_dims_equal(x, y))
+        return 0;
+    for (int r = 0; r < x->mRows; r++)
+        if (memcmp(INTNN_MAT_ROW(x, r), INTNN_MAT_ROW(y, r), sizeof(int) * x->mCols) != 0)
+            return 0;
+    return 1;
+}
+
+typedef struct {
+    int* mHits;
+    int mGrain;
+    int mBadStart;
+    int mNestedHits;
+} cover_ctx;
+
+static void cover_range(void* ctx, int begin, int end, int tid) {
+    cover_ctx* c = (cover_ctx*)ctx;
+    (void)tid;
+    if (begin % c->mGrain != 0)
+        c->mBadStart = 1;
+    for (int i = begin; i < end; i++)
+        __sync_fetch_and_add(&c->mHits[i], 1);
+}
+
+static void max_tid(void* ctx, int begin, int end, int tid) {
+    int* maxTid = (int*)ctx;
+    (void)begin;
+    (void)end;
+    int cur = __atomic_load_n(maxTid, __ATOMIC_RELAXED);
+    while (tid > cur && !__atomic_compare_exchange_n(maxTid, &cur, tid, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+static void nested_inner(void* ctx, int begin, int end, int tid) {
+    cover_ctx* c = (cover_ctx*)ctx;
+    if (tid != 0)
+        c->mBadStart = 1;
+    __sync_fetch_and_add(&c->mNestedHits, end - begin);
+}
+
+static void nested_outer(void* ctx, int begin, int end, int tid) {
+    (void)begin;
+    (void)end;
+    (void)tid;
+    intnn_parallel_for(10, 1, nested_inner, ctx); // 线程池正忙，串行执行
+}
+
+void test_parallel_for_cover() {
+    intnn_thread_pool_init(4, false);
+    TEST_ASSERT(intnn_thread_pool_size() == 4, "Pool size");
+    TEST_ASSERT(intnn_parallel_parts(10, 4) == 3 && intnn_parallel_parts(1000, 1) == 4, "Parallel parts");
+
+    int hits[1003] = {0};
+    cover_ctx c = { hits, 7, 0, 0 };
+    intnn_parallel_for(1003, 7, cover_range, &c);
+    int ok = 1;
+    for (int i = 0; i < 1003; i++)
+        ok = ok && hits[i] == 1;
+    TEST_ASSERT(ok, "Every index processed exactly once");
+    TEST_ASSERT(!c.mBadStart, "Ranges start on grain boundaries");
+
+    int maxTid = -1;
+    intnn_parallel_for_max(1000, 1, 2, max_tid, &maxTid);
+    TEST_ASSERT(maxTid == 1, "Parallel for capped at maxParts");
+
+    c.mNestedHits = 0;
+    intnn_parallel_for(4, 1, nested_outer, &c);
+    TEST_ASSERT(c.mNestedHits == 40 && !c.mBadStart, "Nested parallel_for runs serially");
+}
+
+static void add_row_index(void* ctx, int r, int c0, int* vals, int n) {
+    (void)ctx;
+    for (int j = 0; j < n; j++)
+        vals[j] += r * 1000 + c0 + j;
+}
+
+void test_gemm_threads_bit_exact() {
+    const int m = 517, k = 300, n = 70;
+    intnn_mat* a = intnn_create_mat(m, k);
+    intnn_mat* b = intnn_create_mat(k, n);
+    intnn_set_random(a, true, -30000, 30000);
+    intnn_set_random(b, true, -30000, 30000);
+    intnn_mat* serial = intnn_create_mat(m, n);
+    intnn_mat* threaded = intnn_create_mat(m, n);
+    intnn_gemm_operand opA = { a->mData, a->mStride, INTNN_DTYPE_INT32, false };
+    intnn_gemm_operand opB = { b->mData, b->mStride, INTNN_DTYPE_INT32, false };
+    intnn_gemm_epilogue epi = { add_row_index, NULL };
+
+    intnn_thread_pool_init(1, false);
+    intnn_gemm_ex(serial, &opA, &opB, k, &epi);
+    intnn_thread_pool_init(4, false);
+    intnn_gemm_ex(threaded, &opA, &opB, k, &epi);
+    TEST_ASSERT(mats_equal(serial, threaded), "Threaded GEMM with epilogue bit-exact");
+
+    intnn_mat* at = intnn_create_mat(k, m);
+    intnn_transpose_of(at, a);
+    intnn_mat_mul_mat_trans(threaded, at, true, b, false);
+    intnn_thread_pool_init(1, false);
+    intnn_mat_mul_mat(serial, a, b);
+    TEST_ASSERT(mats_equal(serial, threaded), "Threaded transposed GEMM bit-exact");
+
+    intnn_free_mat(a); intnn_free_mat(b); intnn_free_mat(at);
+    intnn_free_mat(serial); intnn_free_mat(threaded);
+    free(a); free(b); free(at); free(serial); free(threaded);
+}
+
+void test_elementwise_threads_bit_exact() {
+    const int rows = 1500, cols = 120;
+    intnn_mat* x = intnn_create_mat(rows, cols);
+    intnn_mat* y = intnn_create_mat(rows, cols);
+    intnn_mat* bias = intnn_create_mat(1, cols);
+    intnn_set_random(x, true, -100000, 100000);
+    intnn_set_random(y, true, -50, 50);
+    intnn_set_random(bias, true, -1000, 1000);
+    intnn_mat* serial = intnn_copy_mat(x);
+    intnn_mat* threaded = intnn_copy_mat(x);
+    intnn_mat* divSerial = intnn_create_mat(rows, cols);
+    intnn_mat* divThreaded = intnn_create_mat(rows, cols);
+
+    intnn_thread_pool_init(1, false);
+    intnn_self_add_mat(serial, bias);
+    intnn_self_add_mat(serial, y);
+    intnn_self_div_const(serial, -7);
+    intnn_self_elem_div_mat(serial, y);
+    intnn_clamp_mat(serial, -32767, 32767);
+    intnn_mat_elem_div_mat(divSerial, x, y);
+
+    intnn_thread_pool_init(3, true);
+    intnn_self_add_mat(threaded, bias);
+    intnn_self_add_mat(threaded, y);
+    intnn_self_div_const(threaded, -7);
+    intnn_self_elem_div_mat(threaded, y);
+    intnn_clamp_mat(threaded, -32767, 32767);
+    intnn_mat_elem_div_mat(divThreaded, x, y);
+
+    TEST_ASSERT(mats_equal(serial, threaded), "Threaded in-place elementwise ops bit-exact");
+    TEST_ASSERT(mats_equal(divSerial, divThreaded), "Threaded elementwise division bit-exact");
+
+    intnn_thread_pool_shutdown();
+    intnn_free_mat(x); intnn_free_mat(y); intnn_free_mat(bias);
+    intnn_free_mat(serial); intnn_free_mat(threaded);
+    intnn_free_mat(divSerial); intnn_free_mat(divThreaded);
+    free(x); free(y); free(bias); free(serial); free(threaded); free(divSerial); free(divThreaded);
+}
+
+int main() {
+    test_parallel_for_cover();
+    test_gemm_threads_bit_exact();
+    test_elementwise_threads_bit_exact();
+    printf("All tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "intnn_mat.h"
+#include "intnn_tmat.h"
+
+#define TEST_ASSERT(cond, msg)        \
+    if (!(cond)) {                    \
+        printf("[FAILED] %s\n", msg); \
+        exit(1);                      \
+    } else {                          \
+        printf("[PASSED] %s\n", msg); \
+    }
+
+static int mats_equal(const intnn_mat* x, const intnn_mat* y) {
+    if (!intnn_dims_equal(x, y))
+        return 0;
+    for (int r = 0; r < x->mRows; r++)
+        for (int c = 0; c < x->mCols; c++)
+            if (intnn_get_elem(x, r, c) != intnn_get_elem(y, r, c))
+                return 0;
+    return 1;
+}
+
+void test_tmat_create() {
+    intnn_tmat* t = intnn_create_tmat(3, 5, INTNN_DTYPE_INT8);
+    TEST_ASSERT(t != NULL, "Create int8 tmat");
+    TEST_ASSERT(t->mRows == 3 && t->mCols == 5, "tmat dimensions");
+    TEST_ASSERT(t->mStride % INTNN_MAT_ALIGN == 0, "int8 stride padded to alignment");
+    TEST_ASSERT(((uintptr_t)t->mData % INTNN_MAT_ALIGN) == 0, "tmat storage aligned");
+    TEST_ASSERT(intnn_tmat_num_bytes(t) == 15, "int8 tmat uses one byte per element");
+    TEST_ASSERT(intnn_tmat_get_elem(t, 2, 4) == 0, "tmat zero initialized");
+    intnn_free_tmat(t);
+
+    TEST_ASSERT(intnn_dtype_size(INTNN_DTYPE_INT16) == 2, "int16 element size");
+    TEST_ASSERT(intnn_dtype_max(INTNN_DTYPE_UINT8) == 255, "uint8 max");
+}
+
+void test_tmat_saturation() {
+    intnn_tmat* t8 = intnn_create_tmat(1, 2, INTNN_DTYPE_INT8);
+    intnn_tmat_set_elem(t8, 0, 0, 300);
+    intnn_tmat_set_elem(t8, 0, 1, -300);
+    TEST_ASSERT(intnn_tmat_get_elem(t8, 0, 0) == 127, "int8 saturates high");
+    TEST_ASSERT(intnn_tmat_get_elem(t8, 0, 1) == -128, "int8 saturates low");
+
+    intnn_tmat* t16 = intnn_create_tmat(1, 1, INTNN_DTYPE_INT16);
+    intnn_tmat_set_elem(t16, 0, 0, 40000);
+    TEST_ASSERT(intnn_tmat_get_elem(t16, 0, 0) == 32767, "int16 saturates high");
+
+    intnn_tmat* tu8 = intnn_create_tmat(1, 1, INTNN_DTYPE_UINT8);
+    intnn_tmat_set_elem(tu8, 0, 0, -5);
+    TEST_ASSERT(intnn_tmat_get_elem(tu8, 0, 0) == 0, "uint8 saturates at zero");
+
+    intnn_free_tmat(t8);
+    intnn_free_tmat(t16);
+    intnn_free_tmat(tu8);
+}
+
+void test_tmat_convert_and_gather() {
+    intnn_mat* m = intnn_create_mat(4, 70);
+    intnn_set_random(m, true, 0, 255);
+    intnn_tmat* t = intnn_create_tmat(1, 1, INTNN_DTYPE_UINT8);
+    intnn_tmat_from_mat(t, m);
+    TEST_ASSERT(t->mRows == 4 && t->mCols == 70, "from_mat resizes");
+
+    intnn_mat back = {0};
+    intnn_tmat_to_mat(&back, t);
+    TEST_ASSERT(mats_equal(&back, m), "uint8 round trip");
+
+    int indices[4] = {3, 1, 0, 2};
+    intnn_mat gathered = {0};
+    intnn_mat expected = {0};
+    intnn_tmat_indexed_slice_to_mat(&gathered, t, indices, 1, 3);
+    intnn_indexed_slice_of(&expected, m, indices, 1, 3);
+    TEST_ASSERT(mats_equal(&gathered, &expected), "indexed slice widens rows");
+
+    intnn_tmat_rows_to_mat(&gathered, t, 2, 4);
+    intnn_slice_of(&expected, m, 2, 3, 0, 69);
+    TEST_ASSERT(mats_equal(&gathered, &expected), "contiguous rows widen");
+
+    intnn_free_mat(&back);
+    intnn_free_mat(&gathered);
+    intnn_free_mat(&expected);
+    intnn_free_mat(m);
+    free(m);
+    intnn_free_tmat(t);
+}
+
+// 混合位宽乘法应与全 int32 乘法结果完全一致
+static void check_mixed(int m, int k, int n, intnn_dtype ta, int loA, int hiA,
+                        intnn_dtype tb, int loB, int hiB, const char* msg) {
+    intnn_mat* a = intnn_create_mat(m, k);
+    intnn_mat* b = intnn_create_mat(k, n);
+    intnn_mat* ref = intnn_create_mat(m, n);
+    intnn_set_random(a, true, loA, hiA);
+    intnn_set_random(b, true, loB, hiB);
+    intnn_mat_mul_mat(ref, a, b);
+
+    intnn_tmat* at = intnn_create_tmat(1, 1, ta);
+    intnn_tmat* bt = intnn_create_tmat(1, 1, tb);
+    intnn_tmat_from_mat(at, a);
+    intnn_tmat_from_mat(bt, b);
+    intnn_mat out = {0};
+    intnn_tmat_mul_tmat(&out, at, bt);
+    TEST_ASSERT(mats_equal(&out, ref), msg);
+
+    intnn_free_mat(&out);
+    intnn_free_mat(a); intnn_free_mat(b); intnn_free_mat(ref);
+    free(a); free(b); free(ref);
+    intnn_free_tmat(at);
+    intnn_free_tmat(bt);
+}
+
+void test_tmat_fill_and_copy() {
+    intnn_mat* m = intnn_create_mat(6, 45);
+    intnn_tmat* t = intnn_create_tmat(6, 45, INTNN_DTYPE_INT16);
+    srand(77);
+    intnn_set_random(m, false, -20000, 20000);
+    srand(77);
+    intnn_tmat_set_random(t, false, -20000, 20000);
+    intnn_mat* w = intnn_create_mat(6, 45);
+    intnn_tmat_to_mat(w, t);
+    TEST_ASSERT(mats_equal(m, w), "tmat_set_random draws the same values as set_random");
+
+    intnn_tmat* copy = intnn_copy_tmat(t);
+    intnn_tmat_set_all_constant(t, 9);
+    intnn_tmat_to_mat(w, copy);
+    TEST_ASSERT(copy->mType == INTNN_DTYPE_INT16 && mats_equal(m, w), "copy_tmat is independent of the source");
+    TEST_ASSERT(intnn_tmat_get_elem(t, 5, 44) == 9, "tmat_set_all_constant");
+
+    intnn_free_mat(m); intnn_free_mat(w);
+    free(m); free(w);
+    intnn_free_tmat(t);
+    intnn_free_tmat(copy);
+}
+
+void test_tmat_mixed_gemm() {
+    check_mixed(20, 784, 100, INTNN_DTYPE_UINT8, 0, 255, INTNN_DTYPE_INT16, -32767, 32767,
+                "uint8 x int16 GEMM matches int32");
+    check_mixed(7, 300, 33, INTNN_DTYPE_INT8, -127, 127, INTNN_DTYPE_INT16, -32767, 32767,
+                "int8 x int16 GEMM matches int32");
+    check_mixed(5, 17, 9, INTNN_DTYPE_INT8, -127, 127, INTNN_DTYPE_INT8, -127, 127,
+                "int8 x int8 GEMM matches int32");
+    check_mixed(3, 40, 18, INTNN_DTYPE_INT32, -100000, 100000, INTNN_DTYPE_INT8, -127, 127,
+                "int32 x int8 GEMM matches int32");
+}
+
+int main() {
+    srand(4321);
+    test_tmat_create();
+    test_tmat_saturation();
+    test_tmat_convert_and_gather();
+    test_tmat_fill_and_copy();
+    test_tmat_mixed_gemm();
+
+    printf("All tests passed!\n");
+    return 0;
+}